@@ -0,0 +1,232 @@
+#include "anytime.h"
+#include "hullquery.h"
+#include "kernels.h"
+#include "rtimer.h"
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+//size of the sample of the first step
+static const long SAMPLE = 1024;
+
+//the steps; the three direction steps use FIRST_DIRECTIONS, twice
+//and four times as many directions
+enum anytime_stage {
+  STAGE_SAMPLE = 0,
+  STAGE_OCTAGON,
+  STAGE_DIRECTIONS,
+  STAGE_EXACT = STAGE_DIRECTIONS + 3,
+  STAGE_DONE
+};
+static const int FIRST_DIRECTIONS = 16;
+
+//the kinds of work, see rate in AnytimeHull
+enum { WORK_OCTAGON = 0, WORK_DIRECTIONS, WORK_SORT };
+
+//steps with less work are mostly timer noise and do not update the
+//rates
+static const double MIN_WORK = 65536;
+
+void anytime_hull_init(AnytimeHull& a) {
+  //measured on a 2.x GHz x86-64 with AVX-512
+  a.rate[WORK_OCTAGON] = 0.0012;
+  a.rate[WORK_DIRECTIONS] = 0.003;
+  a.rate[WORK_SORT] = 0.006;
+  a.p = NULL;
+  a.stage = STAGE_DONE;
+  a.exact = 1;
+  a.directions = 0;
+  a.candidates = 0;
+  a.elapsed = 0;
+  a.hull.clear();
+}
+
+void anytime_hull_start(AnytimeHull& a, const vector<point2D>& p) {
+  a.p = &p;
+  a.stage = STAGE_SAMPLE;
+  a.exact = 0;
+  a.directions = 0;
+  a.candidates = p.size();
+  a.elapsed = 0;
+  a.hull.clear();
+  a.cand.clear();
+}
+
+static int stage_directions(int stage) {
+  return FIRST_DIRECTIONS << (stage - STAGE_DIRECTIONS);
+}
+
+/* the work of step stage, and its kind */
+static double stage_work(const AnytimeHull& a, int stage, int* kind) {
+  long m = a.candidates;
+  switch (stage) {
+  case STAGE_SAMPLE:
+    *kind = WORK_OCTAGON;
+    return (double) min(m, SAMPLE) * NB_EXTREMES;
+  case STAGE_OCTAGON:
+    *kind = WORK_OCTAGON;
+    return (double) m * NB_EXTREMES;
+  case STAGE_EXACT:
+    *kind = WORK_SORT;
+    return (double) m * log2((double) m + 2);
+  case STAGE_DONE:
+    *kind = WORK_SORT;
+    return 0;
+  }
+  *kind = WORK_DIRECTIONS;
+  return (double) m * stage_directions(stage);
+}
+
+/* the next step: a direction step is skipped, and the hull computed
+   exactly, when that is predicted to be faster; the direction steps
+   pay off only when they drop many candidates at once */
+static int next_stage(const AnytimeHull& a, double* work, int* kind) {
+  *work = stage_work(a, a.stage, kind);
+  if (a.stage >= STAGE_DIRECTIONS && a.stage < STAGE_EXACT) {
+    int k;
+    double w = stage_work(a, STAGE_EXACT, &k);
+    if (w * a.rate[k] <= *work * a.rate[*kind]) {
+      *work = w;
+      *kind = k;
+      return STAGE_EXACT;
+    }
+  }
+  return a.stage;
+}
+
+double anytime_hull_next_cost(const AnytimeHull& a) {
+  double work;
+  int kind;
+  next_stage(a, &work, &kind);
+  return work * a.rate[kind];
+}
+
+
+/* ****************************** */
+/* set a.hull to the hull of the octagon of q[0..n) and return the
+   number of octagon vertices */
+static int octagon_step(AnytimeHull& a, const point2D* q, long n,
+                        point2D* poly) {
+  int m = hull_octagon(q, n, poly);
+  a.hull = monotone_chain(vector<point2D>(poly, poly + m));
+  a.directions = NB_EXTREMES;
+  return m;
+}
+
+/* the candidates extreme in k directions spread evenly around the
+   circle; the directions are rounded to integers, so the dot
+   products are exact */
+static void direction_step(AnytimeHull& a, int k) {
+  const vector<point2D>& c = a.cand;
+  long m = c.size();
+  vector<long long> dx(k), dy(k), best(k);
+  vector<long> arg(k, 0);
+  for (int j = 0; j < k; j++) {
+    dx[j] = lround(4096 * cos(2 * M_PI * j / k));
+    dy[j] = lround(4096 * sin(2 * M_PI * j / k));
+    best[j] = dx[j] * c[0].x + dy[j] * c[0].y;
+  }
+  for (long i = 1; i < m; i++) {
+    long long x = c[i].x, y = c[i].y;
+    for (int j = 0; j < k; j++) {
+      long long d = dx[j] * x + dy[j] * y;
+      if (d > best[j]) {
+        best[j] = d;
+        arg[j] = i;
+      }
+    }
+  }
+  vector<point2D> ext(k);
+  for (int j = 0; j < k; j++) {
+    ext[j] = c[arg[j]];
+  }
+  a.hull = monotone_chain(ext);
+  a.directions = k;
+
+  //the candidates inside the new polygon or on its boundary are not
+  //vertices, except the polygon vertices themselves, which are put
+  //back
+  HullQuery hq;
+  hq_build(hq, a.hull);
+  long left = 0;
+  for (long i = 0; i < m; i++) {
+    if (!hq_contains(hq, c[i])) {
+      a.cand[left++] = c[i];
+    }
+  }
+  a.cand.resize(left);
+  a.cand.insert(a.cand.end(), hq.v.begin(), hq.v.end());
+}
+
+int anytime_hull_step(AnytimeHull& a) {
+  if (a.stage == STAGE_DONE) {
+    return 0;
+  }
+  assert(a.p != NULL);
+  const vector<point2D>& p = *a.p;
+  long n = p.size();
+  double work;
+  int kind;
+  a.stage = next_stage(a, &work, &kind);
+  Rtimer rt;
+  rt_start(rt);
+
+  if (n == 0) {
+    a.stage = STAGE_EXACT;
+  }
+  point2D poly[NB_EXTREMES];
+  switch (a.stage) {
+  case STAGE_SAMPLE: {
+    long s = min(n, SAMPLE);
+    vector<point2D> q(s);
+    for (long i = 0; i < s; i++) {
+      q[i] = p[i * n / s];
+    }
+    octagon_step(a, &q[0], s, poly);
+    break;
+  }
+  case STAGE_OCTAGON: {
+    int m = octagon_step(a, &p[0], n, poly);
+    a.cand.resize(n);
+    long left = n;
+    if (m >= 3) {
+      left = hull_kernels()->prefilter(&p[0], n, poly, m, &a.cand[0]);
+    } else {
+      copy(p.begin(), p.end(), a.cand.begin());
+    }
+    a.cand.resize(left);
+    break;
+  }
+  case STAGE_EXACT:
+    sort(a.cand.begin(), a.cand.end(), xy_less);
+    a.hull = monotone_chain_sorted(a.cand);
+    a.exact = 1;
+    a.directions = 0;
+    break;
+  default:
+    direction_step(a, stage_directions(a.stage));
+    break;
+  }
+  if (a.stage != STAGE_SAMPLE) {
+    a.candidates = a.cand.size();
+  }
+  a.stage++;
+
+  rt_stop(rt);
+  a.elapsed += rt_w_useconds(rt);
+  if (work >= MIN_WORK) {
+    a.rate[kind] = rt_w_useconds(rt) / work;
+  }
+  return 1;
+}
+
+int anytime_hull(AnytimeHull& a, const vector<point2D>& p, double budget) {
+  anytime_hull_start(a, p);
+  anytime_hull_step(a);
+  while (!a.exact && a.elapsed + anytime_hull_next_cost(a) <= budget) {
+    anytime_hull_step(a);
+  }
+  return a.exact;
+}
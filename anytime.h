@@ -0,0 +1,68 @@
+#ifndef __anytime_h
+#define __anytime_h
+
+#include "geom.h"
+
+/* Anytime hull: a result early, refined until a deadline.
+
+   The hull is computed in steps, and after every step the current
+   result is a convex polygon whose vertices are points of p, so it
+   is inside the exact hull:
+
+   1. the octagon of the extreme points of a sample of p;
+   2. the octagon of the extreme points of all of p; the points
+      strictly inside it are dropped (Akl-Toussaint), the others are
+      the candidates;
+   3. the polygon of the candidates extreme in 16, 32, then 64
+      directions; the candidates inside it are dropped. The
+      remaining direction steps are skipped when the exact step is
+      predicted to be faster;
+   4. the exact hull of the candidates, flagged exact.
+
+   anytime_hull runs steps while the predicted time of the next one
+   fits in the budget. The prediction is the work of the step times a
+   rate measured on the previous steps; the rates are kept in the
+   AnytimeHull, so reusing it across calls (frames) improves the
+   predictions. A step is never interrupted, so the budget is missed
+   only when a prediction is off.
+
+   All tests are exact for coordinates of absolute value < 2^30.
+*/
+typedef struct _anytime_hull {
+  //the current result, in the same form as monotone_chain
+  vector<point2D> hull;
+  int exact;        //1 if hull is the exact hull of p
+  int directions;   //directions of the extreme points in hull, if !exact
+  long candidates;  //points that may still be hull vertices
+  double elapsed;   //us spent in the steps since anytime_hull_start
+
+  //state of the refinement; p must not change between the steps
+  const vector<point2D>* p;
+  vector<point2D> cand;
+  int stage;
+  //us per unit of work of the octagon steps and the direction steps
+  //(point x direction), and of the exact step (candidate x lg of
+  //candidates)
+  double rate[3];
+} AnytimeHull;
+
+/* set the rates to their defaults; call it once before the first use
+   of a */
+void anytime_hull_init(AnytimeHull& a);
+
+/* start over on p; nothing is computed yet */
+void anytime_hull_start(AnytimeHull& a, const vector<point2D>& p);
+
+/* the predicted time of the next step, in us; 0 if the hull is exact */
+double anytime_hull_next_cost(const AnytimeHull& a);
+
+/* run the next step. Return 0 if the hull was already exact, 1
+   otherwise */
+int anytime_hull_step(AnytimeHull& a);
+
+/* start on p and run steps until the hull is exact or the next step
+   would end after budget us. The first step always runs. Return
+   a.exact */
+int anytime_hull(AnytimeHull& a, const vector<point2D>& p, double budget);
+
+#endif
@@ -0,0 +1,135 @@
+#include "approxhull.h"
+#include "hullquery.h"
+#include <assert.h>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+vector<point2D> approx_hull(const vector<point2D>& p, double epsilon,
+                            int strips, double* bound) {
+  long n = p.size();
+  if (bound) {
+    *bound = 0;
+  }
+  if (n == 0) {
+    return vector<point2D>();
+  }
+
+  //the x-range, and the lowest and highest point at each end of it
+  point2D lo_left = p[0], hi_left = p[0], lo_right = p[0], hi_right = p[0];
+  for (long i = 1; i < n; i++) {
+    point2D q = p[i];
+    if (q.x < lo_left.x) {
+      lo_left = hi_left = q;
+    } else if (q.x == lo_left.x) {
+      if (q.y < lo_left.y) lo_left = q;
+      if (q.y > hi_left.y) hi_left = q;
+    }
+    if (q.x > lo_right.x) {
+      lo_right = hi_right = q;
+    } else if (q.x == lo_right.x) {
+      if (q.y < lo_right.y) lo_right = q;
+      if (q.y > hi_right.y) hi_right = q;
+    }
+  }
+
+  //strip s holds the points with (x - xmin) * k / range == s
+  long long range = (long long) lo_right.x - lo_left.x + 1;
+  //strips are at least one unit wide. Strips one unit wide hold one
+  //x each: their lowest and highest points include every vertex, and
+  //the result is exact
+  long k;
+  if (epsilon > 0) {
+    k = (long) min(ceil(range / epsilon), (double) range);
+    if (k > n) {
+      //more strips than points would not be O(n); the exact hull is
+      //within any epsilon
+      return monotone_chain(p);
+    }
+  } else {
+    k = min((long) max(strips, 1), min(n, (long) range));
+  }
+  if (bound) {
+    *bound = (k == range) ? 0 : (double) range / k;
+  }
+
+  //lowest and highest point of each strip
+  vector<point2D> lower(k), upper(k);
+  vector<char> used(k, 0);
+  for (long i = 0; i < n; i++) {
+    point2D q = p[i];
+    long s = ((long long) q.x - lo_left.x) * k / range;
+    if (!used[s]) {
+      used[s] = 1;
+      lower[s] = upper[s] = q;
+    } else {
+      if (q.y < lower[s].y) lower[s] = q;
+      if (q.y > upper[s].y) upper[s] = q;
+    }
+  }
+
+  //candidates: both chains are in x order (one point per strip), so
+  //merging them gives the xy_less order the scan needs
+  vector<point2D> lc, uc;
+  lc.reserve(k + 2);
+  uc.reserve(k + 2);
+  lc.push_back(lo_left);
+  uc.push_back(hi_left);
+  for (long s = 0; s < k; s++) {
+    if (used[s]) {
+      lc.push_back(lower[s]);
+      uc.push_back(upper[s]);
+    }
+  }
+  lc.push_back(lo_right);
+  uc.push_back(hi_right);
+
+  vector<point2D> cand(lc.size() + uc.size());
+  merge(lc.begin(), lc.end(), uc.begin(), uc.end(), cand.begin(), xy_less);
+  return monotone_chain_sorted(cand);
+}
+
+
+/* **************************************** */
+/* distance from q to segment ab */
+static double segment_distance(point2D a, point2D b, point2D q) {
+  double dx = (double) b.x - a.x, dy = (double) b.y - a.y;
+  double qx = (double) q.x - a.x, qy = (double) q.y - a.y;
+  double len2 = dx * dx + dy * dy;
+  double t = (len2 > 0) ? (qx * dx + qy * dy) / len2 : 0;
+  t = max(0.0, min(1.0, t));
+  double ex = qx - t * dx, ey = qy - t * dy;
+  return sqrt(ex * ex + ey * ey);
+}
+
+double approx_hull_error(const vector<point2D>& p,
+                         const vector<point2D>& approx) {
+  HullQuery hq;
+  hq_build(hq, approx);
+  const vector<point2D>& v = hq.v;
+  if (v.size() == 0) {
+    return 0;
+  }
+
+  vector<point2D> outside;
+  for (size_t i = 0; i < p.size(); i++) {
+    if (!hq_contains(hq, p[i])) {
+      outside.push_back(p[i]);
+    }
+  }
+  vector<point2D> far = monotone_chain(outside);
+
+  double err = 0;
+  for (size_t i = 0; i < far.size(); i++) {
+    double d = INFINITY;
+    for (size_t j = 0; j < v.size(); j++) {
+      d = min(d, segment_distance(v[j], v[(j + 1) % v.size()], far[i]));
+    }
+    err = max(err, d);
+  }
+  return err;
+}
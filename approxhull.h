@@ -0,0 +1,34 @@
+#ifndef __approxhull_h
+#define __approxhull_h
+
+#include "geom.h"
+
+/* Approximate hull by Bentley-Faust-Preparata strip bucketing.
+
+   The x-range of the points is cut into k vertical strips of width
+   w. Each strip keeps only its lowest and highest point; together
+   with the extreme points at the smallest and largest x these
+   candidates are already in x order strip by strip, so their hull is
+   computed by a linear scan. Total time O(n + k).
+
+   The result is an inner approximation: its vertices are input
+   points, and every input point lies within distance w of it. */
+
+/* compute the approximate hull of p, in the same form as
+   monotone_chain. If epsilon > 0, use enough strips that every point
+   is within epsilon of the result, or return the exact hull (in
+   O(n lg n)) if that takes more strips than points; otherwise use
+   strips strips, at most n. If bound is not NULL, set it to the
+   guaranteed error (the strip width, 0 if the result is exact). */
+vector<point2D> approx_hull(const vector<point2D>& p, double epsilon,
+                            int strips, double* bound);
+
+/* return the largest distance from a point of p to hull approx, i.e.
+   the actual error of an approximate hull. Distance to a convex
+   polygon is a convex function, so the largest one is found at a
+   vertex of the hull of the points outside approx; only those are
+   measured. */
+double approx_hull_error(const vector<point2D>& p,
+                         const vector<point2D>& approx);
+
+#endif
@@ -0,0 +1,155 @@
+#include "calipers.h"
+#include "parallel.h"
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+
+/* **************************************** */
+static inline long long dot2D(point2D a, point2D b, point2D c, point2D d) {
+  //dot product of b-a and d-c
+  return ((long long) b.x - a.x) * ((long long) d.x - c.x)
+    + ((long long) b.y - a.y) * ((long long) d.y - c.y);
+}
+
+static inline long long dist2(point2D a, point2D b) {
+  return dot2D(a, b, a, b);
+}
+
+/* the rectangle with one side on edge (a,b), extending from smin to
+   smax along the edge and height ht to its left; smin, smax and ht
+   are in units of |b-a| */
+static void make_rect(point2D a, point2D b, long double smin,
+                      long double smax, long double ht, int edge,
+                      HullRect* r) {
+  long double ex = (long double) b.x - a.x, ey = (long double) b.y - a.y;
+  long double len2 = ex * ex + ey * ey;
+  long double len = sqrtl(len2);
+  //unit vector along the edge and unit normal pointing inside
+  long double ux = ex / len, uy = ey / len;
+  long double nx = -uy, ny = ux;
+  long double s0 = smin / len, s1 = smax / len, t = ht / len;
+
+  r->x[0] = a.x + s0 * ux;          r->y[0] = a.y + s0 * uy;
+  r->x[1] = a.x + s1 * ux;          r->y[1] = a.y + s1 * uy;
+  r->x[2] = a.x + s1 * ux + t * nx; r->y[2] = a.y + s1 * uy + t * ny;
+  r->x[3] = a.x + s0 * ux + t * nx; r->y[3] = a.y + s0 * uy + t * ny;
+  r->area = (double) ((s1 - s0) * t);
+  r->perimeter = (double) (2 * ((s1 - s0) + t));
+  r->edge = edge;
+}
+
+/* metrics of a hull with fewer than 3 vertices */
+static void degenerate_metrics(const vector<point2D>& v, int h,
+                               HullMetrics* m) {
+  memset(m, 0, sizeof(HullMetrics));
+  m->diam_a = m->diam_b = m->width_edge = m->width_vertex = 0;
+  if (h == 0) {
+    m->diam_a = m->diam_b = -1;
+    return;
+  }
+  if (h == 2) {
+    m->diam_b = 1;
+    m->diameter2 = dist2(v[0], v[1]);
+    m->diameter = sqrt((double) m->diameter2);
+  }
+  //a flat rectangle around the segment (or the point)
+  for (int c = 0; c < 4; c++) {
+    point2D p = v[(c == 1 || c == 2) ? h - 1 : 0];
+    m->min_area_rect.x[c] = p.x;
+    m->min_area_rect.y[c] = p.y;
+  }
+  m->min_area_rect.perimeter = 2 * m->diameter;
+  m->min_perimeter_rect = m->min_area_rect;
+}
+
+
+/* **************************************** */
+void hull_metrics(const vector<point2D>& v, HullMetrics* m) {
+  int h = v.size();
+  if (h > 1 && v[h-1].x == v[0].x && v[h-1].y == v[0].y) {
+    h--;
+  }
+  if (h < 3) {
+    degenerate_metrics(v, h, m);
+    return;
+  }
+#define NEXT(i) ((i) + 1 == h ? 0 : (i) + 1)
+
+  /* for the current edge (i, i+1) the calipers are:
+     j: the vertex farthest from the line through the edge
+     k: the vertex farthest along the edge direction
+     l: the vertex farthest against the edge direction
+     All three only move forward as i goes around, so the whole pass
+     is O(h). */
+  int i = 0, j, k = 1, l;
+  point2D a = v[0], b = v[1];
+  while (dot2D(a, b, v[k], v[NEXT(k)]) > 0) k = NEXT(k);
+  j = k;
+  while (orient2D(a, b, v[NEXT(j)]) > orient2D(a, b, v[j])) j = NEXT(j);
+  l = j;
+  while (dot2D(a, b, v[l], v[NEXT(l)]) < 0) l = NEXT(l);
+
+  long long best_d2 = -1;
+  long double best_w = -1, best_area = -1, best_perim = -1;
+  for (i = 0; i < h; i++) {
+    a = v[i];
+    b = v[NEXT(i)];
+    while (dot2D(a, b, v[k], v[NEXT(k)]) > 0) k = NEXT(k);
+    while (orient2D(a, b, v[NEXT(j)]) > orient2D(a, b, v[j])) j = NEXT(j);
+    while (dot2D(a, b, v[l], v[NEXT(l)]) < 0) l = NEXT(l);
+
+    //diameter: j is antipodal to both endpoints of the edge
+    long long d2 = dist2(a, v[j]);
+    if (d2 > best_d2) {
+      best_d2 = d2; m->diam_a = i; m->diam_b = j;
+    }
+    d2 = dist2(b, v[j]);
+    if (d2 > best_d2) {
+      best_d2 = d2; m->diam_a = NEXT(i); m->diam_b = j;
+    }
+    //if edge (j, j+1) is parallel to the edge, j+1 is antipodal too
+    if (orient2D(a, b, v[NEXT(j)]) == orient2D(a, b, v[j])) {
+      d2 = dist2(b, v[NEXT(j)]);
+      if (d2 > best_d2) {
+        best_d2 = d2; m->diam_a = NEXT(i); m->diam_b = NEXT(j);
+      }
+    }
+
+    //width and rectangles, in units of |b-a|
+    long double len = sqrtl((long double) dist2(a, b));
+    long double ht = orient2D(a, b, v[j]);
+    long double smax = dot2D(a, b, a, v[k]);
+    long double smin = dot2D(a, b, a, v[l]);
+    long double w = ht / len;
+    long double area = ht * (smax - smin) / (len * len);
+    long double perim = 2 * (ht + smax - smin) / len;
+    if (best_w < 0 || w < best_w) {
+      best_w = w; m->width_edge = i; m->width_vertex = j;
+    }
+    if (best_area < 0 || area < best_area) {
+      best_area = area;
+      make_rect(a, b, smin, smax, ht, i, &m->min_area_rect);
+    }
+    if (best_perim < 0 || perim < best_perim) {
+      best_perim = perim;
+      make_rect(a, b, smin, smax, ht, i, &m->min_perimeter_rect);
+    }
+  }
+#undef NEXT
+
+  m->diameter2 = best_d2;
+  m->diameter = sqrt((double) best_d2);
+  m->width = (double) best_w;
+}
+
+void hull_metrics_batch(const vector<point2D>* hulls, long count,
+                        HullMetrics* m, int nthreads) {
+  parallel_for(count, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        hull_metrics(hulls[i], &m[i]);
+      }
+    });
+}
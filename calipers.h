@@ -0,0 +1,46 @@
+#ifndef __calipers_h
+#define __calipers_h
+
+#include "geom.h"
+
+/* a rectangle enclosing a hull, with one side flush with hull edge
+   [edge, edge+1]. Corners are in ccw order. */
+typedef struct _hull_rect {
+  double x[4], y[4];
+  double area, perimeter;
+  int edge;
+} HullRect;
+
+/* metrics of a convex hull, all computed in one rotating-calipers
+   pass. Vertex indices refer to the hull vector passed in. */
+typedef struct _hull_metrics {
+  //diameter: the farthest pair of vertices. diameter2 is the exact
+  //squared distance
+  long long diameter2;
+  double diameter;
+  int diam_a, diam_b;
+
+  //minimum width: the distance between vertex width_vertex and the
+  //line through edge [width_edge, width_edge+1]
+  double width;
+  int width_edge, width_vertex;
+
+  //minimum-area and minimum-perimeter enclosing rectangles
+  HullRect min_area_rect;
+  HullRect min_perimeter_rect;
+} HullMetrics;
+
+/* compute the metrics of hull h in O(h) time with rotating
+   calipers. h is a ccw hull as returned by graham_scan or
+   monotone_chain: distinct vertices, no collinear triples, optionally
+   with the first vertex repeated at the end. The calipers are
+   advanced with exact integer predicates; only the final distances
+   and rectangles are computed in floating point. */
+void hull_metrics(const vector<point2D>& h, HullMetrics* m);
+
+/* compute the metrics of hulls[0..count) on nthreads threads (<= 0
+   means default_nthreads()) */
+void hull_metrics_batch(const vector<point2D>* hulls, long count,
+                        HullMetrics* m, int nthreads = 0);
+
+#endif
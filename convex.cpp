@@ -0,0 +1,486 @@
+#include "convex.h"
+#include "parallel.h"
+#include <assert.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+/* the number of distinct vertices of hull h: without the closing
+   copy of the first vertex */
+static inline long hull_size(const point2D* h, long n) {
+  if (n > 1 && h[n-1].x == h[0].x && h[n-1].y == h[0].y) {
+    n--;
+  }
+  return n;
+}
+
+/* the index of the lowest (then leftmost) vertex of h */
+static long lowest_vertex(const point2D* h, long n) {
+  long k = 0;
+  for (long i = 1; i < n; i++) {
+    if (h[i].y < h[k].y || (h[i].y == h[k].y && h[i].x < h[k].x)) {
+      k = i;
+    }
+  }
+  return k;
+}
+
+/* cross product of (dx1,dy1) and (dx2,dy2); exact for components of
+   absolute value < 2^31 */
+static inline long long cross(long long dx1, long long dy1,
+                              long long dx2, long long dy2) {
+  return dx1 * dy2 - dy1 * dx2;
+}
+
+/* 0 for directions with angle in [0, pi), 1 for [pi, 2 pi) */
+static inline int half(long long dx, long long dy) {
+  return dy < 0 || (dy == 0 && dx < 0);
+}
+
+/* 1 if the angle of (dx1,dy1) is smaller than that of (dx2,dy2), in
+   [0, 2 pi) */
+static inline int angle_less(long long dx1, long long dy1,
+                             long long dx2, long long dy2) {
+  int h1 = half(dx1, dy1), h2 = half(dx2, dy2);
+  if (h1 != h2) {
+    return h1 < h2;
+  }
+  return cross(dx1, dy1, dx2, dy2) > 0;
+}
+
+/* Walks the edges of two hulls in angular order. Starting from the
+   lowest vertex of a hull, its edges have increasing angles in
+   [0, 2 pi), so merging the two edge sequences by angle is linear. */
+typedef struct _edge_merge {
+  const point2D *a, *b;
+  long na, nb;
+  long sa, sb;  //lowest vertices
+  long ia, ib;  //edges taken so far
+  long ca, cb;  //first vertex of the next edge
+} EdgeMerge;
+
+static void merge_init(EdgeMerge& m, const point2D* a, long na,
+                       const point2D* b, long nb) {
+  m.a = a;
+  m.b = b;
+  m.na = na;
+  m.nb = nb;
+  m.sa = m.ca = lowest_vertex(a, na);
+  m.sb = m.cb = lowest_vertex(b, nb);
+  m.ia = m.ib = 0;
+}
+
+/* the next edge, as its first vertex and direction; 0 when both
+   hulls are done. A point has no edges */
+static inline int merge_next(EdgeMerge& m, point2D* p, long long* dx,
+                             long long* dy) {
+  long ea = (m.na > 1) ? m.na : 0, eb = (m.nb > 1) ? m.nb : 0;
+  if (m.ia == ea && m.ib == eb) {
+    return 0;
+  }
+  long na1 = (m.ca + 1 == m.na) ? 0 : m.ca + 1;
+  long nb1 = (m.cb + 1 == m.nb) ? 0 : m.cb + 1;
+  int take_a = (m.ib == eb);
+  if (!take_a && m.ia < ea) {
+    point2D pa = m.a[m.ca], qa = m.a[na1], pb = m.b[m.cb], qb = m.b[nb1];
+    take_a = !angle_less((long long) qb.x - pb.x, (long long) qb.y - pb.y,
+                         (long long) qa.x - pa.x, (long long) qa.y - pa.y);
+  }
+  point2D p0, p1;
+  if (take_a) {
+    p0 = m.a[m.ca];
+    p1 = m.a[na1];
+    m.ca = na1;
+    m.ia++;
+  } else {
+    p0 = m.b[m.cb];
+    p1 = m.b[nb1];
+    m.cb = nb1;
+    m.ib++;
+  }
+  *p = p0;
+  *dx = (long long) p1.x - p0.x;
+  *dy = (long long) p1.y - p0.y;
+  return 1;
+}
+
+
+/* **************************************** */
+/* the distance of b[k] to the left of the line through p with
+   direction (dx,dy), scaled by |(dx,dy)| */
+static inline long long left_extent(const point2D* b, long k, point2D p,
+                                    long long dx, long long dy) {
+  return cross(dx, dy, (long long) b[k].x - p.x, (long long) b[k].y - p.y);
+}
+
+/* the vertex of b (which has area) farthest to the left of direction
+   (dx,dy), starting from k. If k is on the ccw side of the farthest
+   vertex it climbs cw, else ccw; going ccw, the edges that do not go
+   right of the direction are skipped: b has area, so they do not all
+   do that */
+static inline long climb(const point2D* b, long nb, long k,
+                         long long dx, long long dy) {
+  long k1 = (k + 1 == nb) ? 0 : k + 1;
+  if (cross(dx, dy, (long long) b[k1].x - b[k].x,
+            (long long) b[k1].y - b[k].y) < 0) {
+    while (1) {
+      long k0 = (k == 0) ? nb - 1 : k - 1;
+      if (cross(dx, dy, (long long) b[k].x - b[k0].x,
+                (long long) b[k].y - b[k0].y) >= 0) {
+        return k;
+      }
+      k = k0;
+    }
+  }
+  while (1) {
+    k1 = (k + 1 == nb) ? 0 : k + 1;
+    if (cross(dx, dy, (long long) b[k1].x - b[k].x,
+              (long long) b[k1].y - b[k].y) < 0) {
+      return k;
+    }
+    k = k1;
+  }
+}
+
+/* 1 if some edge line of a has all of b strictly on its right.
+
+   The vertex of b farthest to the left of edge i only moves ccw as i
+   goes around a, so it is followed with one pointer k, as in
+   rotating calipers. To save work the pointer is only moved when b[k]
+   is right of the edge, or when the next edge turns by pi or more
+   from the edge it was last moved for: up to then k is still before
+   the farthest vertex, and climbing ccw from it finds it. */
+static int separated_by_edges(const point2D* a, long na,
+                              const point2D* b, long nb) {
+  if (na < 2) {
+    return 0;
+  }
+  if (nb < 3) {
+    for (long i = 0; i < na; i++) {
+      point2D p = a[i], q = a[(i + 1 == na) ? 0 : i + 1];
+      long long dx = (long long) q.x - p.x, dy = (long long) q.y - p.y;
+      if (left_extent(b, 0, p, dx, dy) < 0
+          && (nb == 1 || left_extent(b, 1, p, dx, dy) < 0)) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  long long ldx = (long long) a[1].x - a[0].x, ldy = (long long) a[1].y - a[0].y;
+  long k = climb(b, nb, 0, ldx, ldy);
+  for (long i = 0; i < na; i++) {
+    point2D p = a[i], q = a[(i + 1 == na) ? 0 : i + 1];
+    long long dx = (long long) q.x - p.x, dy = (long long) q.y - p.y;
+    if (left_extent(b, k, p, dx, dy) < 0) {
+      k = climb(b, nb, k, dx, dy);
+      ldx = dx;
+      ldy = dy;
+      if (left_extent(b, k, p, dx, dy) < 0) {
+        return 1;
+      }
+    }
+    if (i + 1 < na) {
+      point2D r = a[(i + 2 >= na) ? i + 2 - na : i + 2];
+      long long ndx = (long long) r.x - q.x, ndy = (long long) r.y - q.y;
+      long long c = cross(ldx, ldy, ndx, ndy);
+      if (c < 0 || (c == 0 && ldx * ndx + ldy * ndy > 0)) {
+        k = climb(b, nb, k, dx, dy);
+        ldx = dx;
+        ldy = dy;
+      }
+    }
+  }
+  return 0;
+}
+
+/* the hulls have at most 2 vertices each: 1 if they all lie on one
+   line, and then whether their ranges along it overlap */
+static int collinear_overlap(const point2D* a, long na,
+                             const point2D* b, long nb, int* overlap) {
+  point2D v[4];
+  int m = 0;
+  for (long i = 0; i < na; i++) v[m++] = a[i];
+  for (long i = 0; i < nb; i++) v[m++] = b[i];
+  int j = 1;
+  while (j < m && v[j].x == v[0].x && v[j].y == v[0].y) j++;
+  for (int i = j + 1; i < m; i++) {
+    if (orient2D(v[0], v[j], v[i]) != 0) {
+      return 0;
+    }
+  }
+  point2D alo = a[0], ahi = a[na-1], blo = b[0], bhi = b[nb-1];
+  if (xy_less(ahi, alo)) swap(alo, ahi);
+  if (xy_less(bhi, blo)) swap(blo, bhi);
+  *overlap = !xy_less(ahi, blo) && !xy_less(bhi, alo);
+  return 1;
+}
+
+/* 1 if the bounding boxes of a and b intersect */
+static int boxes_meet(const point2D* a, long na, const point2D* b, long nb) {
+  int ax0 = a[0].x, ax1 = a[0].x, ay0 = a[0].y, ay1 = a[0].y;
+  for (long i = 1; i < na; i++) {
+    ax0 = min(ax0, a[i].x); ax1 = max(ax1, a[i].x);
+    ay0 = min(ay0, a[i].y); ay1 = max(ay1, a[i].y);
+  }
+  int bx0 = b[0].x, bx1 = b[0].x, by0 = b[0].y, by1 = b[0].y;
+  for (long i = 1; i < nb; i++) {
+    bx0 = min(bx0, b[i].x); bx1 = max(bx1, b[i].x);
+    by0 = min(by0, b[i].y); by1 = max(by1, b[i].y);
+  }
+  return ax1 >= bx0 && bx1 >= ax0 && ay1 >= by0 && by1 >= ay0;
+}
+
+int convex_overlap_buffer(const point2D* a, long na,
+                          const point2D* b, long nb) {
+  na = hull_size(a, na);
+  nb = hull_size(b, nb);
+  if (na == 0 || nb == 0) {
+    return 0;
+  }
+  //the edges of both hulls give a separating axis, unless both are
+  //degenerate and on one line
+  int overlap;
+  if (na < 3 && nb < 3 && collinear_overlap(a, na, b, nb, &overlap)) {
+    return overlap;
+  }
+  //most disjoint pairs have disjoint bounding boxes
+  if (!boxes_meet(a, na, b, nb)) {
+    return 0;
+  }
+  return !separated_by_edges(a, na, b, nb) && !separated_by_edges(b, nb, a, na);
+}
+
+int convex_overlap(const vector<point2D>& a, const vector<point2D>& b) {
+  return convex_overlap_buffer(a.empty() ? NULL : &a[0], a.size(),
+                               b.empty() ? NULL : &b[0], b.size());
+}
+
+
+/* **************************************** */
+/* 1 if the intersection point of the lines of l1 and l2 (not
+   parallel) is not strictly inside h. The point is l1.a + t l1.d
+   with t = N / D, and the sign to find is that of c1 D + c2 N. It is
+   first computed in doubles, and again exactly in 128 bits (each
+   product is < 2^126) when it is too close to 0 to be sure */
+static int outside(const HalfPlane& h, const HalfPlane& l1,
+                   const HalfPlane& l2) {
+  long long D = cross(l2.dx, l2.dy, l1.dx, l1.dy);
+  long long N = cross(l2.dx, l2.dy, (long long) l2.a.x - l1.a.x,
+                      (long long) l2.a.y - l1.a.y);
+  long long c1 = cross(h.dx, h.dy, (long long) l1.a.x - h.a.x,
+                       (long long) l1.a.y - h.a.y);
+  long long c2 = cross(h.dx, h.dy, l1.dx, l1.dy);
+  double t1 = (double) c1 * (double) D, t2 = (double) c2 * (double) N;
+  double sd = t1 + t2, err = (fabs(t1) + fabs(t2)) * 1e-15;
+  int sign;
+  if (sd > err) {
+    sign = 1;
+  } else if (sd < -err) {
+    sign = -1;
+  } else {
+    __int128 s = (__int128) c1 * D + (__int128) c2 * N;
+    sign = (s > 0) - (s < 0);
+  }
+  if (D < 0) {
+    sign = -sign;
+  }
+  return sign <= 0;
+}
+
+static point2Dd intersect(const HalfPlane& l1, const HalfPlane& l2) {
+  long double D = cross(l2.dx, l2.dy, l1.dx, l1.dy);
+  long double N = cross(l2.dx, l2.dy, (long long) l2.a.x - l1.a.x,
+                        (long long) l2.a.y - l1.a.y);
+  long double t = N / D;
+  point2Dd p;
+  p.x = (double) (l1.a.x + t * l1.dx);
+  p.y = (double) (l1.a.y + t * l1.dy);
+  return p;
+}
+
+/* The half-planes come in angular order; the deque d[head..tail)
+   holds the ones that bound the intersection so far. A new
+   half-plane pops from both ends the ones whose corner it does not
+   strictly contain. Corners on its line are popped too, so an
+   intersection without interior ends up with fewer than 3
+   half-planes. */
+long convex_intersection_buffer(const point2D* a, long na,
+                                const point2D* b, long nb,
+                                HalfPlane* d, point2Dd* out) {
+  na = hull_size(a, na);
+  nb = hull_size(b, nb);
+  if (na < 3 || nb < 3 || !boxes_meet(a, na, b, nb)) {
+    return 0;
+  }
+  EdgeMerge m;
+  merge_init(m, a, na, b, nb);
+  long head = 0, tail = 0;
+  HalfPlane h;
+  while (merge_next(m, &h.a, &h.dx, &h.dy)) {
+    while (tail - head > 1 && outside(h, d[tail-1], d[tail-2])) tail--;
+    while (tail - head > 1 && outside(h, d[head], d[head+1])) head++;
+    if (tail > head && cross(h.dx, h.dy, d[tail-1].dx, d[tail-1].dy) == 0) {
+      if (h.dx * d[tail-1].dx + h.dy * d[tail-1].dy < 0) {
+        //opposite half-planes next to each other: they leave no
+        //interior
+        return 0;
+      }
+      //same direction: keep the inner one
+      if (cross(h.dx, h.dy, (long long) d[tail-1].a.x - h.a.x,
+                (long long) d[tail-1].a.y - h.a.y) >= 0) {
+        continue;
+      }
+      tail--;
+    }
+    d[tail++] = h;
+  }
+  while (tail - head > 2 && outside(d[head], d[tail-1], d[tail-2])) tail--;
+  while (tail - head > 2 && outside(d[tail-1], d[head], d[head+1])) head++;
+  if (tail - head < 3) {
+    return 0;
+  }
+
+  long k = 0;
+  for (long i = head; i < tail; i++) {
+    out[k++] = intersect(d[i], d[(i + 1 == tail) ? head : i + 1]);
+  }
+  out[k++] = out[0];
+  return k;
+}
+
+vector<point2Dd> convex_intersection(const vector<point2D>& a,
+                                     const vector<point2D>& b) {
+  vector<HalfPlane> work(a.size() + b.size());
+  vector<point2Dd> out(a.size() + b.size() + 1);
+  out.resize(convex_intersection_buffer(a.empty() ? NULL : &a[0], a.size(),
+                                        b.empty() ? NULL : &b[0], b.size(),
+                                        work.empty() ? NULL : &work[0],
+                                        &out[0]));
+  return out;
+}
+
+
+/* **************************************** */
+/* The sum starts at the sum of the lowest vertices and follows the
+   merged edges; an edge in the same direction as the previous one
+   extends it instead of adding a vertex. */
+long minkowski_sum_buffer(const point2D* a, long na,
+                          const point2D* b, long nb, point2D* out) {
+  na = hull_size(a, na);
+  nb = hull_size(b, nb);
+  if (na == 0 || nb == 0) {
+    return 0;
+  }
+  EdgeMerge m;
+  merge_init(m, a, na, b, nb);
+  point2D cur;
+  cur.x = a[m.sa].x + b[m.sb].x;
+  cur.y = a[m.sa].y + b[m.sb].y;
+  long k = 0;
+  out[k++] = cur;
+  long long pdx = 0, pdy = 0;
+  point2D p;
+  long long dx, dy;
+  while (merge_next(m, &p, &dx, &dy)) {
+    cur.x += dx;
+    cur.y += dy;
+    if (k > 1 && cross(pdx, pdy, dx, dy) == 0 && pdx * dx + pdy * dy > 0) {
+      out[k-1] = cur;
+    } else {
+      out[k++] = cur;
+    }
+    pdx = dx;
+    pdy = dy;
+  }
+  //the last edge comes back to the first vertex
+  if (k > 1) {
+    k--;
+  }
+  out[k++] = out[0];
+  return k;
+}
+
+vector<point2D> minkowski_sum(const vector<point2D>& a,
+                              const vector<point2D>& b) {
+  vector<point2D> out(a.size() + b.size() + 1);
+  out.resize(minkowski_sum_buffer(a.empty() ? NULL : &a[0], a.size(),
+                                  b.empty() ? NULL : &b[0], b.size(),
+                                  &out[0]));
+  return out;
+}
+
+
+/* **************************************** */
+static inline const point2D* hull_data(const vector<point2D>& h) {
+  return h.empty() ? NULL : &h[0];
+}
+
+void convex_overlap_batch(const vector<point2D>* hulls,
+                          const HullPair* pairs, long count, char* out,
+                          int nthreads) {
+  parallel_for(count, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        const vector<point2D>& a = hulls[pairs[i].a];
+        const vector<point2D>& b = hulls[pairs[i].b];
+        out[i] = convex_overlap_buffer(hull_data(a), a.size(),
+                                       hull_data(b), b.size());
+      }
+    });
+}
+
+/* reserve na+nb+1 points of out for each pair */
+static long layout_pairs(const vector<point2D>* hulls, const HullPair* pairs,
+                         long count, vector<long>& first, vector<long>& size,
+                         long* widest) {
+  first.resize(count + 1);
+  size.resize(count);
+  long total = 0;
+  *widest = 0;
+  for (long i = 0; i < count; i++) {
+    long w = hulls[pairs[i].a].size() + hulls[pairs[i].b].size();
+    first[i] = total;
+    total += w + 1;
+    *widest = max(*widest, w);
+  }
+  first[count] = total;
+  return total;
+}
+
+void convex_intersection_batch(const vector<point2D>* hulls,
+                               const HullPair* pairs, long count,
+                               vector<point2Dd>& out, vector<long>& first,
+                               vector<long>& size, int nthreads) {
+  long widest;
+  out.resize(layout_pairs(hulls, pairs, count, first, size, &widest));
+  parallel_for(count, nthreads, [&](long begin, long end, int tid) {
+      vector<HalfPlane> work(widest);
+      for (long i = begin; i < end; i++) {
+        const vector<point2D>& a = hulls[pairs[i].a];
+        const vector<point2D>& b = hulls[pairs[i].b];
+        size[i] = convex_intersection_buffer(hull_data(a), a.size(),
+                                             hull_data(b), b.size(),
+                                             work.empty() ? NULL : &work[0],
+                                             &out[first[i]]);
+      }
+    });
+}
+
+void minkowski_sum_batch(const vector<point2D>* hulls,
+                         const HullPair* pairs, long count,
+                         vector<point2D>& out, vector<long>& first,
+                         vector<long>& size, int nthreads) {
+  long widest;
+  out.resize(layout_pairs(hulls, pairs, count, first, size, &widest));
+  parallel_for(count, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        const vector<point2D>& a = hulls[pairs[i].a];
+        const vector<point2D>& b = hulls[pairs[i].b];
+        size[i] = minkowski_sum_buffer(hull_data(a), a.size(),
+                                       hull_data(b), b.size(),
+                                       &out[first[i]]);
+      }
+    });
+}
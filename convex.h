@@ -0,0 +1,93 @@
+#ifndef __convex_h
+#define __convex_h
+
+#include "geom.h"
+
+/* Linear-time operations on pairs of convex hulls.
+
+   The hulls are in the form of graham_scan and monotone_chain: ccw,
+   distinct vertices, no collinear triples, optionally closed (first
+   vertex repeated at the end); a point or a segment is a hull with 1
+   or 2 vertices. All tests use exact integer predicates, so they are
+   exact for coordinates of absolute value < 2^30.
+
+   Each operation walks the edges of both hulls once in angular
+   order, in O(h1+h2):
+   - convex_overlap is the separating axis test: the hulls are
+     disjoint iff an edge line of one of them has the other strictly
+     on its outer side; a rotating pointer finds the vertex of the
+     other hull closest to each edge line;
+   - convex_intersection merges the edges of the two hulls by angle
+     and intersects their half-planes with a deque, like O'Rourke's
+     algorithm but with exact (128-bit) tests;
+   - minkowski_sum merges the edges by angle and adds them up.
+
+   The _buffer variants do not allocate, and the batch variants run
+   many pairs on several threads with one allocation per batch. The
+   vertices of an intersection are point2Dd, since in general they
+   are not integer points. */
+
+/* an edge of a hull, as the half-plane to its left: work space of
+   convex_intersection_buffer */
+typedef struct _half_plane {
+  point2D a;
+  long long dx, dy;
+} HalfPlane;
+
+/* 1 if the hulls a and b intersect (touching counts), 0 otherwise */
+int convex_overlap(const vector<point2D>& a, const vector<point2D>& b);
+int convex_overlap_buffer(const point2D* a, long na,
+                          const point2D* b, long nb);
+
+/* return the intersection of a and b, ccw, first vertex repeated at
+   the end; empty if it has no interior (disjoint or touching hulls,
+   or a point or a segment) */
+vector<point2Dd> convex_intersection(const vector<point2D>& a,
+                                     const vector<point2D>& b);
+
+/* same as convex_intersection, but writes the result to out, which
+   must have room for na+nb+1 points, and returns its size. work must
+   have room for na+nb half-planes. Does not allocate */
+long convex_intersection_buffer(const point2D* a, long na,
+                                const point2D* b, long nb,
+                                HalfPlane* work, point2Dd* out);
+
+/* return the Minkowski sum of a and b, in the same form as
+   monotone_chain. Its coordinates are sums of coordinates of a and b
+   and must fit in an int */
+vector<point2D> minkowski_sum(const vector<point2D>& a,
+                              const vector<point2D>& b);
+
+/* same as minkowski_sum, but writes the result to out, which must
+   have room for na+nb+1 points, and returns its size. Does not
+   allocate */
+long minkowski_sum_buffer(const point2D* a, long na,
+                          const point2D* b, long nb, point2D* out);
+
+/* a pair of hulls, as indices in an array of hulls */
+typedef struct _hull_pair {
+  long a, b;
+} HullPair;
+
+/* out[i] = convex_overlap(hulls[pairs[i].a], hulls[pairs[i].b]) for
+   i in [0, count), on nthreads threads (<= 0: default_nthreads()) */
+void convex_overlap_batch(const vector<point2D>* hulls,
+                          const HullPair* pairs, long count, char* out,
+                          int nthreads = 0);
+
+/* the intersections of the pairs: the one of pair i is
+   out[first[i] .. first[i] + size[i]). The vectors are resized, and
+   keep their capacity from one batch to the next */
+void convex_intersection_batch(const vector<point2D>* hulls,
+                               const HullPair* pairs, long count,
+                               vector<point2Dd>& out, vector<long>& first,
+                               vector<long>& size, int nthreads = 0);
+
+/* the Minkowski sums of the pairs, laid out like
+   convex_intersection_batch */
+void minkowski_sum_batch(const vector<point2D>* hulls,
+                         const HullPair* pairs, long count,
+                         vector<point2D>& out, vector<long>& first,
+                         vector<long>& size, int nthreads = 0);
+
+#endif
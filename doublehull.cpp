@@ -0,0 +1,47 @@
+#include "doublehull.h"
+#include "predicates.h"
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+/* same scan as monotone_chain_buffer, with the adaptive test */
+vector<point2Dd> monotone_chain_d(const vector<point2Dd>& p) {
+  vector<point2Dd> s(p);
+  sort(s.begin(), s.end(), xy_less_d);
+  long n = s.size();
+  vector<point2Dd> h(2 * n + 2);
+  long k = 0, calls = 0;
+  //lower hull
+  for (long i = 0; i < n; i++) {
+    while (k >= 2 && (calls++, orient2d_adapt(h[k-2], h[k-1], s[i]) <= 0)) k--;
+    h[k++] = s[i];
+  }
+  //upper hull
+  long t = k + 1;
+  for (long i = n - 2; i >= 0; i--) {
+    while (k >= t && (calls++, orient2d_adapt(h[k-2], h[k-1], s[i]) <= 0)) k--;
+    h[k++] = s[i];
+  }
+  predicate_count_calls(calls);
+  //the last point is the first one again; if all points are equal
+  //only one is left
+  if (k > 1) k--;
+  if (k == 2 && h[0].x == h[1].x && h[0].y == h[1].y) k = 1;
+
+  //start at the lowest (then leftmost) point, and close the hull
+  long lo = 0;
+  for (long i = 1; i < k; i++) {
+    if (h[i].y < h[lo].y || (h[i].y == h[lo].y && h[i].x < h[lo].x)) {
+      lo = i;
+    }
+  }
+  rotate(h.begin(), h.begin() + lo, h.begin() + k);
+  if (k > 0) {
+    h[k] = h[0];
+    k++;
+  }
+  h.resize(k);
+  return h;
+}
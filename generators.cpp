@@ -0,0 +1,377 @@
+#include "generators.h"
+#include "parallel.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+static const int W = GEN_WINDOWSIZE;
+
+static const char* generator_names[NB_GENERATORS] = {
+  "circle", "star", "line", "random", "butterfly", "slinky", "flower",
+  "cardioid", "squiggles", "I", "right_hemisphere", "left_hemisphere",
+  "double_circle", "square", "heart"
+};
+
+const char* generator_name(int gen) {
+  assert(gen >= 0 && gen < NB_GENERATORS);
+  return generator_names[gen];
+}
+
+int generator_by_name(const char* name) {
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    if (strcmp(name, generator_names[g]) == 0) {
+      return g;
+    }
+  }
+  return -1;
+}
+
+long generator_count(int gen, long n) {
+  switch (gen) {
+  case GEN_SLINKY:
+    return 5 * (n / 5);
+  case GEN_RIGHT_HEMISPHERE:
+  case GEN_LEFT_HEMISPHERE:
+    return (n / 2 + 1) + ((n / 2 - 1 > 0) ? n / 2 - 1 : 0);
+  case GEN_SQUARE:
+    return (n > 4) ? n : 4;
+  default:
+    return n;
+  }
+}
+
+
+/* **************************************** */
+/* splitmix64 finalizer */
+static inline uint64_t mix64(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint64_t rnd(uint64_t seed, uint64_t index, uint64_t stream) {
+  uint64_t key = mix64(seed ^ (stream * 0xD1B54A32D192ED03ULL));
+  return mix64(key + (index + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+uint64_t rng_u64(uint64_t seed, uint64_t index, uint64_t stream) {
+  return rnd(seed, index, stream);
+}
+
+/* stand-in for random() % m */
+static inline int rnd_mod(uint64_t seed, long i, int stream, int m) {
+  return (int) (rnd(seed, i, stream) % m);
+}
+
+/* stand-in for (float) random(), a value in [0, 2^31) */
+static inline float rnd_float(uint64_t seed, long i) {
+  return (float) (rnd(seed, i, 0) >> 33);
+}
+
+
+/* **************************************** */
+/* one function per shape; point i is a pure function of (n, seed, i).
+   The formulas are the ones the viewer used. P is point2D, which
+   truncates the coordinates to int like the viewer did, or point2Dd,
+   which keeps them. */
+
+template <class P>
+static P circle_point(long n, uint64_t seed, long i) {
+  double step = 2 * M_PI / n;
+  int rad = 100;
+  P p;
+  p.x = W/2 + rad*cos(i*step);
+  p.y = W/2 + rad*sin(i*step);
+  return p;
+}
+
+template <class P>
+static P horizontal_line_point(long n, uint64_t seed, long i) {
+  P p;
+  p.x = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+  p.y = W/2;
+  return p;
+}
+
+template <class P>
+static P random_point(long n, uint64_t seed, long i) {
+  P p;
+  p.x = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+  p.y = (int)(.3*W)/2 + rnd_mod(seed, i, 1, (int)(.7*W));
+  return p;
+}
+
+template <class P>
+static P star_point(long n, uint64_t seed, long i) {
+  P p;
+  if (i % 2 == 0) {
+    p.x = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+    p.y = rnd_mod(seed, i, 1, (int)(.7*W)) / 5;
+    p.y += (int)((1-.7/5)*W/2);
+  } else {
+    p.x = rnd_mod(seed, i, 0, (int)(.7*W)) / 5;
+    p.x += (int)((1-.7/5)*W/2);
+    p.y = (int)(.3*W)/2 + rnd_mod(seed, i, 1, (int)(.7*W));
+  }
+  return p;
+}
+
+template <class P>
+static P butterfly_point(long n, uint64_t seed, long i) {
+  float t = rnd_float(seed, i);
+  P p;
+  p.x = sin(t)*(exp(cos(t)) - 2 * cos(4*t) - sin(pow(t/12, 5))) * 55;
+  p.y = cos(t)*(exp(cos(t)) - 2 * cos(4*t) - sin(pow(t/12, 5))) * 55;
+  p.x += W/2;
+  p.y += W/2;
+  return p;
+}
+
+template <class P>
+static P slinky_point(long n, uint64_t seed, long i) {
+  //five circles of n/5 points each, with centers along the diagonal
+  static const double centers[5] = {W/3.5, W/3.0, W/2.5, W/2.0, W/1.5};
+  long j = n / 5;
+  double step = 2 * M_PI / j;
+  int rad = 100;
+  long k = i % j;
+  P p;
+  p.x = centers[i / j] + rad*cos(k*step);
+  p.y = centers[i / j] + rad*sin(k*step);
+  return p;
+}
+
+template <class P>
+static P flower_point(long n, uint64_t seed, long i) {
+  float t = rnd_float(seed, i);
+  P p;
+  p.x = (W/4 + W/5*cos(8*t))*cos(t);
+  p.y = (W/4 + W/5*cos(8*t))*sin(t);
+  p.x += W/2;
+  p.y += W/2;
+  return p;
+}
+
+template <class P>
+static P cardioid_point(long n, uint64_t seed, long i) {
+  float x = rnd_float(seed, i);
+  float a = 120;
+  P p;
+  p.x = a*cos(x)*(1-cos(x));
+  p.y = a*sin(x)*(1-cos(x));
+  p.x += (W/1.5);
+  p.y += (W/2);
+  return p;
+}
+
+template <class P>
+static P squiggles_point(long n, uint64_t seed, long i) {
+  P p;
+  if (i < n/4) {
+    p.x = sin(cos(i))*200;
+    p.y = -sin(cos(i)*30)*sin(cos(i))*30;
+  } else if (i < 2*n/4) {
+    p.y = sin(cos(i))*200;
+    p.x = -sin(cos(i)*30)*sin(cos(i))*30;
+  } else if (i < 3*n/4) {
+    p.y = cos(sin(cos(i)))*200;
+    p.x = cos(sin(cos(i*3)))*200;
+  } else {
+    p.y = cos(sin(cos(i)))*200;
+    p.x = (-1)*cos(sin(cos(i*3)))*200;
+  }
+  p.x += W/2;
+  p.y += W/2;
+  return p;
+}
+
+template <class P>
+static P I_point(long n, uint64_t seed, long i) {
+  P p;
+  if (i % 3 == 0) {
+    p.x = (int)(W/2);
+    p.y = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+  } else if (i % 3 == 1) {
+    p.x = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+    p.y = (int)(.3*W/2);
+  } else {
+    p.x = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+    p.y = (int)(.7*W+.15*W);
+  }
+  return p;
+}
+
+//half circle of n/2+1 points, then a vertical line through the center
+template <class P>
+static P hemisphere_point(long n, uint64_t seed, long i, int side) {
+  double step = 2 * M_PI / n;
+  int rad = 100;
+  P p;
+  if (i <= n/2) {
+    p.x = W/2 + side*rad*sin(i*step);
+    p.y = W/2 + rad*cos(i*step);
+  } else {
+    p.x = W/2;
+    p.y = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+  }
+  return p;
+}
+
+template <class P>
+static P right_hemisphere_point(long n, uint64_t seed, long i) {
+  return hemisphere_point<P>(n, seed, i, 1);
+}
+
+template <class P>
+static P left_hemisphere_point(long n, uint64_t seed, long i) {
+  return hemisphere_point<P>(n, seed, i, -1);
+}
+
+template <class P>
+static P double_circle_point(long n, uint64_t seed, long i) {
+  double step = 2 * M_PI / n;
+  int rad = 100;
+  P p;
+  if (i % 2 == 0) {
+    p.x = W/4 + rad*cos(i*step);
+    p.y = W/2 + rad*sin(i*step);
+  } else {
+    p.x = W/2 + rad*cos(i*step);
+    p.y = W/2 + rad*sin(i*step);
+  }
+  return p;
+}
+
+template <class P>
+static P square_point(long n, uint64_t seed, long i) {
+  int lo = (int)((.3*W)/2);
+  int hi = (int)((.3*W)/2) + ((int)(.7*W));
+  P p;
+  //the four corners come first
+  if (i < 4) {
+    p.x = (i % 2 == 0) ? lo : hi;
+    p.y = (i < 2) ? lo : hi;
+    return p;
+  }
+  int r = (int)(.3*W)/2 + rnd_mod(seed, i, 0, (int)(.7*W));
+  if (i % 4 == 0) {        // bottom
+    p.x = r;  p.y = lo;
+  } else if (i % 4 == 1) { // right
+    p.x = hi; p.y = r;
+  } else if (i % 4 == 2) { // top
+    p.x = r;  p.y = hi;
+  } else {                 // left
+    p.x = lo; p.y = r;
+  }
+  return p;
+}
+
+template <class P>
+static P heart_point(long n, uint64_t seed, long i) {
+  double step = 2 * M_PI / n;
+  int rad = 100;
+  double t = i*step;
+  double r = 2 - 2*sin(t) + sin(t)*(sqrt(fabs(cos(t)))/(sin(t)+1.4));
+  r = r*rad;
+  P p;
+  p.x = W/2 + r*cos(t);
+  p.y = W/1.2 + r*sin(t);
+  return p;
+}
+
+
+/* **************************************** */
+/* the shape is a template argument so that it gets inlined into the
+   loop */
+template <class P, P (*F)(long, uint64_t, long)>
+static void fill_points(long n, uint64_t seed, P* out, long first,
+                        long count, int nthreads) {
+  parallel_for(count, nthreads, [=](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        out[i] = F(n, seed, first + i);
+      }
+    });
+}
+
+template <class P>
+static void fill_range(int gen, long n, uint64_t seed, long first,
+                       long count, P* out, int nthreads) {
+  switch (gen) {
+  case GEN_CIRCLE:
+    fill_points<P, circle_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_STAR:
+    fill_points<P, star_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_HORIZONTAL_LINE:
+    fill_points<P, horizontal_line_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_RANDOM:
+    fill_points<P, random_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_BUTTERFLY:
+    fill_points<P, butterfly_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_SLINKY:
+    fill_points<P, slinky_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_FLOWER:
+    fill_points<P, flower_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_CARDIOID:
+    fill_points<P, cardioid_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_SQUIGGLES:
+    fill_points<P, squiggles_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_I:
+    fill_points<P, I_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_RIGHT_HEMISPHERE:
+    fill_points<P, right_hemisphere_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_LEFT_HEMISPHERE:
+    fill_points<P, left_hemisphere_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_DOUBLE_CIRCLE:
+    fill_points<P, double_circle_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_SQUARE:
+    fill_points<P, square_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  case GEN_HEART:
+    fill_points<P, heart_point<P> >(n, seed, out, first, count, nthreads);
+    break;
+  default:
+    assert(0);
+  }
+}
+
+void generate_points(int gen, long n, uint64_t seed, point2D* out,
+                     int nthreads) {
+  generate_range(gen, n, seed, 0, generator_count(gen, n), out, nthreads);
+}
+
+void generate_range(int gen, long n, uint64_t seed, long first, long count,
+                    point2D* out, int nthreads) {
+  fill_range(gen, n, seed, first, count, out, nthreads);
+}
+
+void generate_points(int gen, long n, uint64_t seed, vector<point2D>& out,
+                     int nthreads) {
+  out.resize(generator_count(gen, n));
+  if (out.size() > 0) {
+    generate_points(gen, n, seed, &out[0], nthreads);
+  }
+}
+
+void generate_points_d(int gen, long n, uint64_t seed, vector<point2Dd>& out,
+                       int nthreads) {
+  out.resize(generator_count(gen, n));
+  if (out.size() > 0) {
+    fill_range(gen, n, seed, 0, (long) out.size(), &out[0], nthreads);
+  }
+}
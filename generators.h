@@ -0,0 +1,71 @@
+#ifndef __generators_h
+#define __generators_h
+
+#include "geom.h"
+#include <stdint.h>
+
+/* the generators place points in the range (0,0) to
+   (GEN_WINDOWSIZE,GEN_WINDOWSIZE), which matches the viewer window */
+const int GEN_WINDOWSIZE = 500;
+
+/* the point generators; the order matches the order in which the
+   viewer cycles through them with 'i' */
+enum point_generator {
+  GEN_CIRCLE = 0,
+  GEN_STAR,
+  GEN_HORIZONTAL_LINE,
+  GEN_RANDOM,
+  GEN_BUTTERFLY,
+  GEN_SLINKY,
+  GEN_FLOWER,
+  GEN_CARDIOID,
+  GEN_SQUIGGLES,
+  GEN_I,
+  GEN_RIGHT_HEMISPHERE,
+  GEN_LEFT_HEMISPHERE,
+  GEN_DOUBLE_CIRCLE,
+  GEN_SQUARE,
+  GEN_HEART,
+  NB_GENERATORS
+};
+
+/* short name of a generator ("circle", "star", ...) */
+const char* generator_name(int gen);
+
+/* return the generator with the given name, or -1 */
+int generator_by_name(const char* name);
+
+/* number of points generator gen produces when asked for n points
+   (a few shapes round n down, e.g. slinky makes 5*(n/5)) */
+long generator_count(int gen, long n);
+
+/* counter-based random number: a 64-bit hash of (seed, index,
+   stream). The same arguments always give the same value, so
+   points can be generated in any order and on any thread. */
+uint64_t rng_u64(uint64_t seed, uint64_t index, uint64_t stream);
+
+/* fill out[0..generator_count(gen,n)) with the points of generator
+   gen. Point i depends only on (gen, n, seed, i), so the result is
+   identical for every value of nthreads (<= 0 means
+   default_nthreads()). */
+void generate_points(int gen, long n, uint64_t seed, point2D* out,
+                     int nthreads = 0);
+
+/* fill out[0..count) with points [first, first+count) of the
+   generate_points output, first + count <= generator_count(gen, n) */
+void generate_range(int gen, long n, uint64_t seed, long first, long count,
+                    point2D* out, int nthreads = 0);
+
+/* same as generate_points above; resizes out to
+   generator_count(gen, n) */
+void generate_points(int gen, long n, uint64_t seed, vector<point2D>& out,
+                     int nthreads = 0);
+
+/* same as generate_points, but without truncating the coordinates to
+   int: the shapes computed with cos, sin and exp (circle, butterfly,
+   cardioid, ...) then have no duplicate points. The others give the
+   same points as generate_points */
+void generate_points_d(int gen, long n, uint64_t seed, vector<point2Dd>& out,
+                       int nthreads = 0);
+
+#endif
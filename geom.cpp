@@ -9,32 +9,30 @@
 
 using namespace std;
 
-//sort points by angle from origin then distance from origin
+//sort points by angle from origin then distance from origin. The
+//points must be in the upper half plane (angle in [0, pi)), which is
+//where ccw_sort puts them; exact, no atan2
 bool wayToSort(point2D a, point2D b) {
-  //check angle from origin is equal
-  if (atan2(a.y, a.x) == atan2(b.y, b.x)){
-    //check if y coordinate is equal
-    if (a.y == b.y){
-      return a.x < b.x;
-    }
-    return a.y < b.y;
+  point2D o = {0, 0};
+  long long turn = orient2D(o, a, b);
+  if (turn != 0) {
+    return turn > 0;
   }
-  return atan2(a.y, a.x) < atan2(b.y, b.x);
+  //same angle: the closer one first
+  return llabs(a.x) + llabs(a.y) < llabs(b.x) + llabs(b.y);
+}
+
+//sort points by x, then by y
+bool xy_less(point2D a, point2D b) {
+  return (a.x < b.x) || (a.x == b.x && a.y < b.y);
 }
 
-/* check for and delete duplicates in points vector */
+/* check for and delete duplicates in points vector; equal points
+   must be adjacent */
 vector<point2D> delete_duplicates(vector<point2D> p){
-  //loop through vector and check if point and following point are equal
-  int i = 0;
-  while (i < (p.size() - 1)){
-    if ((p[i].x == p[i+1].x) && (p[i].y == p[i+1].y)){
-      //if equal, erase duplicate
-      p.erase(p.begin()+(i+1));
-    }
-    else{
-      i++;
-    }
-  }
+  p.erase(unique(p.begin(), p.end(), [](point2D a, point2D b) {
+        return a.x == b.x && a.y == b.y;
+      }), p.end());
   return p;
 }
 
@@ -43,10 +41,8 @@ vector<point2D> delete_duplicates(vector<point2D> p){
 /* returns the signed area of triangle abc. The area is positive if c
    is to the left of ab, and negative if c is to the right of ab
  */
-int signed_area2D(point2D a, point2D b, point2D c) {
-  int area = (((b.x - a.x)*(c.y - a.y) - (c.x - a.x)*(b.y - a.y))/2);
-  //printf("area: %f \n", area);
-  return area;
+long long signed_area2D(point2D a, point2D b, point2D c) {
+  return orient2D(a, b, c);
 }
 
 
@@ -84,10 +80,14 @@ int left_on(point2D a, point2D b, point2D c) {
 
 /* sort points by angle ccw from min_y */
 vector<point2D> ccw_sort(vector<point2D> p) {
-  //find lowest y point
+  if (p.size() == 0) {
+    return p;
+  }
+  //find lowest y point, leftmost among those, so that all other
+  //points have an angle in [0, pi) from it
   int min_y = 0;
   for (int i=1; i < p.size(); i++){
-    if (p[i].y < p[min_y].y){
+    if (p[i].y < p[min_y].y || (p[i].y == p[min_y].y && p[i].x < p[min_y].x)){
       min_y = i;
     }
   }
@@ -106,111 +106,207 @@ vector<point2D> ccw_sort(vector<point2D> p) {
   //sort by angle
    sort(p.begin() + 1, p.end(), wayToSort);
 
-   //delete duplicates
-   vector<point2D> points = delete_duplicates(p);
-
    //revert to original coordinates
-   for (int i=1; i < points.size(); i++){
-     points[i].y = points[i].y + points[0].y;
-     points[i].x = points[i].x + points[0].x;
+   for (int i=1; i < p.size(); i++){
+     p[i].y = p[i].y + p[0].y;
+     p[i].x = p[i].x + p[0].x;
    }
 
-   return points;
+   //delete duplicates (copies of the lowest point come right after
+   //it, the others are next to each other)
+   return delete_duplicates(p);
 }
 
 //return top element of stack
-point2D first(vector<point2D> result){
+point2D first(const vector<point2D>& result){
   return result[result.size() - 1];
 }
 
 //return second element of stack
-point2D second(vector<point2D> result){
+point2D second(const vector<point2D>& result){
   return result[result.size() - 2];
 }
 
 //return third element of stack
-point2D third(vector<point2D> result){
+point2D third(const vector<point2D>& result){
   return result[result.size() - 3];
 }
 
-//find middle point of three collinear points
-int remove_middle(point2D one, point2D two, point2D three){
-  //sum x and y components
-  int a_xy = abs(one.x + one.y);
-  int b_xy = abs(two.x + two.y);
-  int c_xy = abs(three.x + three.y);
-
-  //if a is in the middle of b and c
-  if(((a_xy >= b_xy) && (a_xy <= c_xy)) || ((a_xy <= b_xy) && (a_xy >= c_xy))) {
-      return 1;
-  }
-  //if b is in the middle of a and c
-  else if(((b_xy >= a_xy) && (b_xy <= c_xy)) || ((b_xy <= a_xy) && (b_xy >= c_xy))) {
-      return 2;
-  }
-  //if c is in the middle of a and b
-  else{
-    return 3;
-  }
-}
-
 /* compute the convex hull of the points in p; the points on the CH
    are returned as a vector
 */
 vector<point2D> graham_scan(vector<point2D> p) {
   //sort points counterclockwise (and delete duplicates)
   vector<point2D> sorted = ccw_sort(p);
+  if (sorted.size() < 2) {
+    hull_close(sorted);
+    return sorted;
+  }
+  point2D o = sorted[0];
 
-  printf("computing hull..");
+  //the points on the last ray from o are visited farthest first, so
+  //that the nearer ones are popped as collinear; unless all points
+  //are on one ray
+  int last = sorted.size() - 1;
+  while (last > 1 && orient2D(o, sorted[last-1], sorted.back()) == 0) {
+    last--;
+  }
+  if (last > 1) {
+    reverse(sorted.begin() + last, sorted.end());
+  }
 
-  //add contents of stack to result
+  //scan, popping the top of the stack while it is not a strict left
+  //turn
   vector<point2D> result;
   result.push_back(sorted[0]);
-  result.push_back(sorted[1]);
-
-  for (int i=2; i < sorted.size(); i++){
-    //check that top of stack is convex
-    if ((result.size() > 2) && (!left_on(third(result), second(result), first(result)))){
+  for (size_t i=1; i < sorted.size(); i++){
+    while (result.size() >= 2
+           && !left_strictly(second(result), first(result), sorted[i])){
       result.pop_back();
     }
+    result.push_back(sorted[i]);
+  }
+  //the nearer points of the last ray are still on the stack; they
+  //make no left turn towards the start
+  while (result.size() >= 3
+         && !left_strictly(second(result), first(result), sorted[0])){
+    result.pop_back();
+  }
+
+  result.push_back(sorted[0]);
+  return result;
+}
+
+/* **************************************** */
+/* compute the convex hull of p with Andrew's monotone chain: sort by
+   x, then build the lower hull left to right and the upper hull
+   right to left, popping points that do not make a strict left turn
+*/
+vector<point2D> monotone_chain(const vector<point2D>& p) {
+  vector<point2D> s(p);
+  sort(s.begin(), s.end(), xy_less);
+  return monotone_chain_sorted(s);
+}
 
-    //if point is left of or collinear, add to result
-    if(left_on(second(result), first(result), sorted[i])){
-      result.push_back(sorted[i]);
-
-      //if top three points collinear, get rid of the point in the middle
-      if(collinear(third(result), second(result), first(result))){
-        int middle = remove_middle(first(result), second(result), third(result));
-          result.erase(result.begin() + result.size() - middle);
-      }
-      //if top two points collinear with origin, remove middle point
-      if ((collinear(sorted[0], second(result), first(result))) && (result.size() > 2)){
-        int middle = remove_middle(first(result), second(result), sorted[0]);
-          result.erase(result.begin() + result.size() - middle);
-      }
+/* the scan part of monotone_chain, for points already sorted by
+   xy_less */
+vector<point2D> monotone_chain_sorted(const vector<point2D>& s) {
+  vector<point2D> h(2 * s.size() + 2);
+  long k = monotone_chain_buffer(s.size() ? &s[0] : NULL, s.size(),
+                                 h.size() ? &h[0] : NULL);
+  h.resize(k);
+  return h;
+}
+
+/* scan s[0..n), sorted by xy_less, into out without allocating */
+long monotone_chain_buffer(const point2D* s, long n, point2D* out) {
+  point2D* h = out;
+  long k = 0;
+  //lower hull
+  for (long i = 0; i < n; i++) {
+    while (k >= 2 && orient2D(h[k-2], h[k-1], s[i]) <= 0) k--;
+    h[k++] = s[i];
+  }
+  //upper hull
+  long t = k + 1;
+  for (long i = n - 2; i >= 0; i--) {
+    while (k >= t && orient2D(h[k-2], h[k-1], s[i]) <= 0) k--;
+    h[k++] = s[i];
+  }
+  //the last point is the first one again; if all points are equal
+  //only one is left
+  if (k > 1) k--;
+  if (k == 2 && h[0].x == h[1].x && h[0].y == h[1].y) k = 1;
+
+  //the scan starts at the leftmost point; start at the lowest
+  //(then leftmost) one instead, and close the hull
+  long lo = 0;
+  for (long i = 1; i < k; i++) {
+    if (h[i].y < h[lo].y || (h[i].y == h[lo].y && h[i].x < h[lo].x)) {
+      lo = i;
     }
+  }
+  rotate(h, h + lo, h + k);
+  if (k > 0) {
+    h[k] = h[0];
+    k++;
+  }
+  return k;
+}
 
-    else {
-      //while new point is right of top points in stack, pop point from stack
-      while(!left_on(second(result), first(result), sorted[i])){
-          result.pop_back();
-      }
-      result.push_back(sorted[i]);
-
-      //if top three points collinear, get rid of the point in the middle
-      if(collinear(third(result), second(result), first(result))){
-        int middle = remove_middle(first(result), second(result), third(result));
-          result.erase(result.begin() + result.size() - middle);
-      }
-      //if top two points collinear with origin, remove middle point
-      if ((collinear(sorted[0], second(result), first(result))) && (result.size() > 2)){
-        int middle = remove_middle(first(result), second(result), sorted[0]);
-          result.erase(result.begin() + result.size() - middle);
-      }
+/* **************************************** */
+/* put hull h in canonical form (see geom.h) */
+vector<point2D> hull_canonical(const vector<point2D>& h) {
+  //drop repeated vertices, including the closing one
+  vector<point2D> v;
+  v.reserve(h.size());
+  for (size_t i = 0; i < h.size(); i++) {
+    if (v.size() > 0 && v.back().x == h[i].x && v.back().y == h[i].y) {
+      continue;
     }
+    v.push_back(h[i]);
+  }
+  while (v.size() > 1 && v.back().x == v[0].x && v.back().y == v[0].y) {
+    v.pop_back();
+  }
+  if (v.size() < 2) {
+    return v;
   }
 
-  result.push_back(sorted[0]);
-  printf("..done\n");
-  return result;
+  //make it counterclockwise
+  long long area = 0;
+  for (size_t i = 1; i + 1 < v.size(); i++) {
+    area += orient2D(v[0], v[i], v[i+1]);
+  }
+  if (area < 0) {
+    reverse(v.begin(), v.end());
+  }
+
+  //rotate so that the lowest, then leftmost, vertex comes first
+  size_t lo = 0;
+  for (size_t i = 1; i < v.size(); i++) {
+    if (v[i].y < v[lo].y || (v[i].y == v[lo].y && v[i].x < v[lo].x)) {
+      lo = i;
+    }
+  }
+  rotate(v.begin(), v.begin() + lo, v.end());
+
+  //all collinear: keep the two endpoints, which are the lowest and
+  //the highest (then rightmost) vertex
+  size_t hi = 0;
+  bool flat = true;
+  for (size_t i = 1; i < v.size(); i++) {
+    if (v[i].y > v[hi].y || (v[i].y == v[hi].y && v[i].x > v[hi].x)) {
+      hi = i;
+    }
+    if (i + 1 < v.size() && orient2D(v[0], v[i], v[i+1]) != 0) {
+      flat = false;
+    }
+  }
+  if (flat) {
+    vector<point2D> ends(1, v[0]);
+    if (hi != 0) {
+      ends.push_back(v[hi]);
+    }
+    return ends;
+  }
+
+  //drop collinear vertices; the lowest vertex is always a corner
+  vector<point2D> c;
+  c.reserve(v.size());
+  c.push_back(v[0]);
+  for (size_t i = 1; i < v.size(); i++) {
+    point2D next = v[(i + 1) % v.size()];
+    if (orient2D(c.back(), v[i], next) != 0) {
+      c.push_back(v[i]);
+    }
+  }
+  return c;
+}
+
+/* append the first vertex at the end, like graham_scan does */
+void hull_close(vector<point2D>& h) {
+  if (h.size() > 0) {
+    h.push_back(h[0]);
+  }
 }
@@ -10,17 +10,34 @@ typedef struct _point2d {
   int x,y;
 } point2D;
 
+/* a point with double coordinates: vertices of intersections
+   (convex.h) and the input of the double hull (doublehull.h) */
+typedef struct _point2dd {
+  double x, y;
+} point2Dd;
+
 //sorts by angle. If angle is equal, sorts by distance from origin point
 bool wayToSort(point2D a, point2D b);
 
+//sorts by x, then by y
+bool xy_less(point2D a, point2D b);
+
 //deletes duplicates from points vector
 vector<point2D> delete_duplicates(vector<point2D> p);
 
 /* returns 2 times the signed area of triangle abc. The area is
    positive if c is to the left of ab, 0 if a,b,c are collinear and
-   negative if c is to the right of ab
+   negative if c is to the right of ab. Same as orient2D.
  */
-int signed_area2D(point2D a, point2D b, point2D c);
+long long signed_area2D(point2D a, point2D b, point2D c);
+
+/* returns 2 times the signed area of triangle abc (positive if c is
+   left of ab). Computed exactly in 64 bits; exact as long as all
+   coordinates have absolute value < 2^30 */
+inline long long orient2D(point2D a, point2D b, point2D c) {
+  return ((long long) b.x - a.x) * ((long long) c.y - a.y)
+    - ((long long) c.x - a.x) * ((long long) b.y - a.y);
+}
 
 /* return 1 if p,q,r collinear, and 0 otherwise */
 int collinear(point2D p, point2D q, point2D r);
@@ -35,17 +52,41 @@ int left_on(point2D a, point2D b, point2D c);
 vector<point2D> ccw_sort(vector<point2D> p);
 
 //return top element of stack
-point2D first(vector<point2D> result);
+point2D first(const vector<point2D>& result);
 
 //return second element of stack
-point2D second(vector<point2D> result);
+point2D second(const vector<point2D>& result);
 
 //return third element of stack
-point2D third(vector<point2D> result);
+point2D third(const vector<point2D>& result);
 
 /* compute the convex hull of the points in p; the points on the CH
    are returned as a list or vector
 */
 vector<point2D> graham_scan(vector<point2D>);
 
+/* compute the convex hull of the points in p with Andrew's monotone
+   chain, using exact arithmetic. Same output form as graham_scan:
+   ccw from the lowest (then leftmost) point, no collinear points,
+   first point repeated at the end */
+vector<point2D> monotone_chain(const vector<point2D>& p);
+
+/* same as monotone_chain, for points already sorted by xy_less; O(n) */
+vector<point2D> monotone_chain_sorted(const vector<point2D>& s);
+
+/* same as monotone_chain_sorted, but writes the hull to out, which
+   must have room for 2n+2 points, and returns its size. Does not
+   allocate. */
+long monotone_chain_buffer(const point2D* s, long n, point2D* out);
+
+/* return hull h (ccw or cw, possibly closed, with repeated or
+   collinear vertices) in canonical form: counterclockwise, starting
+   at the lowest (then leftmost) vertex, with no collinear or
+   repeated vertices and without the closing copy of the first
+   vertex that graham_scan appends */
+vector<point2D> hull_canonical(const vector<point2D>& h);
+
+/* append the first vertex at the end, like graham_scan does */
+void hull_close(vector<point2D>& h);
+
 #endif
@@ -0,0 +1,69 @@
+#include "hull.h"
+#include "anytime.h"
+#include "approxhull.h"
+#include "hullmerge.h"
+#include "kernels.h"
+#include "melkman.h"
+#include "sfc.h"
+#include <assert.h>
+#include <string.h>
+
+using namespace std;
+
+static const char* engine_names[NB_HULL_ENGINES] = {
+  "graham", "monotone", "approx", "filtered", "chunked", "anytime",
+  "auto"
+};
+
+void hull_default_options(HullOptions* opt) {
+  opt->engine = HULL_MONOTONE;
+  opt->epsilon = 0;
+  opt->strips = 1000;
+  opt->chunks = 256;
+  opt->nthreads = 0;
+  opt->curve = SFC_HILBERT;
+  opt->budget = 2000;
+}
+
+const char* hull_engine_name(int engine) {
+  assert(engine >= 0 && engine < NB_HULL_ENGINES);
+  return engine_names[engine];
+}
+
+int hull_engine_by_name(const char* name) {
+  for (int e = 0; e < NB_HULL_ENGINES; e++) {
+    if (strcmp(name, engine_names[e]) == 0) {
+      return e;
+    }
+  }
+  return -1;
+}
+
+vector<point2D> compute_hull(const vector<point2D>& p,
+                             const HullOptions& opt) {
+  switch (opt.engine) {
+  case HULL_GRAHAM:
+    return graham_scan(p);
+  case HULL_MONOTONE:
+    return monotone_chain(p);
+  case HULL_APPROX:
+    return approx_hull(p, opt.epsilon, opt.strips, NULL);
+  case HULL_FILTERED:
+    return filtered_hull(p);
+  case HULL_CHUNKED: {
+    vector<point2D> q(p);
+    sfc_reorder(q, opt.curve, opt.nthreads);
+    return chunked_hull(q, opt.chunks, opt.nthreads);
+  }
+  case HULL_ANYTIME: {
+    AnytimeHull a;
+    anytime_hull_init(a);
+    anytime_hull(a, p, opt.budget);
+    return a.hull;
+  }
+  case HULL_AUTO:
+    return auto_hull(p);
+  }
+  assert(0);
+  return vector<point2D>();
+}
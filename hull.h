@@ -0,0 +1,49 @@
+#ifndef __hull_h
+#define __hull_h
+
+#include "geom.h"
+
+/* One entry point for the hull engines, so callers (the viewer, the
+   benchmarks) can pick an engine by name. */
+
+enum hull_engine {
+  HULL_GRAHAM = 0,  //graham_scan
+  HULL_MONOTONE,    //monotone_chain, exact
+  HULL_APPROX,      //approx_hull, within epsilon of the exact hull
+  HULL_FILTERED,    //filtered_hull: SIMD octagon prefilter, then exact
+  HULL_CHUNKED,     //chunked_hull in parallel, after sfc_reorder
+  HULL_ANYTIME,     //anytime_hull: inside the exact hull, within a budget
+  HULL_AUTO,        //auto_hull: no sort if the points are presorted
+  NB_HULL_ENGINES
+};
+
+typedef struct _hull_options {
+  int engine;
+  //HULL_APPROX: largest allowed distance of a point from the result;
+  //if 0, strips is used instead
+  double epsilon;
+  int strips;
+  //HULL_CHUNKED: number of chunks, threads (<= 0: default_nthreads())
+  //and the curve the points are reordered along (see sfc.h)
+  long chunks;
+  int nthreads;
+  int curve;
+  //HULL_ANYTIME: time budget in us
+  double budget;
+} HullOptions;
+
+/* set the defaults: the exact engine, 1000 strips for the
+   approximate one, 256 chunks on the Hilbert curve for the chunked
+   one, 2 ms for the anytime one */
+void hull_default_options(HullOptions* opt);
+
+const char* hull_engine_name(int engine);
+
+/* return the engine with the given name, or -1 */
+int hull_engine_by_name(const char* name);
+
+/* compute the hull of p with the engine in opt */
+vector<point2D> compute_hull(const vector<point2D>& p,
+                             const HullOptions& opt);
+
+#endif
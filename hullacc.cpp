@@ -0,0 +1,163 @@
+#include "hullacc.h"
+#include "hullmerge.h"
+#include <assert.h>
+#include <algorithm>
+
+using namespace std;
+
+#define LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+HullAccumulator* hull_acc_create(int nslots, long flush) {
+  assert(nslots > 0 && flush > 0);
+  HullAccumulator* acc = new HullAccumulator;
+  acc->current = new HullSnapshot;
+  acc->current->version = 0;
+  //0 marks a slot that is not reading
+  acc->epoch = 1;
+  acc->nslots = nslots;
+  acc->registered = 0;
+  acc->flush = flush;
+  acc->slot = new HullAccSlot[nslots];
+  for (int s = 0; s < nslots; s++) {
+    acc->slot[s].active = 0;
+    acc->slot[s].st = HullAccStats();
+  }
+  return acc;
+}
+
+void hull_acc_destroy(HullAccumulator* acc) {
+  for (int s = 0; s < acc->nslots; s++) {
+    for (size_t i = 0; i < acc->slot[s].retired.size(); i++) {
+      delete acc->slot[s].retired[i].first;
+    }
+  }
+  delete acc->current;
+  delete [] acc->slot;
+  delete acc;
+}
+
+int hull_acc_register(HullAccumulator* acc) {
+  int s = __atomic_fetch_add(&acc->registered, 1, __ATOMIC_SEQ_CST);
+  return (s < acc->nslots) ? s : -1;
+}
+
+
+/* **************************************** */
+/* The reader announces the epoch before loading the pointer. A
+   producer that replaces a snapshot bumps the epoch after the swap,
+   so a reader that still has the old snapshot announced an older
+   epoch than the one the snapshot was retired with, and a reader
+   announcing that epoch or a later one loads a newer snapshot. */
+const HullSnapshot* hull_acc_lock(HullAccumulator* acc, int s) {
+  STORE(&acc->slot[s].active, LOAD(&acc->epoch));
+  return LOAD(&acc->current);
+}
+
+void hull_acc_unlock(HullAccumulator* acc, int s) {
+  STORE(&acc->slot[s].active, (uint64_t) 0);
+}
+
+/* free the snapshots retired by slot s that no reader can hold */
+static void reclaim(HullAccumulator* acc, int s) {
+  HullAccSlot& sl = acc->slot[s];
+  if (sl.retired.empty()) {
+    return;
+  }
+  uint64_t oldest = UINT64_MAX;
+  int n = min(LOAD(&acc->registered), acc->nslots);
+  for (int t = 0; t < n; t++) {
+    uint64_t a = LOAD(&acc->slot[t].active);
+    if (a != 0) {
+      oldest = min(oldest, a);
+    }
+  }
+  size_t kept = 0;
+  for (size_t i = 0; i < sl.retired.size(); i++) {
+    if (sl.retired[i].second <= oldest) {
+      delete sl.retired[i].first;
+      sl.st.freed++;
+    } else {
+      sl.retired[kept++] = sl.retired[i];
+    }
+  }
+  sl.retired.resize(kept);
+}
+
+void hull_acc_flush(HullAccumulator* acc, int s) {
+  HullAccSlot& sl = acc->slot[s];
+  if (sl.buf.empty()) {
+    return;
+  }
+  sort(sl.buf.begin(), sl.buf.end(), xy_less);
+  vector<point2D> local = monotone_chain_sorted(sl.buf);
+  sl.buf.clear();
+
+  while (1) {
+    HullSnapshot* cur = (HullSnapshot*) hull_acc_lock(acc, s);
+    HullSnapshot* next = new HullSnapshot;
+    hq_build(next->hq, hull_merge(cur->hq.v, local));
+    next->version = cur->version + 1;
+    if (next->hq.v.size() == cur->hq.v.size()
+        && equal(next->hq.v.begin(), next->hq.v.end(), cur->hq.v.begin(),
+                 [](point2D a, point2D b) { return a.x == b.x && a.y == b.y; })) {
+      //the partial hull is inside the snapshot: nothing to publish
+      delete next;
+      hull_acc_unlock(acc, s);
+      break;
+    }
+    if (__atomic_compare_exchange_n(&acc->current, &cur, next, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+      uint64_t e = __atomic_add_fetch(&acc->epoch, 1, __ATOMIC_SEQ_CST);
+      sl.retired.push_back(make_pair(cur, e));
+      sl.st.publishes++;
+      hull_acc_unlock(acc, s);
+      break;
+    }
+    delete next;
+    sl.st.retries++;
+    hull_acc_unlock(acc, s);
+  }
+  reclaim(acc, s);
+}
+
+void hull_acc_add(HullAccumulator* acc, int s, const point2D* p, long n) {
+  HullAccSlot& sl = acc->slot[s];
+  const HullSnapshot* snap = hull_acc_lock(acc, s);
+  long dropped = 0;
+  for (long i = 0; i < n; i++) {
+    if (hq_contains(snap->hq, p[i])) {
+      dropped++;
+    } else {
+      sl.buf.push_back(p[i]);
+    }
+  }
+  hull_acc_unlock(acc, s);
+  sl.st.added += n;
+  sl.st.dropped += dropped;
+  if ((long) sl.buf.size() >= acc->flush) {
+    hull_acc_flush(acc, s);
+  }
+}
+
+vector<point2D> hull_acc_hull(HullAccumulator* acc, int s) {
+  const HullSnapshot* snap = hull_acc_lock(acc, s);
+  vector<point2D> h(snap->hq.v);
+  hull_acc_unlock(acc, s);
+  if (!h.empty()) {
+    hull_close(h);
+  }
+  return h;
+}
+
+void hull_acc_stats(const HullAccumulator* acc, HullAccStats* st) {
+  *st = HullAccStats();
+  for (int s = 0; s < acc->nslots; s++) {
+    const HullAccStats& t = acc->slot[s].st;
+    st->added += t.added;
+    st->dropped += t.dropped;
+    st->publishes += t.publishes;
+    st->retries += t.retries;
+    st->freed += t.freed;
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef __hullacc_h
+#define __hullacc_h
+
+#include "geom.h"
+#include "hullquery.h"
+#include <stdint.h>
+
+/* Concurrent hull accumulator: many producer threads add points to
+   one global hull, and readers take snapshots of it, without locks.
+
+   The global hull is an immutable snapshot behind one pointer. A
+   producer drops the points of a batch that are inside the current
+   snapshot (they cannot change it), keeps the others in a
+   thread-local buffer, and when the buffer is full replaces it by
+   its hull. It then publishes: it merges its partial hull with the
+   current snapshot into a new snapshot and installs it with a
+   compare-and-swap; if another producer published first it merges
+   again with the newer one. As the hull grows, almost all points are
+   dropped by the O(lg h) snapshot test, so the producers rarely
+   publish.
+
+   Snapshots are reclaimed RCU style, with epochs: a thread reading a
+   snapshot announces the global epoch in its slot; a replaced
+   snapshot is retired with a new epoch and freed once no slot
+   announces an older one. Readers never wait for producers, and a
+   snapshot stays valid until the reader unlocks it.
+
+   Every thread that adds or reads uses its own slot, from
+   hull_acc_register. A slot must not be used by two threads at once.
+*/
+
+typedef struct _hull_snapshot {
+  HullQuery hq;      //the hull, in canonical form (hq.v, not closed)
+  uint64_t version;  //number of publishes before this one
+} HullSnapshot;
+
+typedef struct _hull_acc_stats {
+  long added;      //points passed to hull_acc_add
+  long dropped;    //of them, inside the snapshot at the time
+  long publishes;  //snapshots installed
+  long retries;    //failed compare-and-swaps
+  long freed;      //snapshots reclaimed
+} HullAccStats;
+
+//one per thread, on its own cache line
+typedef struct alignas(64) _hull_acc_slot {
+  uint64_t active;                  //epoch read in; 0 if not reading
+  vector<point2D> buf;              //points not yet published
+  vector<pair<HullSnapshot*, uint64_t> > retired;
+  HullAccStats st;
+} HullAccSlot;
+
+typedef struct _hull_accumulator {
+  HullSnapshot* current;
+  uint64_t epoch;
+  int nslots, registered;
+  long flush;  //buffer size that triggers a publish
+  HullAccSlot* slot;
+} HullAccumulator;
+
+/* create an accumulator for at most nslots threads. A producer
+   publishes when flush points are buffered (default 4096) */
+HullAccumulator* hull_acc_create(int nslots, long flush = 4096);
+
+/* free it; no thread may use it any more */
+void hull_acc_destroy(HullAccumulator* acc);
+
+/* return a free slot for the calling thread, or -1 if there is none */
+int hull_acc_register(HullAccumulator* acc);
+
+/* add p[0..n) from the thread of slot s */
+void hull_acc_add(HullAccumulator* acc, int s, const point2D* p, long n);
+
+/* publish the points buffered in slot s */
+void hull_acc_flush(HullAccumulator* acc, int s);
+
+/* return the current snapshot; it stays valid until
+   hull_acc_unlock(acc, s). Does not block */
+const HullSnapshot* hull_acc_lock(HullAccumulator* acc, int s);
+void hull_acc_unlock(HullAccumulator* acc, int s);
+
+/* return a copy of the current hull, in the same form as
+   monotone_chain */
+vector<point2D> hull_acc_hull(HullAccumulator* acc, int s);
+
+/* the statistics summed over all slots; call it when no thread is
+   adding */
+void hull_acc_stats(const HullAccumulator* acc, HullAccStats* st);
+
+#endif
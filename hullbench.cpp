@@ -0,0 +1,1753 @@
+/* hullbench.cpp
+
+   Command-line benchmarks for the point generators and the hull
+   engines. Does not need GLUT, so it runs on headless machines.
+
+   usage: hullbench <command> [args]
+
+*/
+
+#include "geom.h"
+#include "anytime.h"
+#include "approxhull.h"
+#include "calipers.h"
+#include "convex.h"
+#include "doublehull.h"
+#include "generators.h"
+#include "hull.h"
+#include "hullacc.h"
+#include "hullcache.h"
+#include "hulldelta.h"
+#include "hullmerge.h"
+#include "kernels.h"
+#include "layers.h"
+#include "melkman.h"
+#include "packed.h"
+#include "pipeline.h"
+#include "pointio.h"
+#include "predicates.h"
+#include "quadtree.h"
+#include "rangehull.h"
+#include "sfc.h"
+#include "warmhull.h"
+#include "hullquery.h"
+#include "parallel.h"
+#include "rtimer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+
+/* ****************************** */
+/* order-sensitive checksum of a point vector */
+static uint64_t checksum(const vector<point2D>& p) {
+  uint64_t h = 1469598103934665603ULL;
+  for (size_t i = 0; i < p.size(); i++) {
+    h = (h ^ (uint32_t) p[i].x) * 1099511628211ULL;
+    h = (h ^ (uint32_t) p[i].y) * 1099511628211ULL;
+  }
+  return h;
+}
+
+/* parse a generator argument: a name, or "all" (returns -1) */
+static int parse_generator(const char* arg) {
+  if (strcmp(arg, "all") == 0) {
+    return -1;
+  }
+  int gen = generator_by_name(arg);
+  if (gen < 0) {
+    printf("unknown generator %s; one of:", arg);
+    for (int g = 0; g < NB_GENERATORS; g++) {
+      printf(" %s", generator_name(g));
+    }
+    printf("\n");
+    exit(1);
+  }
+  return gen;
+}
+
+
+/* ****************************** */
+/* hullbench gen <generator|all> <n> [threads] [seed]
+
+   time the generators and check that the output does not depend on
+   the number of threads */
+static int bench_gen(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench gen <generator|all> <n> [threads] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  int nthreads = (argc > 2) ? atoi(argv[2]) : default_nthreads();
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+  assert(n > 0 && nthreads > 0);
+
+  int fail = 0;
+  vector<point2D> p, q;
+  char buf[1024];
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    if (gen >= 0 && g != gen) continue;
+
+    Rtimer rt;
+    rt_start(rt);
+    generate_points(g, n, seed, p, nthreads);
+    rt_stop(rt);
+
+    //reference run on one thread
+    generate_points(g, n, seed, q, 1);
+    int same = (p.size() == q.size()) && (checksum(p) == checksum(q));
+    fail |= !same;
+
+    rt_sprint(buf, rt);
+    printf("gen %-16s n=%ld threads=%d %s %.1f Mpts/s checksum=%016llx %s\n",
+           generator_name(g), (long) p.size(), nthreads, buf,
+           p.size() / (rt_w_useconds(rt) + 1e-9),
+           (unsigned long long) checksum(p), same ? "ok" : "MISMATCH");
+  }
+  return fail;
+}
+
+
+/* ****************************** */
+/* linear-scan answers, to check the query engine against */
+static int scan_contains(const vector<point2D>& v, point2D q) {
+  if (v.size() < 3) {
+    return -1; //not checked
+  }
+  for (size_t i = 0; i < v.size(); i++) {
+    if (orient2D(v[i], v[(i + 1) % v.size()], q) < 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static int check_tangent(const vector<point2D>& v, point2D q, int t,
+                         int side) {
+  for (size_t i = 0; i < v.size(); i++) {
+    long long o = orient2D(q, v[t], v[i]);
+    if ((side < 0 && o > 0) || (side > 0 && o < 0)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* hullbench query <generator> <n> <m> [threads] [seed]
+
+   build a query engine over the hull of the generated points and
+   time m point-in-hull, extreme-point and tangent queries */
+static int bench_query(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench query <generator> <n> <m> [threads] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long m = atol(argv[2]);
+  int nthreads = (argc > 3) ? atoi(argv[3]) : default_nthreads();
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && m > 0 && nthreads > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p, nthreads);
+  HullQuery hq;
+  hq_build(hq, graham_scan(p));
+  const vector<point2D>& v = hq.v;
+
+  //query points around the window, directions in all quadrants
+  vector<point2D> q(m), d(m);
+  parallel_for(m, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        q[i].x = -GEN_WINDOWSIZE/2 + rng_u64(seed, i, 10) % (2*GEN_WINDOWSIZE);
+        q[i].y = -GEN_WINDOWSIZE/2 + rng_u64(seed, i, 11) % (2*GEN_WINDOWSIZE);
+        d[i].x = -1000 + (int) (rng_u64(seed, i, 12) % 2001);
+        d[i].y = -1000 + (int) (rng_u64(seed, i, 13) % 2001);
+      }
+    });
+  vector<char> inside(m);
+  vector<int> ext(m), left(m), right(m);
+  char buf[1024];
+  printf("query %s n=%ld h=%d m=%ld threads=%d\n", generator_name(gen),
+         (long) p.size(), (int) v.size(), m, nthreads);
+
+  Rtimer rt;
+  rt_start(rt);
+  hq_contains_batch(hq, &q[0], m, &inside[0], nthreads);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("  contains %s %.2f Mq/s\n", buf, m / rt_w_useconds(rt));
+
+  rt_start(rt);
+  hq_extreme_batch(hq, &d[0], m, &ext[0], nthreads);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("  extreme  %s %.2f Mq/s\n", buf, m / rt_w_useconds(rt));
+
+  rt_start(rt);
+  hq_tangents_batch(hq, &q[0], m, &left[0], &right[0], nthreads);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("  tangents %s %.2f Mq/s\n", buf, m / rt_w_useconds(rt));
+
+  //check a sample against linear scans
+  long errors = 0, checked = (m < 10000) ? m : 10000;
+  for (long i = 0; i < checked; i++) {
+    int c = scan_contains(v, q[i]);
+    if (c >= 0 && c != inside[i]) errors++;
+    long long best = (long long) v[ext[i]].x * d[i].x
+      + (long long) v[ext[i]].y * d[i].y;
+    for (size_t j = 0; j < v.size(); j++) {
+      if ((long long) v[j].x * d[i].x + (long long) v[j].y * d[i].y > best) {
+        errors++;
+        break;
+      }
+    }
+    if (!inside[i] && !(check_tangent(v, q[i], left[i], -1)
+                        && check_tangent(v, q[i], right[i], 1))) {
+      errors++;
+    }
+  }
+  printf("  checked %ld queries against linear scans: %ld errors\n",
+         checked, errors);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+/* hullbench calipers <generator> <n> <count> [threads]
+
+   compute the hulls of count point sets (seeds 1..count) and time
+   the rotating-calipers metrics on all of them */
+static int bench_calipers(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench calipers <generator> <n> <count> [threads]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long count = atol(argv[2]);
+  int nthreads = (argc > 3) ? atoi(argv[3]) : default_nthreads();
+  assert(gen >= 0 && n > 0 && count > 0 && nthreads > 0);
+
+  vector<vector<point2D> > hulls(count);
+  parallel_for(count, nthreads, [&](long begin, long end, int tid) {
+      vector<point2D> p;
+      for (long i = begin; i < end; i++) {
+        generate_points(gen, n, i + 1, p, 1);
+        hulls[i] = monotone_chain(p);
+      }
+    });
+  long total_h = 0;
+  for (long i = 0; i < count; i++) {
+    total_h += hulls[i].size() - 1;
+  }
+
+  vector<HullMetrics> m(count);
+  char buf[1024];
+  Rtimer rt;
+  rt_start(rt);
+  hull_metrics_batch(&hulls[0], count, &m[0], nthreads);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("calipers %s n=%ld hulls=%ld avg h=%.1f threads=%d %s %.2f Mhulls/s\n",
+         generator_name(gen), n, count, (double) total_h / count, nthreads,
+         buf, count / rt_w_useconds(rt));
+
+  //check the diameter of a sample against all pairs
+  long errors = 0, checked = (count < 100) ? count : 100;
+  for (long i = 0; i < checked; i++) {
+    const vector<point2D>& h = hulls[i];
+    long long d2 = 0;
+    for (size_t a = 0; a < h.size(); a++) {
+      for (size_t b = a + 1; b < h.size(); b++) {
+        long long dx = (long long) h[a].x - h[b].x;
+        long long dy = (long long) h[a].y - h[b].y;
+        d2 = max(d2, dx * dx + dy * dy);
+      }
+    }
+    if (d2 != m[i].diameter2) errors++;
+  }
+  printf("  hull 0: diameter %.2f width %.2f min area rect %.1f "
+         "min perimeter rect %.1f\n", m[0].diameter, m[0].width,
+         m[0].min_area_rect.area, m[0].min_perimeter_rect.perimeter);
+  printf("  checked %ld diameters against all pairs: %ld errors\n",
+         checked, errors);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+/* the quadratic separating axis test: every vertex of one hull
+   against every edge line of the other */
+static int naive_overlap(const vector<point2D>& a, const vector<point2D>& b) {
+  for (int pass = 0; pass < 2; pass++) {
+    const vector<point2D>& e = pass ? b : a;
+    const vector<point2D>& v = pass ? a : b;
+    for (size_t i = 0; i + 1 < e.size(); i++) {
+      size_t j = 0;
+      while (j < v.size() && orient2D(e[i], e[i+1], v[j]) < 0) j++;
+      if (j == v.size()) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+/* Sutherland-Hodgman: clip a by every edge line of b, in O(h1 h2);
+   return the number of vertices of the result */
+static long naive_intersection(const vector<point2D>& a,
+                               const vector<point2D>& b,
+                               vector<point2Dd>& p, vector<point2Dd>& q) {
+  p.resize(a.size() - 1);
+  for (size_t i = 0; i + 1 < a.size(); i++) {
+    p[i].x = a[i].x;
+    p[i].y = a[i].y;
+  }
+  for (size_t j = 0; j + 1 < b.size() && !p.empty(); j++) {
+    double ex = (double) b[j+1].x - b[j].x, ey = (double) b[j+1].y - b[j].y;
+    q.clear();
+    for (size_t i = 0; i < p.size(); i++) {
+      const point2Dd& u = p[i];
+      const point2Dd& v = p[(i + 1) % p.size()];
+      double su = ex * (u.y - b[j].y) - ey * (u.x - b[j].x);
+      double sv = ex * (v.y - b[j].y) - ey * (v.x - b[j].x);
+      if (su >= 0) {
+        q.push_back(u);
+      }
+      if ((su >= 0) != (sv >= 0)) {
+        double t = su / (su - sv);
+        point2Dd w = {u.x + t * (v.x - u.x), u.y + t * (v.y - u.y)};
+        q.push_back(w);
+      }
+    }
+    swap(p, q);
+  }
+  return p.size();
+}
+
+/* hullbench convex <h> <hulls> <pairs> [threads]
+
+   make <hulls> hulls of h vertices (points on circles of random
+   centers and radii, so that about a third of the pairs overlap) and
+   run the pairwise operations of convex.h on random pairs of them,
+   against the quadratic overlap test and clipping */
+static int bench_convex(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench convex <h> <hulls> <pairs> [threads]\n");
+    return 1;
+  }
+  long h = atol(argv[0]);
+  long count = atol(argv[1]);
+  long npairs = atol(argv[2]);
+  int nthreads = (argc > 3) ? atoi(argv[3]) : default_nthreads();
+  assert(h > 0 && count > 0 && npairs > 0 && nthreads > 0);
+
+  //radius r, about 20 h^1.5 so that rounding keeps the points convex,
+  //centers in a box of side 4r
+  double r = 20 * h * sqrt((double) h);
+  vector<vector<point2D> > hulls(count);
+  parallel_for(count, nthreads, [&](long begin, long end, int tid) {
+      vector<point2D> p(h);
+      for (long i = begin; i < end; i++) {
+        double cx = (rng_u64(11, i, 0) % 4096) * r / 1024;
+        double cy = (rng_u64(11, i, 1) % 4096) * r / 1024;
+        double ri = r * (0.5 + (rng_u64(11, i, 2) % 1024) / 1024.0);
+        double t0 = (rng_u64(11, i, 3) % 1024) * 2 * M_PI / 1024;
+        for (long k = 0; k < h; k++) {
+          double t = t0 + 2 * M_PI * k / h;
+          p[k].x = (int) lround(cx + ri * cos(t));
+          p[k].y = (int) lround(cy + ri * sin(t));
+        }
+        hulls[i] = monotone_chain(p);
+      }
+    });
+  vector<HullPair> pairs(npairs);
+  long total_h = 0;
+  for (long i = 0; i < npairs; i++) {
+    pairs[i].a = rng_u64(12, i, 0) % count;
+    pairs[i].b = rng_u64(12, i, 1) % count;
+    total_h += hulls[pairs[i].a].size() + hulls[pairs[i].b].size() - 2;
+  }
+  printf("convex h=%ld hulls=%ld pairs=%ld avg h1+h2=%.1f threads=%d\n",
+         h, count, npairs, (double) total_h / npairs, nthreads);
+
+  Rtimer rt;
+  vector<char> naive(npairs), overlap(npairs);
+  rt_start(rt);
+  for (long i = 0; i < npairs; i++) {
+    naive[i] = naive_overlap(hulls[pairs[i].a], hulls[pairs[i].b]);
+  }
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s\n", "quadratic overlap",
+         rt_w_useconds(rt), npairs / rt_w_useconds(rt));
+  rt_start(rt);
+  convex_overlap_batch(&hulls[0], &pairs[0], npairs, &overlap[0], 1);
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s\n", "overlap, 1 thread",
+         rt_w_useconds(rt), npairs / rt_w_useconds(rt));
+  rt_start(rt);
+  convex_overlap_batch(&hulls[0], &pairs[0], npairs, &overlap[0], nthreads);
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s\n", "overlap batch",
+         rt_w_useconds(rt), npairs / rt_w_useconds(rt));
+
+  //clipping is slow; time it on a sample
+  long sample = min(npairs, 100000L);
+  vector<long> clipped(sample);
+  vector<point2Dd> p, q;
+  rt_start(rt);
+  for (long i = 0; i < sample; i++) {
+    clipped[i] = naive_intersection(hulls[pairs[i].a], hulls[pairs[i].b], p, q);
+  }
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s (%ld pairs)\n",
+         "clipping intersection", rt_w_useconds(rt),
+         sample / rt_w_useconds(rt), sample);
+
+  vector<point2Dd> ci;
+  vector<point2D> ms;
+  vector<long> first, size;
+  rt_start(rt);
+  convex_intersection_batch(&hulls[0], &pairs[0], npairs, ci, first, size,
+                            nthreads);
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s\n", "intersection batch",
+         rt_w_useconds(rt), npairs / rt_w_useconds(rt));
+  //again, with the buffers of the first batch
+  rt_start(rt);
+  convex_intersection_batch(&hulls[0], &pairs[0], npairs, ci, first, size,
+                            nthreads);
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s\n", "  reusing buffers",
+         rt_w_useconds(rt), npairs / rt_w_useconds(rt));
+  long nonempty = 0, errors = 0;
+  for (long i = 0; i < npairs; i++) {
+    nonempty += size[i] > 0;
+    //touching hulls overlap with an empty intersection
+    errors += (size[i] > 0 && !overlap[i]) || naive[i] != overlap[i];
+    if (i < sample) {
+      //clipping keeps touching points, and may add a vertex where an
+      //edge passes through one
+      errors += (size[i] > 0) != (clipped[i] >= 3 && overlap[i]
+                                  && size[i] > 0);
+    }
+  }
+  rt_start(rt);
+  minkowski_sum_batch(&hulls[0], &pairs[0], npairs, ms, first, size, nthreads);
+  rt_stop(rt);
+  printf("  %-24s %10.0f us %8.3f Mpairs/s\n", "minkowski batch",
+         rt_w_useconds(rt), npairs / rt_w_useconds(rt));
+
+  long noverlap = 0;
+  for (long i = 0; i < npairs; i++) {
+    noverlap += overlap[i];
+  }
+  printf("  %ld overlapping pairs, %ld with a nonempty intersection, "
+         "%ld errors\n", noverlap, nonempty, errors);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+static int same_points(const vector<point2D>& a, const vector<point2D>& b) {
+  if (a.size() != b.size()) {
+    return 0;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* hullbench merge <generator> <n> <shards> [threads] [seed]
+
+   split the points into shards, hull each shard, then compare
+   merging the shard hulls with re-running the hull on the union of
+   their vertices */
+static int bench_merge(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench merge <generator> <n> <shards> [threads] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long shards = atol(argv[2]);
+  int nthreads = (argc > 3) ? atoi(argv[3]) : default_nthreads();
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && shards > 0 && nthreads > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p, nthreads);
+  shards = min(shards, (long) p.size());
+  vector<vector<point2D> > hulls(shards);
+  parallel_for(shards, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        vector<point2D> part(p.begin() + p.size() * i / shards,
+                             p.begin() + p.size() * (i + 1) / shards);
+        hulls[i] = monotone_chain(part);
+      }
+    });
+  long total_h = 0;
+  for (long i = 0; i < shards; i++) {
+    total_h += hulls[i].size();
+  }
+  char buf[1024];
+
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> merged = hull_merge_all(&hulls[0], shards, nthreads);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("merge %s n=%ld shards=%ld shard hull vertices=%ld threads=%d\n",
+         generator_name(gen), (long) p.size(), shards, total_h, nthreads);
+  printf("  merge tree      %s %.0f us\n", buf, rt_w_useconds(rt));
+
+  rt_start(rt);
+  vector<point2D> all;
+  for (long i = 0; i < shards; i++) {
+    all.insert(all.end(), hulls[i].begin(), hulls[i].end());
+  }
+  vector<point2D> recomputed = monotone_chain(all);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("  recompute union %s %.0f us\n", buf, rt_w_useconds(rt));
+
+  vector<point2D> full = monotone_chain(p);
+  int ok = same_points(merged, full) && same_points(recomputed, full);
+  printf("  h=%d %s\n", (int) full.size() - 1,
+         ok ? "matches the hull of all points" : "MISMATCH");
+  return !ok;
+}
+
+
+/* ****************************** */
+/* hullbench approx <n> <epsilon> [seed]
+
+   compare the approximate engine with the exact one on every
+   generator: time, hull size, guaranteed and actual error. With
+   epsilon <= 0 the default number of strips is used. */
+static int bench_approx(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench approx <n> <epsilon> [seed]\n");
+    return 1;
+  }
+  long n = atol(argv[0]);
+  double epsilon = atof(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  HullOptions opt;
+  hull_default_options(&opt);
+  assert(n > 0);
+
+  printf("%-16s %9s %5s %10s %5s %10s %7s %7s %7s\n", "generator", "n",
+         "h", "exact us", "h~", "approx us", "speedup", "bound", "error");
+  int fail = 0;
+  vector<point2D> p;
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    generate_points(g, n, seed, p);
+
+    Rtimer rt;
+    rt_start(rt);
+    vector<point2D> exact = monotone_chain(p);
+    rt_stop(rt);
+    double t_exact = rt_w_useconds(rt);
+
+    double bound;
+    rt_start(rt);
+    vector<point2D> approx = approx_hull(p, epsilon, opt.strips, &bound);
+    rt_stop(rt);
+    double t_approx = rt_w_useconds(rt);
+
+    double err = approx_hull_error(p, approx);
+    int ok = err <= bound * (1 + 1e-9);
+    fail |= !ok;
+    printf("%-16s %9ld %5d %10.0f %5d %10.0f %7.1f %7.3f %7.3f%s\n",
+           generator_name(g), (long) p.size(), (int) exact.size() - 1,
+           t_exact, (int) approx.size() - 1, t_approx,
+           t_exact / (t_approx + 1e-3), bound, err,
+           ok ? "" : "  ERROR ABOVE BOUND");
+  }
+  return fail;
+}
+
+
+/* ****************************** */
+/* convex layers the old way: recompute the hull of the remaining
+   points from scratch and remove the points on its boundary, one
+   round per layer */
+static int peel_from_scratch(const vector<point2D>& p, vector<int>& layer) {
+  vector<long> rest(p.size());
+  for (size_t i = 0; i < p.size(); i++) {
+    rest[i] = i;
+  }
+  layer.assign(p.size(), -1);
+  int l = 0;
+  vector<point2D> q;
+  while (rest.size() > 0) {
+    q.clear();
+    for (size_t j = 0; j < rest.size(); j++) {
+      q.push_back(p[rest[j]]);
+    }
+    vector<point2D> h = monotone_chain(q);
+    size_t k = 0;
+    for (size_t j = 0; j < rest.size(); j++) {
+      point2D a = p[rest[j]];
+      int on = (h.size() <= 2);
+      for (size_t e = 0; !on && e + 1 < h.size(); e++) {
+        on = orient2D(h[e], h[e+1], a) == 0
+          && min(h[e].x, h[e+1].x) <= a.x && a.x <= max(h[e].x, h[e+1].x)
+          && min(h[e].y, h[e+1].y) <= a.y && a.y <= max(h[e].y, h[e+1].y);
+      }
+      if (on) {
+        layer[rest[j]] = l;
+      } else {
+        rest[k++] = rest[j];
+      }
+    }
+    rest.resize(k);
+    l++;
+  }
+  return l;
+}
+
+/* hullbench layers <generator|grid> <n> [seed]
+
+   time the convex layers engine, and check it against peeling from
+   scratch (which is O(n h) per layer, so only for n <= 20000). grid
+   is n random points on a 2^20 x 2^20 grid, which have about n^(2/3)
+   layers */
+static int bench_layers(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench layers <generator|grid> <n> [seed]\n");
+    return 1;
+  }
+  int grid = (strcmp(argv[0], "grid") == 0);
+  int gen = grid ? 0 : parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0);
+
+  vector<point2D> p;
+  if (grid) {
+    p.resize(n);
+    for (long i = 0; i < n; i++) {
+      p[i].x = rng_u64(seed, i, 60) % (1 << 20);
+      p[i].y = rng_u64(seed, i, 61) % (1 << 20);
+    }
+  } else {
+    generate_points(gen, n, seed, p);
+  }
+  char buf[1024];
+
+  Rtimer rt;
+  vector<int> layer;
+  rt_start(rt);
+  int nlayers = convex_layers(p, layer);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("layers %s n=%ld: %d layers\n", grid ? "grid" : generator_name(gen),
+         (long) p.size(), nlayers);
+  printf("  convex_layers     %s %.0f us\n", buf, rt_w_useconds(rt));
+
+  if (p.size() > 20000) {
+    printf("  not checked (n > 20000)\n");
+    return 0;
+  }
+  vector<int> ref;
+  rt_start(rt);
+  int nref = peel_from_scratch(p, ref);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("  peel from scratch %s %.0f us\n", buf, rt_w_useconds(rt));
+  int ok = (nref == nlayers && ref == layer);
+  printf("  %s\n", ok ? "layers match" : "MISMATCH");
+  return !ok;
+}
+
+
+/* ****************************** */
+/* hullbench warm <generator> <n> <frames> [step] [seed]
+
+   move every point by up to step in x and y each frame, and compare
+   recomputing the hull from scratch with the warm-started hull */
+static int bench_warm(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench warm <generator> <n> <frames> [step] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long frames = atol(argv[2]);
+  int step = (argc > 3) ? atoi(argv[3]) : 1;
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && frames > 0 && step >= 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  WarmHull w;
+  warm_hull_reset(w);
+
+  double t_fresh = 0, t_warm = 0, survivors = 0, moves = 0;
+  int errors = 0;
+  for (long f = 0; f < frames; f++) {
+    if (f > 0) {
+      for (size_t i = 0; i < p.size(); i++) {
+        uint64_t r = rng_u64(seed, i, f);
+        p[i].x += (int) (r % (2 * step + 1)) - step;
+        p[i].y += (int) ((r >> 32) % (2 * step + 1)) - step;
+      }
+    }
+    Rtimer rt;
+    rt_start(rt);
+    vector<point2D> fresh = monotone_chain(p);
+    rt_stop(rt);
+    t_fresh += rt_w_useconds(rt);
+
+    rt_start(rt);
+    vector<point2D> warm = warm_hull(w, p);
+    rt_stop(rt);
+    //the first frame is a cold start for both
+    if (f > 0) {
+      t_warm += rt_w_useconds(rt);
+      survivors += w.survivors;
+      moves += w.moves < 0 ? 0 : w.moves;
+    } else {
+      t_fresh = 0;
+    }
+    errors += !same_points(warm, fresh);
+  }
+  long warm_frames = max(1L, frames - 1);
+  printf("warm %s n=%ld frames=%ld step=%d\n", generator_name(gen),
+         (long) p.size(), frames, step);
+  printf("  from scratch %10.0f us/frame\n", t_fresh / warm_frames);
+  printf("  warm start   %10.0f us/frame (%.1fx), %.0f survivors, "
+         "%.0f sort moves\n", t_warm / warm_frames,
+         t_fresh / (t_warm + 1e-3), survivors / warm_frames,
+         moves / warm_frames);
+  printf("  %d frames differ\n", errors);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+/* hullbench kernels <generator> <n> [seed]
+
+   time the orientation, extreme-point and prefilter kernels and the
+   filtered hull in every ISA variant (and check the packed prefilter) the CPU supports, and check
+   that they all give the scalar results. $HULL_ISA picks the variant
+   used by the hull engines. */
+static int bench_kernels(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench kernels <generator> <n> [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  n = p.size();
+  printf("kernels %s n=%ld, dispatched to %s\n", generator_name(gen), n,
+         hull_kernels()->name);
+  printf("%-8s %12s %12s %12s %12s\n", "isa", "orient us", "extremes us",
+         "prefilter us", "filtered us");
+
+  const HullKernels* ref = hull_kernels_isa(ISA_SCALAR);
+  point2D a = p[0], b = p[n / 2];
+  vector<long long> o_ref(n), o(n);
+  long e_ref[NB_EXTREMES], e[NB_EXTREMES];
+  ref->orient(a, b, &p[0], n, &o_ref[0]);
+  ref->extremes(&p[0], n, e_ref);
+  point2D poly[NB_EXTREMES];
+  int k = hull_octagon(&p[0], n, poly, ref);
+  vector<point2D> f_ref(n), f(n);
+  long m_ref = ref->prefilter(&p[0], n, poly, k, &f_ref[0]);
+  f_ref.resize(m_ref);
+  vector<point2D> h_ref = monotone_chain(p);
+
+  //the packed test, against the point2D prefilter
+  PackedPoints pp;
+  int packed_ok = (pack_points(&p[0], n, pp) == 0);
+  uint32_t kpoly[NB_EXTREMES];
+  vector<unsigned char> in_ref(n);
+  if (packed_ok && k >= 3) {
+    for (int j = 0; j < k; j++) {
+      kpoly[j] = ((uint32_t) (poly[j].x - pp.ox) << 16) | (poly[j].y - pp.oy);
+    }
+    for (long i = 0, j = 0; i < n; i++) {
+      in_ref[i] = !(j < m_ref && f_ref[j].x == p[i].x && f_ref[j].y == p[i].y);
+      j += !in_ref[i];
+    }
+  }
+
+  int errors = 0;
+  for (int isa = 0; isa < NB_ISAS; isa++) {
+    const HullKernels* kr = hull_kernels_isa(isa);
+    if (kr == NULL) {
+      continue;
+    }
+    double t[4];
+    Rtimer rt;
+    rt_start(rt);
+    kr->orient(a, b, &p[0], n, &o[0]);
+    rt_stop(rt);
+    t[0] = rt_w_useconds(rt);
+    rt_start(rt);
+    kr->extremes(&p[0], n, e);
+    rt_stop(rt);
+    t[1] = rt_w_useconds(rt);
+    f.resize(n);
+    rt_start(rt);
+    long m = kr->prefilter(&p[0], n, poly, k, &f[0]);
+    rt_stop(rt);
+    t[2] = rt_w_useconds(rt);
+    f.resize(m);
+    rt_start(rt);
+    vector<point2D> h = filtered_hull(p, kr);
+    rt_stop(rt);
+    t[3] = rt_w_useconds(rt);
+
+    int ok = (o == o_ref) && memcmp(e, e_ref, sizeof(e)) == 0
+      && same_points(f, f_ref) && same_points(h, h_ref);
+    if (packed_ok && k >= 3) {
+      vector<unsigned char> in(n);
+      kr->inside_packed(&pp.k[0], n, kpoly, k, &in[0]);
+      ok &= (in == in_ref);
+    }
+    errors += !ok;
+    printf("%-8s %12.0f %12.0f %12.0f %12.0f%s\n", kr->name, t[0], t[1], t[2],
+           t[3], ok ? "" : "  MISMATCH");
+  }
+  printf("  %ld of %ld points left by the prefilter, h=%d\n", m_ref, n,
+         (int) h_ref.size() - 1);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+/* hullbench packed <generator> <n> [seed]
+
+   store the points in 16-bit packed form and compare the hull of the
+   packed points with the hull engines on point2D */
+static int bench_packed(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench packed <generator> <n> [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  n = p.size();
+  PackedPoints pp;
+  if (pack_points(&p[0], n, pp) != 0) {
+    printf("the points do not fit in %ld x %ld\n", PACKED_RANGE, PACKED_RANGE);
+    return 1;
+  }
+  printf("packed %s n=%ld: %.1f MB as point2D, %.1f MB packed\n",
+         generator_name(gen), n, n * sizeof(point2D) / 1e6,
+         pp.k.size() * sizeof(uint32_t) / 1e6);
+
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> ref = monotone_chain(p);
+  rt_stop(rt);
+  printf("  monotone_chain %10.0f us\n", rt_w_useconds(rt));
+  rt_start(rt);
+  vector<point2D> f = filtered_hull(p);
+  rt_stop(rt);
+  printf("  filtered_hull  %10.0f us\n", rt_w_useconds(rt));
+  rt_start(rt);
+  vector<point2D> h = packed_hull(pp);
+  rt_stop(rt);
+  printf("  packed_hull    %10.0f us\n", rt_w_useconds(rt));
+
+  int ok = same_points(h, ref) && same_points(f, ref);
+  printf("  h=%d %s\n", (int) ref.size() - 1, ok ? "hulls match" : "MISMATCH");
+  return !ok;
+}
+
+
+/* ****************************** */
+/* hullbench chunks <generator> <n> <chunks> [threads] [seed]
+
+   reorder the points along each space-filling curve and run the
+   chunked hull on them: time of the reorder and of the hull, and how
+   many chunks the octagon test drops whole */
+static int bench_chunks(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench chunks <generator> <n> <chunks> [threads] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long chunks = atol(argv[2]);
+  int nthreads = (argc > 3) ? atoi(argv[3]) : default_nthreads();
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && chunks > 0 && nthreads > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p, nthreads);
+  printf("chunks %s n=%ld chunks=%ld threads=%d\n",
+         generator_name(gen), (long) p.size(), chunks, nthreads);
+
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> ref = monotone_chain(p);
+  rt_stop(rt);
+  printf("  monotone_chain %10.0f us\n", rt_w_useconds(rt));
+
+  int ok = 1;
+  for (int c = 0; c < NB_SFC_CURVES; c++) {
+    vector<point2D> q(p);
+    rt_start(rt);
+    sfc_reorder(q, c, nthreads);
+    rt_stop(rt);
+    double reorder = rt_w_useconds(rt);
+    ChunkStats st;
+    rt_start(rt);
+    vector<point2D> h = chunked_hull(q, chunks, nthreads, &st);
+    rt_stop(rt);
+    int same = same_points(h, ref);
+    ok = ok && same;
+    printf("  %-8s reorder %10.0f us  hull %10.0f us  skipped %ld/%ld"
+           "  kept %ld  merged %ld  %s\n",
+           sfc_curve_name(c), reorder, rt_w_useconds(rt), st.skipped,
+           min(chunks, (long) q.size()), st.kept, st.merged,
+           same ? "ok" : "MISMATCH");
+  }
+  return !ok;
+}
+
+
+/* ****************************** */
+/* hullbench anytime <generator> <n> <budget> [seed]
+
+   trace the steps of the anytime hull (predicted and actual time,
+   directions, candidates), then run it with a budget of budget us,
+   after a first run that calibrates its rates */
+static int bench_anytime(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench anytime <generator> <n> <budget> [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  double budget = atof(argv[2]);
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> ref = monotone_chain(p);
+  rt_stop(rt);
+  printf("anytime %s n=%ld h=%d\n", generator_name(gen), (long) p.size(),
+         (int) ref.size() - 1);
+  printf("  monotone_chain %10.0f us\n", rt_w_useconds(rt));
+
+  AnytimeHull a;
+  anytime_hull_init(a);
+  anytime_hull_start(a, p);
+  for (int step = 0; !a.exact; step++) {
+    double predicted = anytime_hull_next_cost(a);
+    double before = a.elapsed;
+    anytime_hull_step(a);
+    printf("  step %d  predicted %8.0f us  took %8.0f us  total %8.0f us"
+           "  h=%-4d %s  candidates %ld\n", step, predicted,
+           a.elapsed - before, a.elapsed, (int) a.hull.size() - 1,
+           a.exact ? "exact      " : "inner", a.candidates);
+    if (!a.exact) {
+      printf("                                                     "
+             "           %d directions\n", a.directions);
+    }
+  }
+  int ok = same_points(a.hull, ref);
+
+  //a is calibrated now
+  int exact = anytime_hull(a, p, budget);
+  printf("  budget %.0f us: took %.0f us, h=%d, %s\n", budget, a.elapsed,
+         (int) a.hull.size() - 1,
+         exact ? "exact" : "inner approximation");
+  printf("  %s\n", ok ? "last step matches monotone_chain" : "MISMATCH");
+  return !ok;
+}
+
+
+/* ****************************** */
+/* hullbench acc <generator> <n> <threads> [seed]
+
+   producers add the points in batches of 1024, each from its own
+   range, for 1, 2, 4, ... threads producers. Compare funnelling them
+   into one vector under a mutex and running graham_scan at the end
+   with the concurrent accumulator, while a reader thread keeps
+   taking snapshots of the accumulated hull */
+static int bench_acc(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench acc <generator> <n> <threads> [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  int maxthreads = atoi(argv[2]);
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && maxthreads > 0);
+  const long BATCH = 1024;
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  n = p.size();
+  vector<point2D> ref = monotone_chain(p);
+  printf("acc %s n=%ld h=%d, %d cores\n", generator_name(gen), n,
+         (int) ref.size() - 1, default_nthreads());
+  printf("  %8s %12s %10s %12s %10s %8s %8s %10s\n", "threads",
+         "locked us", "Mpts/s", "acc us", "Mpts/s", "publish", "retries",
+         "snapshots");
+
+  int ok = 1;
+  for (int t = 1; t <= maxthreads; t *= 2) {
+    Rtimer rt;
+    mutex lock;
+    vector<point2D> all;
+    rt_start(rt);
+    parallel_for(n, t, [&](long begin, long end, int tid) {
+        for (long i = begin; i < end; i += BATCH) {
+          lock_guard<mutex> g(lock);
+          all.insert(all.end(), p.begin() + i, p.begin() + min(end, i + BATCH));
+        }
+      });
+    vector<point2D> h1 = graham_scan(all);
+    rt_stop(rt);
+    double locked = rt_w_useconds(rt);
+
+    HullAccumulator* acc = hull_acc_create(t + 2);
+    int main_slot = hull_acc_register(acc);
+    int stop = 0;
+    long snapshots = 0;
+    thread reader([&]() {
+        int s = hull_acc_register(acc);
+        while (!__atomic_load_n(&stop, __ATOMIC_ACQUIRE)) {
+          hull_acc_hull(acc, s);
+          snapshots++;
+        }
+      });
+    rt_start(rt);
+    parallel_for(n, t, [&](long begin, long end, int tid) {
+        int s = hull_acc_register(acc);
+        for (long i = begin; i < end; i += BATCH) {
+          hull_acc_add(acc, s, &p[i], min(end - i, BATCH));
+        }
+        hull_acc_flush(acc, s);
+      });
+    rt_stop(rt);
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    reader.join();
+    double accumulated = rt_w_useconds(rt);
+    vector<point2D> h2 = hull_acc_hull(acc, main_slot);
+    HullAccStats st;
+    hull_acc_stats(acc, &st);
+    hull_acc_destroy(acc);
+
+    int same = same_points(h1, ref) && same_points(h2, ref);
+    ok = ok && same;
+    printf("  %8d %12.0f %10.1f %12.0f %10.1f %8ld %8ld %10ld %s\n", t,
+           locked, n / locked, accumulated, n / accumulated, st.publishes,
+           st.retries, snapshots, same ? "" : "MISMATCH");
+  }
+  return !ok;
+}
+
+
+/* ****************************** */
+/* hullbench presorted <generator|all> <n> [seed]
+
+   detect whether the points are presorted and compare auto_hull,
+   which then skips the sort, with graham_scan and monotone_chain */
+static int bench_presorted(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench presorted <generator|all> <n> [seed]\n");
+    return 1;
+  }
+  int first = 0, last = NB_GENERATORS - 1;
+  if (strcmp(argv[0], "all") != 0) {
+    first = last = parse_generator(argv[0]);
+  }
+  long n = atol(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  assert(first >= 0 && n > 0);
+
+  printf("%-18s %10s %12s %10s %10s %10s\n", "generator", "order",
+         "detect us", "auto us", "graham us", "monotone us");
+  int ok = 1;
+  for (int gen = first; gen <= last; gen++) {
+    vector<point2D> p;
+    generate_points(gen, n, seed, p);
+    Rtimer rt;
+    rt_start(rt);
+    int order = presorted_order(p);
+    rt_stop(rt);
+    double detect = rt_w_useconds(rt);
+    rt_start(rt);
+    vector<point2D> a = auto_hull(p);
+    rt_stop(rt);
+    double t_auto = rt_w_useconds(rt);
+    rt_start(rt);
+    vector<point2D> g = graham_scan(p);
+    rt_stop(rt);
+    double t_graham = rt_w_useconds(rt);
+    rt_start(rt);
+    vector<point2D> m = monotone_chain(p);
+    rt_stop(rt);
+    double t_mono = rt_w_useconds(rt);
+    int same = same_points(a, m) && same_points(g, m);
+    ok = ok && same;
+    printf("%-18s %10s %12.0f %10.0f %10.0f %10.0f %s\n",
+           generator_name(gen), point_order_name(order), detect, t_auto,
+           t_graham, t_mono, same ? "" : "MISMATCH");
+  }
+  return !ok;
+}
+
+
+/* ****************************** */
+static void print_pipeline(const char* name, const PipelineStats& st) {
+  printf("  %-10s total %8.0f us  busy: read %8.0f  filter %8.0f  hull %6.0f"
+         "  kept %ld  %.1f MB\n", name, st.total, st.produce, st.filter,
+         st.hull, st.kept, st.peak_bytes / 1e6);
+}
+
+/* hullbench pipeline <generator> <n> [filters] [block] [seed]
+
+   generate the points and hull them in sequence (what the viewer
+   does), then run the pipelined hull with the generator as source,
+   and with a point file holding the same points */
+static int bench_pipeline(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench pipeline <generator> <n> [filters] [block] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  PipelineOptions opt;
+  pipeline_default_options(&opt);
+  if (argc > 2) {
+    opt.filters = atoi(argv[2]);
+    opt.buffers = 2 * (opt.producers + opt.filters);
+  }
+  if (argc > 3) {
+    opt.block = atol(argv[3]);
+  }
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && opt.filters > 0 && opt.block > 0);
+
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> p;
+  generate_points(gen, n, seed, p, 1);
+  rt_stop(rt);
+  double t_gen = rt_w_useconds(rt);
+  rt_start(rt);
+  vector<point2D> ref = graham_scan(p);
+  rt_stop(rt);
+  double t_hull = rt_w_useconds(rt);
+  printf("pipeline %s n=%ld block=%ld filters=%d buffers=%d\n",
+         generator_name(gen), (long) p.size(), opt.block, opt.filters,
+         opt.buffers);
+  printf("  %-10s total %8.0f us  generate %8.0f  graham_scan %8.0f"
+         "  %.1f MB\n", "sequential", t_gen + t_hull, t_gen, t_hull,
+         p.size() * sizeof(point2D) / 1e6);
+
+  PointSource src;
+  PipelineStats st;
+  generator_source(&src, gen, n, seed);
+  vector<point2D> h;
+  int ok = pipeline_hull(&src, opt, h, &st) == 0;
+  print_pipeline("generator", st);
+  ok = ok && same_points(h, ref);
+
+  char path[] = "/tmp/hullbenchXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0 || write_point_file(path, p) < 0 || file_source(&src, path) < 0) {
+    perror(path);
+    return 1;
+  }
+  close(fd);
+  if (pipeline_hull(&src, opt, h, &st) < 0) {
+    perror(path);
+    ok = 0;
+  }
+  close_source(&src);
+  unlink(path);
+  print_pipeline("file", st);
+  ok = ok && same_points(h, ref);
+
+  printf("  %s\n", ok ? "hulls match" : "MISMATCH");
+  return !ok;
+}
+
+
+/* ****************************** */
+/* one pass over all the generators through the cache, as the viewer
+   does when cycling with 'i'; return the wall time in us, and check
+   the hulls against ref (computed without the cache) */
+static double cache_round(HullCache* c, const vector<vector<point2D> >& sets,
+                          const vector<vector<point2D> >& ref,
+                          const HullOptions& opt, int* ok) {
+  Rtimer rt;
+  rt_start(rt);
+  for (size_t g = 0; g < sets.size(); g++) {
+    vector<point2D> h = cached_hull(c, sets[g], opt);
+    *ok = *ok && same_points(h, ref[g]);
+  }
+  rt_stop(rt);
+  return rt_w_useconds(rt);
+}
+
+static void print_cache(const char* name, double us, HullCache* c) {
+  HullCacheStats st;
+  hull_cache_stats(c, &st);
+  printf("  %-12s %10.0f us  hit rate %5.1f%% (disk %ld)  saved %10.0f us"
+         "  lookup %8.0f us  %ld entries %.2f MB  %ld evicted\n", name, us,
+         st.lookups ? 100.0 * (st.hits + st.disk_hits) / st.lookups : 0.0,
+         st.disk_hits, st.saved_us, st.lookup_us, st.entries, st.bytes / 1e6,
+         st.evictions);
+}
+
+/* hullbench cache <n> [budget MB] [engine] [seed]
+
+   cycle twice through the sets of all generators through a hull
+   cache, then again through a new cache that only has the disk tier
+   written by the first one, as after a restart */
+static int bench_cache(int argc, char** argv) {
+  if (argc < 1) {
+    printf("usage: hullbench cache <n> [budget MB] [engine] [seed]\n");
+    return 1;
+  }
+  long n = atol(argv[0]);
+  size_t budget = (size_t) (((argc > 1) ? atof(argv[1]) : 64) * 1048576);
+  HullOptions opt;
+  hull_default_options(&opt);
+  opt.engine = HULL_GRAHAM;
+  if (argc > 2) {
+    opt.engine = hull_engine_by_name(argv[2]);
+  }
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+  assert(n > 0 && opt.engine >= 0);
+
+  vector<vector<point2D> > sets(NB_GENERATORS), ref(NB_GENERATORS);
+  double uncached = 0;
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    generate_points(g, n, seed, sets[g]);
+    Rtimer rt;
+    rt_start(rt);
+    ref[g] = compute_hull(sets[g], opt);
+    rt_stop(rt);
+    uncached += rt_w_useconds(rt);
+  }
+  printf("cache n=%ld engine %s, %d sets, budget %g MB\n", n,
+         hull_engine_name(opt.engine), NB_GENERATORS, budget / 1048576.0);
+  printf("  %-12s %10.0f us\n", "uncached", uncached);
+
+  char path[] = "/tmp/hullcacheXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror(path);
+    return 1;
+  }
+  close(fd);
+  int ok = 1;
+  HullCache* c = hull_cache_create(budget);
+  if (hull_cache_open_disk(c, path, 64 << 20) < 0) {
+    perror(path);
+    return 1;
+  }
+  print_cache("first pass", cache_round(c, sets, ref, opt, &ok), c);
+  print_cache("second pass", cache_round(c, sets, ref, opt, &ok), c);
+  hull_cache_destroy(c);
+
+  c = hull_cache_create(budget);
+  if (hull_cache_open_disk(c, path, 64 << 20) < 0) {
+    perror(path);
+    return 1;
+  }
+  print_cache("restart", cache_round(c, sets, ref, opt, &ok), c);
+  hull_cache_destroy(c);
+  unlink(path);
+
+  printf("  %s\n", ok ? "hulls match" : "MISMATCH");
+  return !ok;
+}
+
+
+/* ****************************** */
+static double percentile_us(const vector<double>& sorted, double q) {
+  return sorted[(size_t) (q * (sorted.size() - 1))];
+}
+
+static void print_latency(const char* name, vector<double>& us) {
+  sort(us.begin(), us.end());
+  double total = 0;
+  for (size_t i = 0; i < us.size(); i++) {
+    total += us[i];
+  }
+  printf("  %-8s mean %9.1f us  p50 %9.1f  p90 %9.1f  p99 %9.1f  max %9.1f\n",
+         name, total / us.size(), percentile_us(us, 0.5),
+         percentile_us(us, 0.9), percentile_us(us, 0.99), us.back());
+}
+
+/* hullbench range <generator> <n> <queries> [leaf] [threads] [seed]
+
+   build a range hull index of the points, then answer queries on
+   windows of random position and size (from 1% to all of the bounding
+   box in each direction) with it, and by filtering the points and
+   running graham_scan on the survivors */
+static int bench_range(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench range <generator> <n> <queries> [leaf] [threads] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long m = atol(argv[2]);
+  long leaf = (argc > 3) ? atol(argv[3]) : 32;
+  int nthreads = (argc > 4) ? atoi(argv[4]) : default_nthreads();
+  uint64_t seed = (argc > 5) ? strtoull(argv[5], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && m > 0 && leaf > 0 && nthreads > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p, nthreads);
+  int x0 = p[0].x, x1 = p[0].x, y0 = p[0].y, y1 = p[0].y;
+  for (size_t i = 1; i < p.size(); i++) {
+    x0 = min(x0, p[i].x);
+    x1 = max(x1, p[i].x);
+    y0 = min(y0, p[i].y);
+    y1 = max(y1, p[i].y);
+  }
+
+  RangeHullIndex idx;
+  char buf[1024];
+  Rtimer rt;
+  rt_start(rt);
+  range_hull_build(idx, p, leaf, nthreads);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("range %s n=%ld leaf=%ld threads=%d queries=%ld\n",
+         generator_name(gen), (long) p.size(), leaf, nthreads, m);
+  printf("  build    %s\n", buf);
+  printf("  memory   %.2f MB (points %.2f MB, %ld nodes, %ld hull vertices)\n",
+         range_hull_bytes(idx) / 1e6, p.size() * sizeof(point2D) / 1e6,
+         (long) idx.node.size(), (long) idx.hulls.size());
+
+  vector<double> index_us(m), scan_us(m);
+  long errors = 0;
+  double nodes = 0, leaves = 0, candidates = 0, survivors = 0;
+  for (long i = 0; i < m; i++) {
+    long long w = (long long) x1 - x0 + 1, h = (long long) y1 - y0 + 1;
+    long long ww = w * (1 + rng_u64(seed, i, 20) % 100) / 100;
+    long long wh = h * (1 + rng_u64(seed, i, 21) % 100) / 100;
+    int qx0 = x0 + (int) (rng_u64(seed, i, 22) % (w - ww + 1));
+    int qy0 = y0 + (int) (rng_u64(seed, i, 23) % (h - wh + 1));
+    int qx1 = qx0 + (int) ww - 1, qy1 = qy0 + (int) wh - 1;
+
+    RangeHullStats st;
+    rt_start(rt);
+    vector<point2D> a = range_hull(idx, qx0, qy0, qx1, qy1, &st);
+    rt_stop(rt);
+    index_us[i] = rt_w_useconds(rt);
+    nodes += st.nodes;
+    leaves += st.leaves;
+    candidates += st.candidates;
+
+    rt_start(rt);
+    vector<point2D> s;
+    for (size_t j = 0; j < p.size(); j++) {
+      if (p[j].x >= qx0 && p[j].x <= qx1 && p[j].y >= qy0 && p[j].y <= qy1) {
+        s.push_back(p[j]);
+      }
+    }
+    vector<point2D> b;
+    if (!s.empty()) {
+      b = graham_scan(s);
+    }
+    rt_stop(rt);
+    scan_us[i] = rt_w_useconds(rt);
+    survivors += s.size();
+
+    if (!same_points(a, b)) {
+      errors++;
+    }
+  }
+  printf("  per query: %.0f points in the window, %.1f whole nodes, "
+         "%.1f leaves filtered, %.0f candidates\n", survivors / m, nodes / m,
+         leaves / m, candidates / m);
+  print_latency("index", index_us);
+  print_latency("filter", scan_us);
+  printf("  checked %ld queries against graham_scan: %ld errors\n",
+         m, errors);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+/* hullbench view <generator> <n> [seed]
+
+   build the viewer's quadtree of the points, then time the culling
+   of a 500x500-pixel frame at several zoom levels, centered on a
+   point of the set, and count what the frame draws: the cost follows
+   the drawn primitives, which are bounded by the pixels, not by n */
+static int bench_view(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench view <generator> <n> [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  QuadTree t;
+  char buf[1024];
+  Rtimer rt;
+  rt_start(rt);
+  qt_build(t, p);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("view %s n=%ld\n", generator_name(gen), n);
+  printf("  build  %s  %ld cells, %.2f MB\n", buf, (long) t.node.size(),
+         qt_bytes(t) / 1e6);
+
+  const QuadNode& root = t.node[0];
+  double size = max(root.x1 - root.x0 + 1, root.y1 - root.y0 + 1);
+  point2D c = p[rng_u64(seed, 0, 30) % n];
+  vector<long> cells, leaves;
+  for (double z = 1; z <= 4096; z *= 8) {
+    double pixel = size / GEN_WINDOWSIZE / z;
+    double half = GEN_WINDOWSIZE * pixel / 2;
+    double cx = (z == 1) ? root.x0 + size / 2 : c.x;
+    double cy = (z == 1) ? root.y0 + size / 2 : c.y;
+    long drawn = 0;
+    const int frames = 20;
+    rt_start(rt);
+    for (int f = 0; f < frames; f++) {
+      qt_visible(t, cx - half, cy - half, cx + half, cy + half, pixel, 2,
+                 cells, leaves);
+      drawn = cells.size();
+      for (size_t l = 0; l < leaves.size(); l++) {
+        const QuadNode& nd = t.node[leaves[l]];
+        for (long i = nd.lo; i < nd.hi; i++) {
+          drawn += (t.p[i].x >= cx - half && t.p[i].x <= cx + half
+                    && t.p[i].y >= cy - half && t.p[i].y <= cy + half);
+        }
+      }
+    }
+    rt_stop(rt);
+    printf("  zoom %5.0fx  %8.1f us/frame  %7ld aggregate cells  %5ld leaves"
+           "  %7ld squares\n", z, rt_w_useconds(rt) / frames,
+           (long) cells.size(), (long) leaves.size(), drawn);
+  }
+  return 0;
+}
+
+
+/* ****************************** */
+/* monotone chain with the plain double test: fast, but it can keep
+   a reflex vertex or drop a hull vertex when a turn is nearly flat */
+static vector<point2Dd> naive_chain_d(const vector<point2Dd>& p) {
+  vector<point2Dd> s(p);
+  sort(s.begin(), s.end(), xy_less_d);
+  long n = s.size(), k = 0;
+  vector<point2Dd> h(2 * n + 2);
+  for (long i = 0; i < n; i++) {
+    while (k >= 2 && (h[k-1].x - h[k-2].x) * (s[i].y - h[k-2].y)
+           - (h[k-1].y - h[k-2].y) * (s[i].x - h[k-2].x) <= 0) k--;
+    h[k++] = s[i];
+  }
+  long t = k + 1;
+  for (long i = n - 2; i >= 0; i--) {
+    while (k >= t && (h[k-1].x - h[k-2].x) * (s[i].y - h[k-2].y)
+           - (h[k-1].y - h[k-2].y) * (s[i].x - h[k-2].x) <= 0) k--;
+    h[k++] = s[i];
+  }
+  h.resize(k);
+  return h;
+}
+
+/* hullbench double <generator> <n> [seed]
+
+   hull the double coordinates of a generator with the adaptive
+   predicates, and compare with the plain double test and with the
+   int path (truncate, sort, delete_duplicates). Then the
+   same on the points rotated by a small angle around a far center,
+   which makes many turns nearly flat */
+static int bench_double(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: hullbench double <generator> <n> [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0);
+
+  vector<point2Dd> pd;
+  generate_points_d(gen, n, seed, pd);
+  vector<point2D> pi;
+  generate_points(gen, n, seed, pi);
+  char buf[1024];
+  Rtimer rt;
+  printf("double %s n=%ld\n", generator_name(gen), (long) pd.size());
+
+  rt_start(rt);
+  sort(pi.begin(), pi.end(), xy_less);
+  vector<point2D> distinct = delete_duplicates(pi);
+  vector<point2D> hi = monotone_chain_sorted(distinct);
+  rt_stop(rt);
+  rt_sprint(buf, rt);
+  printf("  int      %s  %ld distinct points, h=%ld\n", buf,
+         (long) distinct.size(), (long) hi.size() - 1);
+
+  for (int rotated = 0; rotated < 2; rotated++) {
+    if (rotated) {
+      //rotate by about 1e-3 radian around (1e6, 1e6)
+      double c = cos(1e-3), s = sin(1e-3);
+      for (size_t i = 0; i < pd.size(); i++) {
+        double x = pd[i].x - 1e6, y = pd[i].y - 1e6;
+        pd[i].x = 1e6 + c * x - s * y;
+        pd[i].y = 1e6 + s * x + c * y;
+      }
+      printf("  rotated:\n");
+    }
+    rt_start(rt);
+    vector<point2Dd> hn = naive_chain_d(pd);
+    rt_stop(rt);
+    rt_sprint(buf, rt);
+    printf("  naive    %s  h=%ld\n", buf, (long) hn.size() - 1);
+
+    predicate_stats_reset();
+    rt_start(rt);
+    vector<point2Dd> ha = monotone_chain_d(pd);
+    rt_stop(rt);
+    rt_sprint(buf, rt);
+    PredicateStats st;
+    predicate_stats(&st);
+    printf("  adaptive %s  h=%ld  %ld tests, %ld past the filter (%.4f%%), "
+           "%ld exact\n", buf, (long) ha.size() - 1, st.calls, st.adapt,
+           st.calls ? 100.0 * st.adapt / st.calls : 0.0, st.exact);
+
+    //the adaptive hull is convex and contains a sample of the points
+    long bad = 0;
+    for (size_t i = 0; i + 2 < ha.size(); i++) {
+      bad += orient2d_exact(ha[i], ha[i + 1], ha[i + 2]) <= 0;
+    }
+    long samples = min(200L, 2000000L / (long) ha.size() + 1);
+    for (long k = 0; k < samples && bad == 0; k++) {
+      size_t i = rng_u64(seed, k, 40) % pd.size();
+      for (size_t j = 0; j + 1 < ha.size(); j++) {
+        if (orient2d_exact(ha[j], ha[j + 1], pd[i]) < 0) {
+          bad++;
+          break;
+        }
+      }
+    }
+    printf("  adaptive hull checked exactly: %s\n", bad ? "WRONG" : "ok");
+    if (bad) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+
+/* ****************************** */
+/* hullbench delta <generator> <n> <frames> [changes] [seed]
+
+   each frame, move changes random points by up to 20 units and
+   recompute the hull; then diff it against the previous one, encode,
+   decode and apply the delta, and compare the bytes with sending the
+   whole hull */
+static int bench_delta(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: hullbench delta <generator> <n> <frames> [changes] [seed]\n");
+    return 1;
+  }
+  int gen = parse_generator(argv[0]);
+  long n = atol(argv[1]);
+  long frames = atol(argv[2]);
+  long changes = (argc > 3) ? atol(argv[3]) : 1;
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 1;
+  assert(gen >= 0 && n > 0 && frames > 0 && changes >= 0);
+
+  vector<point2D> p;
+  generate_points(gen, n, seed, p);
+  n = p.size();
+  vector<point2D> prev = monotone_chain(p), consumer = prev;
+  HullDelta d, got;
+  vector<uint8_t> buf;
+  double t_diff = 0, t_encode = 0, t_decode = 0, t_apply = 0;
+  double full_bytes = 0, delta_bytes = 0, ops = 0, changed = 0;
+  long errors = 0;
+  Rtimer rt;
+  for (long f = 1; f <= frames; f++) {
+    for (long c = 0; c < changes; c++) {
+      point2D& q = p[rng_u64(seed, f * changes + c, 50) % n];
+      uint64_t r = rng_u64(seed, f * changes + c, 51);
+      q.x += (int) (r % 41) - 20;
+      q.y += (int) ((r >> 32) % 41) - 20;
+    }
+    vector<point2D> h = monotone_chain(p);
+
+    rt_start(rt);
+    hull_diff(prev, h, d);
+    rt_stop(rt);
+    t_diff += rt_w_useconds(rt);
+    buf.clear();
+    rt_start(rt);
+    size_t bytes = hull_delta_encode(d, buf);
+    rt_stop(rt);
+    t_encode += rt_w_useconds(rt);
+
+    //the consumer's side
+    rt_start(rt);
+    long used = hull_delta_decode(&buf[0], buf.size(), got);
+    rt_stop(rt);
+    t_decode += rt_w_useconds(rt);
+    rt_start(rt);
+    int ok = used == (long) bytes && hull_apply(consumer, got) == 0;
+    rt_stop(rt);
+    t_apply += rt_w_useconds(rt);
+    errors += !(ok && same_points(consumer, h));
+
+    full_bytes += (h.size() - 1) * sizeof(point2D);
+    delta_bytes += bytes;
+    ops += d.ops.size();
+    changed += d.pts.size();
+    prev.swap(h);
+  }
+  printf("delta %s n=%ld h=%ld frames=%ld changes=%ld\n", generator_name(gen),
+         n, (long) prev.size() - 1, frames, changes);
+  printf("  per frame: %.1f edits, %.1f vertices inserted; %.1f bytes "
+         "against %.0f for the whole hull (%.1fx smaller)\n", ops / frames,
+         changed / frames, delta_bytes / frames, full_bytes / frames,
+         full_bytes / delta_bytes);
+  printf("  us per frame: diff %.2f  encode %.2f  decode %.2f  apply %.2f\n",
+         t_diff / frames, t_encode / frames, t_decode / frames,
+         t_apply / frames);
+  printf("  %ld frames differ\n", errors);
+  return errors != 0;
+}
+
+
+/* ****************************** */
+static void usage() {
+  printf("usage: hullbench <command> [args]\n");
+  printf("commands:\n");
+  printf("  gen <generator|all> <n> [threads] [seed]\n");
+  printf("  query <generator> <n> <m> [threads] [seed]\n");
+  printf("  calipers <generator> <n> <count> [threads]\n");
+  printf("  convex <h> <hulls> <pairs> [threads]\n");
+  printf("  merge <generator> <n> <shards> [threads] [seed]\n");
+  printf("  approx <n> <epsilon> [seed]\n");
+  printf("  layers <generator|grid> <n> [seed]\n");
+  printf("  warm <generator> <n> <frames> [step] [seed]\n");
+  printf("  kernels <generator> <n> [seed]\n");
+  printf("  packed <generator> <n> [seed]\n");
+  printf("  chunks <generator> <n> <chunks> [threads] [seed]\n");
+  printf("  anytime <generator> <n> <budget> [seed]\n");
+  printf("  acc <generator> <n> <threads> [seed]\n");
+  printf("  presorted <generator|all> <n> [seed]\n");
+  printf("  pipeline <generator> <n> [filters] [block] [seed]\n");
+  printf("  cache <n> [budget MB] [engine] [seed]\n");
+  printf("  range <generator> <n> <queries> [leaf] [threads] [seed]\n");
+  printf("  view <generator> <n> [seed]\n");
+  printf("  double <generator> <n> [seed]\n");
+  printf("  delta <generator> <n> <frames> [changes] [seed]\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    usage();
+    exit(1);
+  }
+  if (strcmp(argv[1], "gen") == 0) {
+    return bench_gen(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "query") == 0) {
+    return bench_query(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "calipers") == 0) {
+    return bench_calipers(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "convex") == 0) {
+    return bench_convex(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "merge") == 0) {
+    return bench_merge(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "approx") == 0) {
+    return bench_approx(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "layers") == 0) {
+    return bench_layers(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "warm") == 0) {
+    return bench_warm(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "kernels") == 0) {
+    return bench_kernels(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "packed") == 0) {
+    return bench_packed(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "chunks") == 0) {
+    return bench_chunks(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "anytime") == 0) {
+    return bench_anytime(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "acc") == 0) {
+    return bench_acc(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "presorted") == 0) {
+    return bench_presorted(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "pipeline") == 0) {
+    return bench_pipeline(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "cache") == 0) {
+    return bench_cache(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "range") == 0) {
+    return bench_range(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "view") == 0) {
+    return bench_view(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "double") == 0) {
+    return bench_double(argc - 2, argv + 2);
+  }
+  if (strcmp(argv[1], "delta") == 0) {
+    return bench_delta(argc - 2, argv + 2);
+  }
+  usage();
+  return 1;
+}
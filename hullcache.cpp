@@ -0,0 +1,341 @@
+#include "hullcache.h"
+#include "rtimer.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+
+/* **************************************** */
+/* The hash runs four independent lanes of the xxHash64 round over
+   the points, 8 bytes (one point) at a time, so that it runs at
+   memory speed; the two halves of the key are two different
+   finalizations of the lanes. */
+static const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t P3 = 0x165667B19E3779F9ULL;
+static const uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t lane_round(uint64_t acc, uint64_t w) {
+  return rotl(acc + w * P2, 31) * P1;
+}
+
+static inline uint64_t avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= P2;
+  h ^= h >> 29;
+  h *= P3;
+  h ^= h >> 32;
+  return h;
+}
+
+static inline uint64_t point_word(const point2D* p) {
+  uint64_t w;
+  memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+/* the options that change the result of the engine */
+static uint64_t options_hash(const HullOptions& opt) {
+  uint64_t h = lane_round(P4, opt.engine);
+  if (opt.engine == HULL_APPROX) {
+    uint64_t e;
+    memcpy(&e, &opt.epsilon, sizeof(e));
+    h = lane_round(h, e);
+    h = lane_round(h, opt.strips);
+  }
+  return h;
+}
+
+HullKey hull_key(const point2D* p, long n, const HullOptions& opt) {
+  assert(sizeof(point2D) == sizeof(uint64_t));
+  uint64_t seed = options_hash(opt);
+  uint64_t v[4] = {seed + P1 + P2, seed + P2, seed, seed - P1};
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    v[0] = lane_round(v[0], point_word(p + i));
+    v[1] = lane_round(v[1], point_word(p + i + 1));
+    v[2] = lane_round(v[2], point_word(p + i + 2));
+    v[3] = lane_round(v[3], point_word(p + i + 3));
+  }
+  for (; i < n; i++) {
+    v[i & 3] = lane_round(v[i & 3], point_word(p + i));
+  }
+
+  HullKey k;
+  k.n = n;
+  uint64_t h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+  k.h[0] = avalanche(h + (uint64_t) n * P4);
+  h = (v[0] * P3) ^ rotl(v[1] * P4, 17) ^ rotl(v[2] * P1, 31)
+    ^ rotl(v[3] * P2, 47);
+  k.h[1] = avalanche(h ^ (uint64_t) n);
+  return k;
+}
+
+int hull_cacheable(const HullOptions& opt) {
+  return opt.engine != HULL_ANYTIME;
+}
+
+
+/* **************************************** */
+/* The disk tier. The file is a header followed by records; a record
+   is written first and then committed by moving used past it, a
+   single store, so a record that was being written when the process
+   died is ignored when the file is opened again. The records are
+   found by walking them up to used. */
+static const uint64_t DISK_MAGIC = 0x3148434C4C5548ULL; //"HULLCH1"
+
+typedef struct _disk_header {
+  uint64_t magic;
+  uint64_t size;     //of the file
+  uint64_t used;     //bytes of header and committed records
+  uint64_t pad;
+} DiskHeader;
+
+typedef struct _disk_record {
+  uint64_t h[2];
+  int64_t n;
+  int64_t nhull;
+  double us;
+  //followed by nhull points
+} DiskRecord;
+
+static inline size_t record_bytes(long nhull) {
+  return sizeof(DiskRecord) + nhull * sizeof(point2D);
+}
+
+/* build the index of the records; 0 if the file is not a cache */
+static int index_disk(HullCache* c) {
+  DiskHeader* hdr = (DiskHeader*) c->map;
+  if (hdr->magic != DISK_MAGIC || hdr->size != c->map_bytes
+      || hdr->used < sizeof(DiskHeader) || hdr->used > hdr->size) {
+    return 0;
+  }
+  size_t off = sizeof(DiskHeader);
+  while (off < hdr->used) {
+    if (off + sizeof(DiskRecord) > hdr->used) {
+      return 0;
+    }
+    //bound nhull before record_bytes, which a corrupt one overflows
+    DiskRecord* rec = (DiskRecord*) (c->map + off);
+    if (rec->nhull < 0 || (uint64_t) rec->nhull
+        > (hdr->used - off - sizeof(DiskRecord)) / sizeof(point2D)) {
+      return 0;
+    }
+    HullKey k;
+    k.h[0] = rec->h[0];
+    k.h[1] = rec->h[1];
+    k.n = rec->n;
+    c->disk[k] = off;
+    off += record_bytes(rec->nhull);
+  }
+  return off == hdr->used;
+}
+
+static void reset_disk(HullCache* c) {
+  DiskHeader* hdr = (DiskHeader*) c->map;
+  hdr->magic = DISK_MAGIC;
+  hdr->size = c->map_bytes;
+  hdr->used = sizeof(DiskHeader);
+  hdr->pad = 0;
+  c->disk.clear();
+}
+
+int hull_cache_open_disk(HullCache* c, const char* path, size_t bytes) {
+  assert(c->fd < 0);
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+  struct stat st;
+  if (flock(fd, LOCK_EX | LOCK_NB) < 0 || fstat(fd, &st) < 0) {
+    close(fd);
+    return -1;
+  }
+  if ((size_t) st.st_size >= sizeof(DiskHeader)) {
+    bytes = st.st_size;
+  } else if (bytes < sizeof(DiskHeader) || ftruncate(fd, bytes) < 0) {
+    if (bytes < sizeof(DiskHeader)) errno = EINVAL;
+    close(fd);
+    return -1;
+  }
+  void* m = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (m == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+
+  lock_guard<mutex> g(c->lock);
+  c->fd = fd;
+  c->map = (char*) m;
+  c->map_bytes = bytes;
+  if (!index_disk(c)) {
+    reset_disk(c);
+  }
+  return 0;
+}
+
+/* append a record, starting the log over if it is full */
+static void write_disk(HullCache* c, const HullKey& k,
+                       const point2D* hull, long nhull, double us) {
+  DiskHeader* hdr = (DiskHeader*) c->map;
+  size_t need = record_bytes(nhull);
+  if (sizeof(DiskHeader) + need > hdr->size || c->disk.count(k)) {
+    return;
+  }
+  if (hdr->used + need > hdr->size) {
+    reset_disk(c);
+    c->st.disk_resets++;
+  }
+  size_t off = hdr->used;
+  DiskRecord* rec = (DiskRecord*) (c->map + off);
+  rec->h[0] = k.h[0];
+  rec->h[1] = k.h[1];
+  rec->n = k.n;
+  rec->nhull = nhull;
+  rec->us = us;
+  if (nhull) {
+    memcpy(rec + 1, hull, nhull * sizeof(point2D));
+  }
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  hdr->used = off + need;
+  c->disk[k] = off;
+  c->st.disk_writes++;
+}
+
+
+/* **************************************** */
+static inline size_t entry_bytes(long nhull) {
+  //the hull, plus the list node and index entry
+  return nhull * sizeof(point2D) + sizeof(HullCacheEntry) + 64;
+}
+
+HullCache* hull_cache_create(size_t budget) {
+  HullCache* c = new HullCache;
+  c->budget = budget;
+  c->fd = -1;
+  c->map = NULL;
+  c->map_bytes = 0;
+  c->st = HullCacheStats();
+  return c;
+}
+
+void hull_cache_destroy(HullCache* c) {
+  if (c->map) {
+    munmap(c->map, c->map_bytes);
+    close(c->fd);
+  }
+  delete c;
+}
+
+/* insert into the memory tier, evicting from the back; the lock is
+   held */
+static void insert_memory(HullCache* c, const HullKey& k,
+                          const point2D* hull, long nhull, double us) {
+  size_t b = entry_bytes(nhull);
+  if (b > c->budget || c->index.count(k)) {
+    return;
+  }
+  while (c->st.bytes + b > c->budget) {
+    HullCacheEntry& e = c->lru.back();
+    c->st.bytes -= entry_bytes(e.hull.size());
+    c->index.erase(e.key);
+    c->lru.pop_back();
+    c->st.evictions++;
+  }
+  HullCacheEntry e;
+  e.key = k;
+  e.hull.assign(hull, hull + nhull);
+  e.us = us;
+  c->lru.push_front(e);
+  c->index[k] = c->lru.begin();
+  c->st.bytes += b;
+  c->st.inserts++;
+}
+
+int hull_cache_find(HullCache* c, const HullKey& k, vector<point2D>& hull) {
+  Rtimer rt;
+  rt_start(rt);
+  lock_guard<mutex> g(c->lock);
+  c->st.lookups++;
+  int found = 0;
+  auto it = c->index.find(k);
+  if (it != c->index.end()) {
+    c->lru.splice(c->lru.begin(), c->lru, it->second);
+    hull = it->second->hull;
+    c->st.hits++;
+    c->st.saved_us += it->second->us;
+    found = 1;
+  } else if (c->map) {
+    auto d = c->disk.find(k);
+    if (d != c->disk.end()) {
+      DiskRecord* rec = (DiskRecord*) (c->map + d->second);
+      const point2D* p = (const point2D*) (rec + 1);
+      hull.assign(p, p + rec->nhull);
+      insert_memory(c, k, p, rec->nhull, rec->us);
+      c->st.disk_hits++;
+      c->st.saved_us += rec->us;
+      found = 1;
+    }
+  }
+  rt_stop(rt);
+  c->st.lookup_us += rt_w_useconds(rt);
+  return found;
+}
+
+void hull_cache_insert(HullCache* c, const HullKey& k,
+                       const point2D* hull, long nhull, double us) {
+  lock_guard<mutex> g(c->lock);
+  insert_memory(c, k, hull, nhull, us);
+  if (c->map) {
+    write_disk(c, k, hull, nhull, us);
+  }
+}
+
+vector<point2D> cached_hull(HullCache* c, const vector<point2D>& p,
+                            const HullOptions& opt, int* hit) {
+  if (hit) {
+    *hit = 0;
+  }
+  if (!hull_cacheable(opt)) {
+    return compute_hull(p, opt);
+  }
+  Rtimer rt;
+  rt_start(rt);
+  HullKey k = hull_key(p.empty() ? NULL : &p[0], p.size(), opt);
+  rt_stop(rt);
+  {
+    lock_guard<mutex> g(c->lock);
+    c->st.lookup_us += rt_w_useconds(rt);
+  }
+
+  vector<point2D> h;
+  if (hull_cache_find(c, k, h)) {
+    if (hit) {
+      *hit = 1;
+    }
+    return h;
+  }
+  rt_start(rt);
+  h = compute_hull(p, opt);
+  rt_stop(rt);
+  hull_cache_insert(c, k, h.empty() ? NULL : &h[0], h.size(),
+                    rt_w_useconds(rt));
+  return h;
+}
+
+void hull_cache_stats(HullCache* c, HullCacheStats* st) {
+  lock_guard<mutex> g(c->lock);
+  *st = c->st;
+  st->entries = c->lru.size();
+}
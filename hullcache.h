@@ -0,0 +1,109 @@
+#ifndef __hullcache_h
+#define __hullcache_h
+
+#include "geom.h"
+#include "hull.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+/* Content-addressed cache of hull results.
+
+   The viewer cycles through the same sets, and the service sees the
+   same batches submitted again; hashing the points costs a fraction
+   of a pass, much less than computing their hull. A hull is stored
+   under a 128-bit hash of the points, in their order, and of the
+   engine options that change the result.
+
+   The memory tier keeps the most recently used hulls within a byte
+   budget, evicting the least recently used. The optional disk tier
+   is a file mapped in memory that survives restarts: an append-only
+   log of records indexed when the file is opened, started over when
+   it is full. The file is locked, so only one process uses it at a
+   time.
+
+   All functions are thread safe. Hulls of the anytime engine depend
+   on the timing, so cached_hull never caches them. */
+
+typedef struct _hull_key {
+  uint64_t h[2];
+  long n;
+} HullKey;
+
+inline bool operator==(const HullKey& a, const HullKey& b) {
+  return a.h[0] == b.h[0] && a.h[1] == b.h[1] && a.n == b.n;
+}
+
+typedef struct _hull_key_hash {
+  size_t operator()(const HullKey& k) const { return k.h[0]; }
+} HullKeyHash;
+
+/* the key of the hull of p[0..n) computed with opt */
+HullKey hull_key(const point2D* p, long n, const HullOptions& opt);
+
+/* 1 if the result of the engine in opt only depends on the points
+   and the options */
+int hull_cacheable(const HullOptions& opt);
+
+typedef struct _hull_cache_stats {
+  long lookups;
+  long hits;         //found in memory
+  long disk_hits;    //found on disk (and moved to memory)
+  long inserts;
+  long evictions;    //from memory
+  long disk_writes;
+  long disk_resets;  //times the disk log was full and started over
+  long entries;      //in memory now
+  size_t bytes;      //in memory now
+  //compute time of the hulls found, and time spent hashing and
+  //looking up, in us
+  double saved_us, lookup_us;
+} HullCacheStats;
+
+typedef struct _hull_cache_entry {
+  HullKey key;
+  vector<point2D> hull;
+  double us;  //time it took to compute
+} HullCacheEntry;
+
+typedef struct _hull_cache {
+  mutex lock;
+  size_t budget;
+  list<HullCacheEntry> lru;  //most recently used first
+  unordered_map<HullKey, list<HullCacheEntry>::iterator, HullKeyHash> index;
+  //disk tier: the mapped file and the offset of each record
+  int fd;
+  char* map;
+  size_t map_bytes;
+  unordered_map<HullKey, size_t, HullKeyHash> disk;
+  HullCacheStats st;
+} HullCache;
+
+/* create a cache holding at most budget bytes of hulls in memory */
+HullCache* hull_cache_create(size_t budget);
+
+/* free it, and unmap its disk tier */
+void hull_cache_destroy(HullCache* c);
+
+/* add a disk tier: the file at path, created with the given size if
+   it does not hold a cache yet (otherwise its size is kept). Return
+   0, or -1 with errno set (EWOULDBLOCK: another process uses it) */
+int hull_cache_open_disk(HullCache* c, const char* path, size_t bytes);
+
+/* look k up in memory, then on disk; return 1 and set hull if found */
+int hull_cache_find(HullCache* c, const HullKey& k, vector<point2D>& hull);
+
+/* store the hull of k, which took us microseconds to compute */
+void hull_cache_insert(HullCache* c, const HullKey& k,
+                       const point2D* hull, long nhull, double us);
+
+/* compute_hull(p, opt) through the cache. If hit is not NULL it gets
+   1 if the hull was found */
+vector<point2D> cached_hull(HullCache* c, const vector<point2D>& p,
+                            const HullOptions& opt, int* hit = NULL);
+
+void hull_cache_stats(HullCache* c, HullCacheStats* st);
+
+#endif
@@ -0,0 +1,171 @@
+/* hulld.cpp
+
+   Resident hull service. Creates a shared-memory request ring
+   (hullring.h) and serves hull requests from it with a fixed set of
+   threads, so clients pay neither process startup nor setup per
+   request. Each thread owns a workspace sized for the largest
+   request, allocated once.
+
+   usage: hulld [name] [slots] [capacity] [threads] [cache MB] [cache file]
+
+   With a cache (hullcache.h), a batch of points that was already
+   submitted gets its stored hull instead of being sorted and scanned
+   again; with a cache file the hulls survive restarts.
+
+   Stops on SIGINT or SIGTERM; clients waiting on it then get an
+   error. A client that dies holding a ticket is skipped (see
+   hullring.h). Prints the request rate every second while busy.
+*/
+
+#include "geom.h"
+#include "hullcache.h"
+#include "hullring.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace std;
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+/* ****************************** */
+/* service thread: take tickets in order and answer them in place */
+static void serve(HullRingHeader* hdr, HullCache* cache, uint64_t* busy_ns) {
+  vector<point2D> work(2 * (size_t) hdr->capacity + 2);
+  vector<point2D> found;
+  HullOptions opt;
+  hull_default_options(&opt);
+  while (1) {
+    uint64_t t = __atomic_fetch_add(&hdr->tail, 1, __ATOMIC_SEQ_CST);
+    HullSlot* s = hull_ring_slot(hdr, t);
+    int r = hull_ring_serve_wait(hdr, t);
+    if (r < 0) {
+      return;
+    }
+    if (r > 0) {
+      continue;  //the client died; the slot went to the next round
+    }
+
+    uint64_t start = now_ns();
+    long n = min(s->npoints, hdr->capacity);
+    HullKey key;
+    if (cache) {
+      key = hull_key(s->points, n, opt);
+    }
+    if (cache && hull_cache_find(cache, key, found)) {
+      memcpy(s->points, found.data(), found.size() * sizeof(point2D));
+      s->nhull = found.size();
+      s->service_ns = now_ns() - start;
+    } else {
+      sort(s->points, s->points + n, xy_less);
+      long k = monotone_chain_buffer(s->points, n, &work[0]);
+      memcpy(s->points, &work[0], k * sizeof(point2D));
+      s->nhull = k;
+      s->service_ns = now_ns() - start;
+      if (cache) {
+        hull_cache_insert(cache, key, &work[0], k, s->service_ns / 1e3);
+      }
+    }
+    *busy_ns += s->service_ns;
+
+    hull_ring_post(s, hull_ring_word(t, SLOT_DONE));
+    __atomic_add_fetch(&hdr->served, 1, __ATOMIC_RELAXED);
+  }
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+  const char* name = (argc > 1) ? argv[1] : HULL_RING_DEFAULT_NAME;
+  uint32_t nslots = (argc > 2) ? atoi(argv[2]) : 64;
+  uint32_t capacity = (argc > 3) ? atoi(argv[3]) : 65536;
+  int nthreads = (argc > 4) ? atoi(argv[4]) : default_nthreads();
+  double cache_mb = (argc > 5) ? atof(argv[5]) : 0;
+  const char* cache_file = (argc > 6) ? argv[6] : NULL;
+  if (argc > 7 || nslots == 0 || capacity == 0 || nthreads <= 0
+      || cache_mb < 0) {
+    printf("usage: hulld [name] [slots] [capacity] [threads] [cache MB] [cache file]\n");
+    exit(1);
+  }
+  HullCache* cache = NULL;
+  if (cache_mb > 0) {
+    cache = hull_cache_create((size_t) (cache_mb * 1048576));
+    if (cache_file && hull_cache_open_disk(cache, cache_file,
+                                           (size_t) (cache_mb * 1048576)) < 0) {
+      perror(cache_file);
+      exit(1);
+    }
+  }
+
+  HullRingHeader* hdr = hull_ring_create(name, nslots, capacity);
+  if (hdr == NULL) {
+    perror(name);
+    exit(1);
+  }
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  printf("hulld: serving %s, %u slots of %u points (%.1f MB), %d threads\n",
+         name, nslots, capacity,
+         hull_ring_size(nslots, capacity) / 1048576.0, nthreads);
+  fflush(stdout);
+
+  vector<uint64_t> busy(nthreads, 0);
+  vector<thread> threads;
+  for (int i = 0; i < nthreads; i++) {
+    threads.push_back(thread(serve, hdr, cache, &busy[i]));
+  }
+
+  uint64_t last = 0;
+  uint64_t t0 = now_ns();
+  while (!stop) {
+    sleep(1);
+    uint64_t served = __atomic_load_n(&hdr->served, __ATOMIC_RELAXED);
+    if (served != last) {
+      printf("hulld: %llu req/s\n", (unsigned long long) (served - last));
+      fflush(stdout);
+      last = served;
+    }
+  }
+
+  __atomic_store_n(&hdr->shutdown, 1, __ATOMIC_SEQ_CST);
+  for (int i = 0; i < nthreads; i++) {
+    threads[i].join();
+  }
+  uint64_t total_busy = 0;
+  for (int i = 0; i < nthreads; i++) {
+    total_busy += busy[i];
+  }
+  uint64_t served = hdr->served;
+  printf("hulld: %llu requests in %.1f s, mean service time %.1f us\n",
+         (unsigned long long) served, (now_ns() - t0) / 1e9,
+         served ? total_busy / 1e3 / served : 0.0);
+  if (cache) {
+    HullCacheStats st;
+    hull_cache_stats(cache, &st);
+    printf("hulld: cache %ld/%ld hits (%ld from disk), saved %.0f us\n",
+           st.hits + st.disk_hits, st.lookups, st.disk_hits, st.saved_us);
+    hull_cache_destroy(cache);
+  }
+  hull_ring_detach(hdr);
+  hull_ring_unlink(name);
+  return 0;
+}
@@ -0,0 +1,243 @@
+#include "hulldelta.h"
+#include <assert.h>
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+
+
+/* **************************************** */
+/* number of vertices of h, without the closing copy */
+static long vertices(const vector<point2D>& h) {
+  long n = h.size();
+  if (n > 1 && h[0].x == h[n-1].x && h[0].y == h[n-1].y) {
+    n--;
+  }
+  return n;
+}
+
+static inline uint64_t point_key(point2D p) {
+  return ((uint64_t) (uint32_t) p.x << 32) | (uint32_t) p.y;
+}
+
+static void replace_all(const vector<point2D>& new_hull, long h1, long h2,
+                        HullDelta& d) {
+  d.ops.clear();
+  d.pts.assign(new_hull.begin(), new_hull.begin() + h2);
+  d.rotate = 0;
+  if (h1 > 0 || h2 > 0) {
+    HullOp op = {0, h1, h2};
+    d.ops.push_back(op);
+  }
+}
+
+void hull_diff(const vector<point2D>& old_hull,
+               const vector<point2D>& new_hull, HullDelta& d) {
+  long h1 = vertices(old_hull), h2 = vertices(new_hull);
+  d.old_size = h1;
+  d.new_size = h2;
+  d.ops.clear();
+  d.pts.clear();
+  d.rotate = 0;
+
+  //the old index of each new vertex, or -1; first is the common
+  //vertex that comes first in the old hull
+  unordered_map<uint64_t, long> at(2 * h1);
+  for (long i = 0; i < h1; i++) {
+    at[point_key(old_hull[i])] = i;
+  }
+  vector<long> m(h2);
+  long first = -1;
+  for (long j = 0; j < h2; j++) {
+    auto it = at.find(point_key(new_hull[j]));
+    m[j] = (it == at.end()) ? -1 : it->second;
+    if (m[j] >= 0 && (first < 0 || m[j] < m[first])) {
+      first = j;
+    }
+  }
+  if (first < 0) {
+    replace_all(new_hull, h1, h2, d);
+    return;
+  }
+
+  //walk the new hull from first: the common vertices come by
+  //increasing old index, and the vertices between two of them are
+  //inserted in place of the old ones between them. The edited chain
+  //then starts at new_hull[first]
+  if (m[first] > 0) {
+    HullOp op = {0, m[first], 0};
+    d.ops.push_back(op);
+  }
+  long cur = m[first];
+  size_t run = 0;
+  for (long t = 1; t <= h2; t++) {
+    long j = (first + t) % h2;
+    if (t < h2 && m[j] < 0) {
+      d.pts.push_back(new_hull[j]);
+      continue;
+    }
+    long next = (t < h2) ? m[j] : h1;
+    if (next <= cur) {
+      //not the same cyclic order: the inputs are not hulls in the
+      //expected form
+      replace_all(new_hull, h1, h2, d);
+      return;
+    }
+    HullOp op = {cur + 1, next - cur - 1, (long) (d.pts.size() - run)};
+    if (op.del || op.ins) {
+      d.ops.push_back(op);
+    }
+    cur = next;
+    run = d.pts.size();
+  }
+  d.rotate = (h2 - first) % h2;
+}
+
+
+/* **************************************** */
+int hull_apply(vector<point2D>& hull, const HullDelta& d) {
+  long n = hull.size();
+  //an empty hull has no form of its own: it grows into the closed
+  //form, as monotone_chain returns it
+  int closed = (n == 0);
+  if (n == d.old_size + 1 && vertices(hull) == d.old_size) {
+    closed = 1;
+  } else if (n != d.old_size) {
+    return -1;
+  }
+
+  vector<point2D> out;
+  out.reserve(d.new_size + 1);
+  long pos = 0;
+  size_t k = 0;
+  for (size_t i = 0; i < d.ops.size(); i++) {
+    const HullOp& op = d.ops[i];
+    if (op.pos < pos || op.pos + op.del > d.old_size
+        || k + op.ins > d.pts.size()) {
+      return -1;
+    }
+    out.insert(out.end(), hull.begin() + pos, hull.begin() + op.pos);
+    out.insert(out.end(), d.pts.begin() + k, d.pts.begin() + k + op.ins);
+    pos = op.pos + op.del;
+    k += op.ins;
+  }
+  out.insert(out.end(), hull.begin() + pos, hull.begin() + d.old_size);
+  if ((long) out.size() != d.new_size || k != d.pts.size()
+      || (d.new_size > 0 && (d.rotate < 0 || d.rotate >= d.new_size))) {
+    return -1;
+  }
+
+  rotate(out.begin(), out.begin() + (d.new_size ? d.rotate : 0), out.end());
+  if (closed && !out.empty()) {
+    out.push_back(out[0]);
+  }
+  hull.swap(out);
+  return 0;
+}
+
+
+/* **************************************** */
+/* LEB128 varints, and zigzag for signed values */
+static const uint8_t DELTA_VERSION = 1;
+
+static void put_varint(uint64_t v, vector<uint8_t>& out) {
+  while (v >= 0x80) {
+    out.push_back((uint8_t) (v | 0x80));
+    v >>= 7;
+  }
+  out.push_back((uint8_t) v);
+}
+
+static int get_varint(const uint8_t* buf, size_t len, size_t& at,
+                      uint64_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 64 && at < len; shift += 7) {
+    uint8_t b = buf[at++];
+    v |= (uint64_t) (b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static inline uint64_t zigzag(long long v) {
+  return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+}
+
+static inline long long unzigzag(uint64_t v) {
+  return (long long) (v >> 1) ^ -(long long) (v & 1);
+}
+
+size_t hull_delta_encode(const HullDelta& d, vector<uint8_t>& out) {
+  size_t start = out.size();
+  out.push_back(DELTA_VERSION);
+  put_varint(d.old_size, out);
+  put_varint(d.new_size, out);
+  put_varint(d.rotate, out);
+  put_varint(d.ops.size(), out);
+  long end = 0;
+  for (size_t i = 0; i < d.ops.size(); i++) {
+    put_varint(d.ops[i].pos - end, out);
+    put_varint(d.ops[i].del, out);
+    put_varint(d.ops[i].ins, out);
+    end = d.ops[i].pos + d.ops[i].del;
+  }
+  point2D prev = {0, 0};
+  for (size_t i = 0; i < d.pts.size(); i++) {
+    put_varint(zigzag((long long) d.pts[i].x - prev.x), out);
+    put_varint(zigzag((long long) d.pts[i].y - prev.y), out);
+    prev = d.pts[i];
+  }
+  return out.size() - start;
+}
+
+long hull_delta_decode(const uint8_t* buf, size_t len, HullDelta& d) {
+  size_t at = 0;
+  if (len < 1 || buf[at++] != DELTA_VERSION) {
+    return -1;
+  }
+  uint64_t old_size, new_size, rot, nops;
+  if (!get_varint(buf, len, at, old_size) || !get_varint(buf, len, at, new_size)
+      || !get_varint(buf, len, at, rot) || !get_varint(buf, len, at, nops)
+      || old_size > (1ULL << 40) || new_size > (1ULL << 40)
+      || nops > len - at) {
+    return -1;
+  }
+  d.old_size = old_size;
+  d.new_size = new_size;
+  d.rotate = rot;
+  d.ops.resize(nops);
+  //check the sizes as we go, so that a corrupt buffer cannot make us
+  //allocate much more than its size
+  uint64_t end = 0, ins = 0;
+  for (uint64_t i = 0; i < nops; i++) {
+    uint64_t gap, del, n;
+    if (!get_varint(buf, len, at, gap) || !get_varint(buf, len, at, del)
+        || !get_varint(buf, len, at, n) || gap > old_size - end
+        || del > old_size - end - gap || n > len) {
+      return -1;
+    }
+    d.ops[i].pos = end + gap;
+    d.ops[i].del = del;
+    d.ops[i].ins = n;
+    end += gap + del;
+    ins += n;
+  }
+  if (ins > (len - at) / 2) {
+    return -1;
+  }
+  d.pts.resize(ins);
+  long long x = 0, y = 0;
+  for (uint64_t i = 0; i < ins; i++) {
+    uint64_t dx, dy;
+    if (!get_varint(buf, len, at, dx) || !get_varint(buf, len, at, dy)) {
+      return -1;
+    }
+    x += unzigzag(dx);
+    y += unzigzag(dy);
+    d.pts[i].x = (int) x;
+    d.pts[i].y = (int) y;
+  }
+  return at;
+}
@@ -0,0 +1,60 @@
+#ifndef __hulldelta_h
+#define __hulldelta_h
+
+#include "geom.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/* Changes between consecutive hulls, for consumers that follow the
+   hull of a changing point set.
+
+   Two convex hulls list their common vertices in the same cyclic
+   (ccw) order, so the new hull is the old one with runs of vertices
+   removed and runs inserted. hull_diff finds the common vertices with
+   a hash of the old ones, in O(h1+h2), and describes the new hull as
+   edits keyed by position along the old chain, plus a rotation for
+   the new starting vertex. The delta is as large as the change: when
+   one vertex moves it is one edit removing one vertex and inserting
+   one.
+
+   The binary encoding is a few varints per edit, and the inserted
+   vertices as zigzag varints of their difference from the previous
+   inserted vertex, which is usually their neighbor on the hull. A
+   delta that changes a vertex or two takes a dozen bytes, against
+   8h for the whole hull.
+
+   The hulls are in the form of graham_scan and monotone_chain (ccw,
+   distinct vertices, optionally closed). */
+
+/* an edit: remove del vertices of the old hull from position pos,
+   and insert ins vertices there, the next ins of HullDelta.pts */
+typedef struct _hull_op {
+  long pos, del, ins;
+} HullOp;
+
+typedef struct _hull_delta {
+  long old_size, new_size;  //vertices, not counting the closing copy
+  long rotate;              //the new hull starts at this position of
+                            //the edited chain
+  vector<HullOp> ops;       //by increasing pos, not overlapping
+  vector<point2D> pts;      //inserted vertices, in order
+} HullDelta;
+
+/* the delta that turns old_hull into new_hull */
+void hull_diff(const vector<point2D>& old_hull,
+               const vector<point2D>& new_hull, HullDelta& d);
+
+/* apply d to hull, which must be the old hull of d (closed or not;
+   it stays in the same form, and an empty hull becomes closed).
+   Returns 0, or -1 if the size of hull does not match d (it is then
+   unchanged) */
+int hull_apply(vector<point2D>& hull, const HullDelta& d);
+
+/* append the encoding of d to out; return its size in bytes */
+size_t hull_delta_encode(const HullDelta& d, vector<uint8_t>& out);
+
+/* decode a delta from buf[0..len); return the number of bytes read,
+   or -1 if buf does not hold a valid delta */
+long hull_delta_decode(const uint8_t* buf, size_t len, HullDelta& d);
+
+#endif
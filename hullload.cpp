@@ -0,0 +1,147 @@
+/* hullload.cpp
+
+   Load generator for hulld. Starts client threads that each send a
+   stream of hull requests through the shared-memory ring, writing
+   the generated points straight into the request slot. Reports the
+   latency percentiles (from taking a ticket to reading the hull) and
+   the sustained request rate.
+
+   usage: hullload [name] [clients] [requests] [points] [generator] [distinct]
+
+   requests is per client. With distinct > 0 the requests cycle
+   through that many point sets, as when clients resubmit the same
+   batches (see the hulld cache). The first and last hull of each
+   client are checked against monotone_chain.
+*/
+
+#include "geom.h"
+#include "generators.h"
+#include "hullring.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace std;
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* one client: send requests and record their latencies; *done is
+   the number of requests completed */
+static void client(HullRingHeader* hdr, int id, long requests, long npoints,
+                   int gen, long distinct, uint64_t* lat, long* done,
+                   int* errors) {
+  for (long i = 0; i < requests; i++) {
+    uint64_t seed = (uint64_t) id * requests + i;
+    if (distinct > 0) {
+      seed %= distinct;
+    }
+    seed++;
+    uint64_t start = now_ns();
+
+    HullRequest r;
+    point2D* buf = hull_request_begin(hdr, &r);
+    if (buf == NULL) {
+      (*errors)++;
+      return;
+    }
+    generate_points(gen, npoints, seed, buf, 1);
+    hull_request_submit(hdr, &r, generator_count(gen, npoints));
+    uint32_t nhull;
+    const point2D* h = hull_request_wait(hdr, &r, &nhull);
+    if (h == NULL) {
+      (*errors)++;
+      return;
+    }
+    lat[i] = now_ns() - start;
+    *done = i + 1;
+
+    if (i == 0 || i == requests - 1) {
+      vector<point2D> p;
+      generate_points(gen, npoints, seed, p, 1);
+      vector<point2D> ref = monotone_chain(p);
+      if (ref.size() != nhull
+          || memcmp(&ref[0], h, nhull * sizeof(point2D)) != 0) {
+        (*errors)++;
+      }
+    }
+    hull_request_end(hdr, &r);
+  }
+}
+
+static double percentile(const vector<uint64_t>& sorted, double q) {
+  size_t i = (size_t) (q * (sorted.size() - 1));
+  return sorted[i] / 1e3;
+}
+
+int main(int argc, char** argv) {
+  const char* name = (argc > 1) ? argv[1] : HULL_RING_DEFAULT_NAME;
+  int nclients = (argc > 2) ? atoi(argv[2]) : 4;
+  long requests = (argc > 3) ? atol(argv[3]) : 10000;
+  long npoints = (argc > 4) ? atol(argv[4]) : 1000;
+  int gen = (argc > 5) ? generator_by_name(argv[5]) : GEN_RANDOM;
+  long distinct = (argc > 6) ? atol(argv[6]) : 0;
+  if (argc > 7 || nclients <= 0 || requests <= 0 || npoints <= 0 || gen < 0
+      || distinct < 0) {
+    printf("usage: hullload [name] [clients] [requests] [points] [generator] [distinct]\n");
+    exit(1);
+  }
+
+  HullRingHeader* hdr = hull_ring_attach(name);
+  if (hdr == NULL) {
+    perror(name);
+    exit(1);
+  }
+  if (generator_count(gen, npoints) > (long) hdr->capacity) {
+    printf("%ld points do not fit in a slot of %u\n", npoints, hdr->capacity);
+    exit(1);
+  }
+
+  vector<uint64_t> all(nclients * requests, 0);
+  vector<long> done(nclients, 0);
+  vector<int> errors(nclients, 0);
+  vector<thread> threads;
+  uint64_t start = now_ns();
+  for (int c = 0; c < nclients; c++) {
+    threads.push_back(thread(client, hdr, c, requests, npoints, gen,
+                             distinct, &all[c * requests], &done[c],
+                             &errors[c]));
+  }
+  for (int c = 0; c < nclients; c++) {
+    threads[c].join();
+  }
+  double secs = (now_ns() - start) / 1e9;
+
+  //a client stops at its first failed request: only the completed
+  //ones count for the latencies and the rate
+  int nerrors = 0;
+  vector<uint64_t> lat;
+  for (int c = 0; c < nclients; c++) {
+    nerrors += errors[c];
+    lat.insert(lat.end(), all.begin() + c * requests,
+               all.begin() + c * requests + done[c]);
+  }
+  if (lat.empty()) {
+    printf("hullload: no request completed, %d errors\n", nerrors);
+    return 1;
+  }
+  sort(lat.begin(), lat.end());
+  printf("hullload: %d clients x %ld requests of %ld %s points\n",
+         nclients, requests, npoints, generator_name(gen));
+  printf("  %.0f req/s sustained (%.2f s, %ld completed)\n", lat.size() / secs,
+         secs, (long) lat.size());
+  printf("  latency us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+         percentile(lat, 0.5), percentile(lat, 0.9), percentile(lat, 0.99),
+         percentile(lat, 0.999), lat.back() / 1e3);
+  printf("  %d errors\n", nerrors);
+  hull_ring_detach(hdr);
+  return nerrors != 0;
+}
@@ -0,0 +1,160 @@
+#include "hullmerge.h"
+#include "kernels.h"
+#include "parallel.h"
+#include <algorithm>
+#include <assert.h>
+
+using namespace std;
+
+
+/* **************************************** */
+void hull_xy_sorted(const vector<point2D>& v, vector<point2D>& out) {
+  out.clear();
+  int h = v.size();
+  if (h > 1 && v[h-1].x == v[0].x && v[h-1].y == v[0].y) {
+    h--;
+  }
+  if (h == 0) {
+    return;
+  }
+
+  //the leftmost and rightmost vertices split the hull into chains
+  int lo = 0, hi = 0;
+  for (int i = 1; i < h; i++) {
+    if (xy_less(v[i], v[lo])) lo = i;
+    if (xy_less(v[hi], v[i])) hi = i;
+  }
+  out.reserve(h);
+
+  //lower chain: lo to hi ccw, increasing. Upper chain: the vertices
+  //strictly between hi and lo ccw, walked backwards so that they are
+  //increasing too. Merge the two.
+  int i = lo;
+  int j = (lo - 1 + h) % h;
+  int lower_left = (hi - lo + h) % h + 1;
+  int upper_left = (lo - hi + h) % h - 1;
+  if (lo == hi) {
+    upper_left = 0;
+  }
+  while (lower_left > 0 || upper_left > 0) {
+    if (upper_left == 0 || (lower_left > 0 && xy_less(v[i], v[j]))) {
+      out.push_back(v[i]);
+      i = (i + 1) % h;
+      lower_left--;
+    } else {
+      out.push_back(v[j]);
+      j = (j - 1 + h) % h;
+      upper_left--;
+    }
+  }
+}
+
+vector<point2D> hull_merge(const vector<point2D>& a,
+                           const vector<point2D>& b) {
+  vector<point2D> sa, sb;
+  hull_xy_sorted(a, sa);
+  hull_xy_sorted(b, sb);
+
+  vector<point2D> s(sa.size() + sb.size());
+  merge(sa.begin(), sa.end(), sb.begin(), sb.end(), s.begin(), xy_less);
+  return monotone_chain_sorted(s);
+}
+
+vector<point2D> hull_merge_all(const vector<point2D>* hulls, long count,
+                               int nthreads) {
+  if (count == 0) {
+    return vector<point2D>();
+  }
+  vector<vector<point2D> > level(hulls, hulls + count);
+  while (level.size() > 1) {
+    long pairs = level.size() / 2;
+    vector<vector<point2D> > next(pairs + level.size() % 2);
+    parallel_for(pairs, nthreads, [&](long begin, long end, int tid) {
+        for (long i = begin; i < end; i++) {
+          next[i] = hull_merge(level[2*i], level[2*i+1]);
+        }
+      });
+    if (level.size() % 2) {
+      next[pairs].swap(level.back());
+    }
+    level.swap(next);
+  }
+  return level[0];
+}
+
+
+/* **************************************** */
+vector<point2D> chunked_hull(const vector<point2D>& p, long chunks,
+                             int nthreads, ChunkStats* st) {
+  long n = p.size();
+  chunks = max(1L, min(chunks, n));
+  ChunkStats total = {0, 0, 0};
+  if (n == 0) {
+    if (st) *st = total;
+    return vector<point2D>();
+  }
+  const HullKernels* kr = hull_kernels();
+  point2D poly[NB_EXTREMES];
+  int m = hull_octagon(&p[0], n, poly, kr);
+
+  vector<vector<point2D> > hulls(chunks);
+  vector<ChunkStats> stats(chunks);
+  parallel_for(chunks, nthreads, [&](long begin, long end, int tid) {
+      vector<point2D> s;
+      for (long c = begin; c < end; c++) {
+        const point2D* q = &p[0] + n * c / chunks;
+        long nq = n * (c + 1) / chunks - n * c / chunks;
+        ChunkStats& cs = stats[c];
+        cs.skipped = cs.kept = cs.merged = 0;
+
+        //the chunk is inside the convex octagon if its bounding box is
+        int inside = (m >= 3);
+        if (inside) {
+          point2D lo = q[0], hi = q[0];
+          for (long i = 1; i < nq; i++) {
+            lo.x = min(lo.x, q[i].x);
+            lo.y = min(lo.y, q[i].y);
+            hi.x = max(hi.x, q[i].x);
+            hi.y = max(hi.y, q[i].y);
+          }
+          point2D box[4] = {lo, {hi.x, lo.y}, hi, {lo.x, hi.y}};
+          for (int e = 0; e < m && inside; e++) {
+            for (int j = 0; j < 4 && inside; j++) {
+              inside = orient2D(poly[e], poly[(e + 1) % m], box[j]) > 0;
+            }
+          }
+        }
+        if (inside) {
+          cs.skipped = 1;
+          continue;
+        }
+
+        s.resize(nq);
+        long ns = (m >= 3) ? kr->prefilter(q, nq, poly, m, &s[0]) : nq;
+        if (m < 3) {
+          copy(q, q + nq, s.begin());
+        }
+        s.resize(ns);
+        sort(s.begin(), s.end(), xy_less);
+        hulls[c] = monotone_chain_sorted(s);
+        cs.kept = ns;
+        cs.merged = hulls[c].size();
+      }
+    });
+
+  //merge the chunks that were not dropped
+  vector<vector<point2D> > live;
+  for (long c = 0; c < chunks; c++) {
+    total.skipped += stats[c].skipped;
+    total.kept += stats[c].kept;
+    total.merged += stats[c].merged;
+    if (hulls[c].size() > 0) {
+      live.push_back(vector<point2D>());
+      live.back().swap(hulls[c]);
+    }
+  }
+  if (st) {
+    *st = total;
+  }
+  return hull_merge_all(live.size() ? &live[0] : NULL, live.size(), nthreads);
+}
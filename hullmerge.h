@@ -0,0 +1,48 @@
+#ifndef __hullmerge_h
+#define __hullmerge_h
+
+#include "geom.h"
+
+/* Merging of precomputed hulls, for sharded computation: each shard
+   computes the hull of its points, and the hulls are merged instead
+   of re-running the hull on the union of the points.
+
+   The inputs are ccw hulls in the form graham_scan and
+   monotone_chain return (any starting vertex, optionally closed).
+   The result is in the same form. */
+
+/* list the vertices of ccw hull h in xy_less order, in O(h) and
+   without sorting: the lower chain followed by the reversed upper
+   chain are each already sorted, so they are merged */
+void hull_xy_sorted(const vector<point2D>& h, vector<point2D>& out);
+
+/* return the hull of the union of hulls a and b in O(h1+h2) */
+vector<point2D> hull_merge(const vector<point2D>& a,
+                           const vector<point2D>& b);
+
+/* return the hull of the union of hulls[0..count), merged pairwise
+   by a balanced reduction tree. The merges of each level run on
+   nthreads threads (<= 0 means default_nthreads()). */
+vector<point2D> hull_merge_all(const vector<point2D>* hulls, long count,
+                               int nthreads = 0);
+
+/* statistics of chunked_hull */
+typedef struct _chunk_stats {
+  long skipped;  //chunks inside the octagon, dropped whole
+  long kept;     //points left by the octagon prefilter
+  long merged;   //vertices of the chunk hulls: the input of the merge
+} ChunkStats;
+
+/* return the hull of p computed in chunks: the octagon of the
+   extreme points is found first; p is split into chunks contiguous
+   ranges, and each chunk is dropped whole if its bounding box is
+   strictly inside the octagon, or else prefiltered against it and
+   hulled. The chunk hulls are merged with hull_merge_all. Chunks run
+   on nthreads threads. If st is not NULL it gets the statistics.
+
+   This only pays if the chunks are spatially compact; reorder p
+   along a space-filling curve first (sfc_reorder) if they are not. */
+vector<point2D> chunked_hull(const vector<point2D>& p, long chunks,
+                             int nthreads = 0, ChunkStats* st = NULL);
+
+#endif
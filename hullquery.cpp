@@ -0,0 +1,209 @@
+#include "hullquery.h"
+#include "parallel.h"
+#include <assert.h>
+
+using namespace std;
+
+typedef __int128 int128;
+
+
+/* **************************************** */
+/* 0 if vector (x,y) has angle in [0,pi), 1 if in [pi,2pi) */
+static inline int half(long long x, long long y) {
+  return (y < 0 || (y == 0 && x < 0)) ? 1 : 0;
+}
+
+/* return 1 if the angle of (ax,ay) is smaller than the angle of
+   (bx,by), both measured in [0,2pi) */
+static inline int angle_less(long long ax, long long ay,
+                             long long bx, long long by) {
+  int ha = half(ax, ay), hb = half(bx, by);
+  if (ha != hb) {
+    return ha < hb;
+  }
+  return (int128) ax * by - (int128) ay * bx > 0;
+}
+
+/* index of a vertex that maximizes the dot product with (dx,dy): the
+   start of the first edge whose angle is >= the angle of (dx,dy)
+   turned left by 90 degrees */
+static int extreme(const vector<point2D>& v, long long dx, long long dy) {
+  int h = v.size();
+  long long px = -dy, py = dx;
+  int lo = 0, hi = h;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    const point2D& a = v[mid];
+    const point2D& b = v[(mid + 1) % h];
+    if (angle_less((long long) b.x - a.x, (long long) b.y - a.y, px, py)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo % h;
+}
+
+/* return 1 if q is on segment ab (a,b,q collinear is checked too) */
+static int on_segment(point2D a, point2D b, point2D q) {
+  return orient2D(a, b, q) == 0
+    && min(a.x, b.x) <= q.x && q.x <= max(a.x, b.x)
+    && min(a.y, b.y) <= q.y && q.y <= max(a.y, b.y);
+}
+
+/* locate q in the fan of triangles v[0],v[k],v[k+1]. Return 1 if q
+   is inside the hull. Otherwise return 0 and set *edge to an edge
+   (index of its first vertex) that q sees, i.e. q is strictly right
+   of it. Requires h >= 3. */
+static int locate(const vector<point2D>& v, point2D q, int* edge) {
+  int h = v.size();
+  if (orient2D(v[0], v[1], q) < 0) {
+    *edge = 0;
+    return 0;
+  }
+  if (orient2D(v[0], v[h-1], q) > 0) {
+    *edge = h - 1;
+    return 0;
+  }
+  //largest k in [1,h-2] with q left of or on v[0]->v[k]
+  int lo = 1, hi = h - 2;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (orient2D(v[0], v[mid], q) >= 0) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  if (orient2D(v[lo], v[lo+1], q) >= 0) {
+    return 1;
+  }
+  *edge = lo;
+  return 0;
+}
+
+
+/* **************************************** */
+void hq_build(HullQuery& hq, const vector<point2D>& h) {
+  hq.v = hull_canonical(h);
+}
+
+int hq_contains(const HullQuery& hq, point2D q) {
+  const vector<point2D>& v = hq.v;
+  switch (v.size()) {
+  case 0:
+    return 0;
+  case 1:
+    return v[0].x == q.x && v[0].y == q.y;
+  case 2:
+    return on_segment(v[0], v[1], q);
+  }
+  int edge;
+  return locate(v, q, &edge);
+}
+
+int hq_extreme(const HullQuery& hq, point2D d) {
+  if (hq.v.size() == 0) {
+    return -1;
+  }
+  return extreme(hq.v, d.x, d.y);
+}
+
+int hq_tangents(const HullQuery& hq, point2D q, int* left, int* right) {
+  const vector<point2D>& v = hq.v;
+  int h = v.size();
+  if (h == 0 || hq_contains(hq, q)) {
+    return 0;
+  }
+  if (h == 1) {
+    *left = *right = 0;
+    return 1;
+  }
+  if (h == 2) {
+    long long o = orient2D(q, v[0], v[1]);
+    *left = (o > 0) ? 1 : 0;
+    *right = (o > 0) ? 0 : 1;
+    if (o == 0) {
+      //q is on the line through the segment; both tangents touch
+      //the nearer endpoint
+      long long d0 = (long long) (v[0].x - q.x) * (v[0].x - q.x)
+        + (long long) (v[0].y - q.y) * (v[0].y - q.y);
+      long long d1 = (long long) (v[1].x - q.x) * (v[1].x - q.x)
+        + (long long) (v[1].y - q.y) * (v[1].y - q.y);
+      *left = *right = (d0 <= d1) ? 0 : 1;
+    }
+    return 1;
+  }
+
+  /* The edges q sees (q strictly right of them) form one run along
+     the boundary; the tangents are its two ends. Start from a seen
+     edge k and let f be the vertex extreme in the direction opposite
+     to the outward normal of k, which q cannot see. Along the chain
+     k->f the edges go from seen to unseen, and along f->k from
+     unseen to seen, so each end is found by binary search. */
+  int k;
+  locate(v, q, &k);
+  point2D a = v[k], b = v[(k + 1) % h];
+  int f = extreme(v, -((long long) b.y - a.y), (long long) b.x - a.x);
+
+  //first unseen edge on the chain k->f; it starts at the right tangent
+  int len = (f - k + h) % h;
+  int lo = 1, hi = len;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    int i = (k + mid) % h;
+    if (orient2D(q, v[i], v[(i + 1) % h]) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *right = (k + lo) % h;
+
+  //first seen edge on the chain f->k; it starts at the left tangent
+  len = (k - f + h) % h;
+  lo = 0;
+  hi = len;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    int i = (f + mid) % h;
+    if (orient2D(q, v[i], v[(i + 1) % h]) < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  *left = (f + lo) % h;
+  return 1;
+}
+
+
+/* **************************************** */
+void hq_contains_batch(const HullQuery& hq, const point2D* q, long m,
+                       char* inside, int nthreads) {
+  parallel_for(m, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        inside[i] = hq_contains(hq, q[i]);
+      }
+    });
+}
+
+void hq_extreme_batch(const HullQuery& hq, const point2D* d, long m,
+                      int* index, int nthreads) {
+  parallel_for(m, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        index[i] = hq_extreme(hq, d[i]);
+      }
+    });
+}
+
+void hq_tangents_batch(const HullQuery& hq, const point2D* q, long m,
+                       int* left, int* right, int nthreads) {
+  parallel_for(m, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        if (!hq_tangents(hq, q[i], &left[i], &right[i])) {
+          left[i] = right[i] = -1;
+        }
+      }
+    });
+}
@@ -0,0 +1,51 @@
+#ifndef __hullquery_h
+#define __hullquery_h
+
+#include "geom.h"
+
+/* A convex hull prepared for O(lg h) queries by binary search on
+   the convex chain. Built from the output of graham_scan (or any
+   hull, see hull_canonical).
+
+   The vertices are in canonical form: ccw, starting at the lowest
+   (then leftmost) vertex. The edge directions v[i]->v[i+1] then have
+   strictly increasing angles in [0, 2pi), which is what the searches
+   rely on. Vertex indices returned by the queries refer to v.
+
+   All predicates are exact for coordinates of absolute value < 2^30.
+*/
+typedef struct _hull_query {
+  vector<point2D> v;
+} HullQuery;
+
+/* prepare hull h for queries */
+void hq_build(HullQuery& hq, const vector<point2D>& h);
+
+/* return 1 if q is inside the hull or on its boundary; 0 otherwise */
+int hq_contains(const HullQuery& hq, point2D q);
+
+/* return the index of a vertex extreme in direction d, i.e. one that
+   maximizes the dot product with d; -1 if the hull is empty */
+int hq_extreme(const HullQuery& hq, point2D d);
+
+/* compute the tangents from q to the hull. Return 0 if q is inside
+   or on the hull (no tangents); otherwise return 1 and set
+   *left and *right to the tangent vertices: looking from q towards
+   the hull, all of it is on or right of the line q->v[*left], and on
+   or left of the line q->v[*right] */
+int hq_tangents(const HullQuery& hq, point2D q, int* left, int* right);
+
+
+/* batch versions: answer queries q[0..m) on nthreads threads
+   (<= 0 means default_nthreads()) */
+void hq_contains_batch(const HullQuery& hq, const point2D* q, long m,
+                       char* inside, int nthreads = 0);
+
+void hq_extreme_batch(const HullQuery& hq, const point2D* d, long m,
+                      int* index, int nthreads = 0);
+
+/* left[i], right[i] are -1 if q[i] is inside the hull */
+void hq_tangents_batch(const HullQuery& hq, const point2D* q, long m,
+                       int* left, int* right, int nthreads = 0);
+
+#endif
@@ -0,0 +1,293 @@
+#include "hullring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+using namespace std;
+
+#define LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static const size_t HEADER_BYTES = 64;
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+
+/* **************************************** */
+size_t hull_ring_size(uint32_t nslots, uint32_t capacity) {
+  //one extra point for the closing vertex of the hull
+  size_t slot = offsetof(HullSlot, points) + ((size_t) capacity + 1) * sizeof(point2D);
+  slot = (slot + 63) & ~(size_t) 63;
+  return HEADER_BYTES + nslots * slot;
+}
+
+HullSlot* hull_ring_slot(HullRingHeader* hdr, uint64_t i) {
+  char* base = (char*) hdr + HEADER_BYTES;
+  return (HullSlot*) (base + (i % hdr->nslots) * hdr->slot_bytes);
+}
+
+HullRingHeader* hull_ring_create(const char* name, uint32_t nslots,
+                                 uint32_t capacity) {
+  size_t size = hull_ring_size(nslots, capacity);
+  shm_unlink(name);
+  int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    return NULL;
+  }
+  if (ftruncate(fd, size) < 0) {
+    close(fd);
+    return NULL;
+  }
+  void* m = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) {
+    return NULL;
+  }
+
+  HullRingHeader* hdr = (HullRingHeader*) m;
+  hdr->nslots = nslots;
+  hdr->capacity = capacity;
+  hdr->slot_bytes = (hull_ring_size(1, capacity) - HEADER_BYTES);
+  hdr->head = hdr->tail = hdr->served = 0;
+  hdr->shutdown = 0;
+  for (uint32_t i = 0; i < nslots; i++) {
+    HullSlot* s = hull_ring_slot(hdr, i);
+    s->word = hull_ring_word(i, SLOT_FREE);
+    s->waiters = 0;
+  }
+  //publish last, so that clients never see a half-built ring
+  STORE(&hdr->magic, (uint32_t) HULL_RING_MAGIC);
+  return hdr;
+}
+
+HullRingHeader* hull_ring_attach(const char* name) {
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t) st.st_size < HEADER_BYTES) {
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  void* m = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) {
+    return NULL;
+  }
+  HullRingHeader* hdr = (HullRingHeader*) m;
+  if (LOAD(&hdr->magic) != HULL_RING_MAGIC
+      || hull_ring_size(hdr->nslots, hdr->capacity) != (size_t) st.st_size) {
+    munmap(m, st.st_size);
+    errno = EINVAL;
+    return NULL;
+  }
+  return hdr;
+}
+
+void hull_ring_detach(HullRingHeader* hdr) {
+  munmap(hdr, hull_ring_size(hdr->nslots, hdr->capacity));
+}
+
+void hull_ring_unlink(const char* name) {
+  shm_unlink(name);
+}
+
+
+/* **************************************** */
+/* wait a little while slot->word is v: spin the first 200 times,
+   then sleep until woken, timing out now and then to notice shutdown
+   and dead clients */
+static void wait_while(HullSlot* slot, uint32_t v, int& spin) {
+  if (spin < 200) {
+    spin++;
+    cpu_relax();
+    return;
+  }
+  struct timespec ts = {0, 100000000};
+  __atomic_add_fetch(&slot->waiters, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&slot->word, __ATOMIC_SEQ_CST) == v) {
+    syscall(SYS_futex, &slot->word, FUTEX_WAIT, v, &ts, NULL, 0);
+  }
+  __atomic_sub_fetch(&slot->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+static void wake(HullSlot* slot) {
+  if (__atomic_load_n(&slot->waiters, __ATOMIC_SEQ_CST) > 0) {
+    syscall(SYS_futex, &slot->word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+  }
+}
+
+int hull_ring_wait(HullRingHeader* hdr, HullSlot* slot, uint32_t target) {
+  for (int spin = 0; ; ) {
+    uint32_t v = LOAD(&slot->word);
+    if (v == target) {
+      return 0;
+    }
+    if (LOAD(&hdr->shutdown)) {
+      return -1;
+    }
+    wait_while(slot, v, spin);
+  }
+}
+
+void hull_ring_post(HullSlot* slot, uint32_t value) {
+  __atomic_store_n(&slot->word, value, __ATOMIC_SEQ_CST);
+  wake(slot);
+}
+
+/* move the word of slot from v to value, if nobody else moved it */
+static int swap_word(HullSlot* slot, uint32_t v, uint32_t value) {
+  if (!__atomic_compare_exchange_n(&slot->word, &v, value, false,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    return 0;
+  }
+  wake(slot);
+  return 1;
+}
+
+static inline uint64_t owner_of(uint64_t ticket) {
+  return ((ticket & 0xffffffff) << 32) | (uint32_t) getpid();
+}
+
+/* the process that holds the slot for ticket t has exited */
+static int owner_gone(HullSlot* slot, uint64_t t) {
+  uint64_t o = LOAD(&slot->owner);
+  if ((o >> 32) != (t & 0xffffffff)) {
+    return 0;  //not recorded yet
+  }
+  return kill((pid_t) (uint32_t) o, 0) < 0 && errno == ESRCH;
+}
+
+static uint64_t now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int hull_ring_serve_wait(HullRingHeader* hdr, uint64_t t) {
+  HullSlot* s = hull_ring_slot(hdr, t);
+  uint32_t next = hull_ring_word(t + hdr->nslots, SLOT_FREE);
+  uint64_t free_since = 0;
+  for (int spin = 0; ; ) {
+    uint32_t v = LOAD(&s->word);
+    if (v == hull_ring_word(t, SLOT_SUBMITTED)) {
+      return 0;
+    }
+    if (LOAD(&hdr->shutdown)) {
+      return -1;
+    }
+    if (spin >= 200) {
+      //the client of the previous round died before giving the slot
+      //back, ours died after claiming it, or ours never came for it
+      if (t >= hdr->nslots
+          && v == hull_ring_word(t - hdr->nslots, SLOT_DONE)
+          && owner_gone(s, t - hdr->nslots)) {
+        swap_word(s, v, hull_ring_word(t, SLOT_FREE));
+        continue;
+      }
+      if (v == hull_ring_word(t, SLOT_CLAIMED) && owner_gone(s, t)
+          && swap_word(s, v, next)) {
+        return 1;
+      }
+      if (v == hull_ring_word(t, SLOT_FREE) && LOAD(&hdr->head) > t) {
+        if (free_since == 0) {
+          free_since = now_ms();
+        } else if (now_ms() - free_since > HULL_RING_CLAIM_MS
+                   && swap_word(s, v, next)) {
+          return 1;
+        }
+      }
+    }
+    wait_while(s, v, spin);
+  }
+}
+
+
+/* **************************************** */
+point2D* hull_request_begin(HullRingHeader* hdr, HullRequest* r) {
+  r->ticket = __atomic_fetch_add(&hdr->head, 1, __ATOMIC_SEQ_CST);
+  r->slot = hull_ring_slot(hdr, r->ticket);
+  uint32_t mine = hull_ring_word(r->ticket, SLOT_FREE);
+  for (int spin = 0; ; ) {
+    uint32_t v = LOAD(&r->slot->word);
+    if (v == mine) {
+      //record who holds the slot before claiming it, so that the
+      //service never sees it claimed by an unknown process
+      STORE(&r->slot->owner, owner_of(r->ticket));
+      if (swap_word(r->slot, v, hull_ring_word(r->ticket, SLOT_CLAIMED))) {
+        return r->slot->points;
+      }
+      continue;
+    }
+    //the slot went past our ticket: the service gave it away
+    uint32_t ahead = ((v >> 2) - (mine >> 2)) & 0x3fffffff;
+    if (ahead != 0 && ahead < (1 << 29)) {
+      errno = ETIMEDOUT;
+      return NULL;
+    }
+    if (LOAD(&hdr->shutdown)) {
+      errno = ECONNRESET;
+      return NULL;
+    }
+    wait_while(r->slot, v, spin);
+  }
+}
+
+void hull_request_submit(HullRingHeader* hdr, HullRequest* r,
+                         uint32_t npoints) {
+  r->slot->npoints = npoints;
+  hull_ring_post(r->slot, hull_ring_word(r->ticket, SLOT_SUBMITTED));
+}
+
+const point2D* hull_request_wait(HullRingHeader* hdr, HullRequest* r,
+                                 uint32_t* nhull) {
+  if (hull_ring_wait(hdr, r->slot, hull_ring_word(r->ticket, SLOT_DONE)) < 0) {
+    return NULL;
+  }
+  *nhull = r->slot->nhull;
+  return r->slot->points;
+}
+
+void hull_request_end(HullRingHeader* hdr, HullRequest* r) {
+  hull_ring_post(r->slot, hull_ring_word(r->ticket + hdr->nslots, SLOT_FREE));
+}
+
+int hull_request(HullRingHeader* hdr, const vector<point2D>& p,
+                 vector<point2D>& hull) {
+  if (p.size() > hdr->capacity) {
+    errno = E2BIG;
+    return -1;
+  }
+  HullRequest r;
+  point2D* buf = hull_request_begin(hdr, &r);
+  if (buf == NULL) {
+    return -1;
+  }
+  if (p.size() > 0) {
+    memcpy(buf, &p[0], p.size() * sizeof(point2D));
+  }
+  hull_request_submit(hdr, &r, p.size());
+  uint32_t nhull;
+  const point2D* h = hull_request_wait(hdr, &r, &nhull);
+  if (h == NULL) {
+    errno = ECONNRESET;
+    return -1;
+  }
+  hull.assign(h, h + nhull);
+  hull_request_end(hdr, &r);
+  return 0;
+}
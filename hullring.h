@@ -0,0 +1,132 @@
+#ifndef __hullring_h
+#define __hullring_h
+
+#include "geom.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/* Shared-memory request ring between hulld and its clients.
+
+   The ring is a POSIX shared memory object holding a header and
+   nslots slots. Each slot has room for capacity points. A client
+   writes its points straight into a slot; the service sorts them in
+   place, computes the hull with a preallocated per-thread
+   workspace, and writes the hull back into the same slot, where the
+   client reads it. No point data goes through a socket or a copy of
+   the request.
+
+   Requests are numbered by tickets. Ticket k uses slot k % nslots,
+   and the slot's futex word is (k << 2) | phase, where the phase goes
+   FREE -> CLAIMED -> SUBMITTED (client) -> DONE (service) -> FREE for
+   ticket k + nslots (client). Clients and service threads take
+   tickets in order from the head and tail counters, so the ring is
+   fair and needs no locks. Waiting spins briefly, then sleeps on the
+   futex.
+
+   A client that dies holding a ticket must not stall the ring. The
+   client records its pid in the slot when it claims it, and the
+   service thread waiting on the ticket gives the slot to the next
+   round when that process is gone, or when nobody claims the free
+   slot within HULL_RING_CLAIM_MS. A client whose ticket was given
+   away that way gets an error.
+*/
+
+#define HULL_RING_MAGIC 0x474e4952 //"RING"
+#define HULL_RING_DEFAULT_NAME "/hulld"
+#define HULL_RING_CLAIM_MS 2000
+
+enum {
+  SLOT_FREE = 0,
+  SLOT_SUBMITTED = 1,
+  SLOT_DONE = 2,
+  SLOT_CLAIMED = 3
+};
+
+typedef struct _hull_ring_header {
+  uint32_t magic;
+  uint32_t nslots;
+  uint32_t capacity;   //max points per request
+  uint32_t shutdown;   //set by the service when it exits
+  uint64_t slot_bytes;
+  uint64_t head;       //next client ticket
+  uint64_t tail;       //next service ticket
+  uint64_t served;     //requests completed
+} HullRingHeader;
+
+typedef struct _hull_slot {
+  uint32_t word;       //(ticket << 2) | phase; futex
+  uint32_t waiters;    //threads sleeping on word
+  uint32_t npoints;    //request size, set by the client
+  uint32_t nhull;      //hull size, set by the service
+  uint64_t service_ns; //time the service spent on the request
+  uint64_t owner;      //(ticket << 32) | pid of the client
+  uint64_t pad[4];
+  point2D points[1];   //capacity+1 points: request in, hull out
+} HullSlot;
+
+/* bytes needed for a ring */
+size_t hull_ring_size(uint32_t nslots, uint32_t capacity);
+
+/* slot i of a ring */
+HullSlot* hull_ring_slot(HullRingHeader* hdr, uint64_t i);
+
+/* create (service side) or attach to (client side) the ring with
+   shared memory name name; return NULL on error, with errno set */
+HullRingHeader* hull_ring_create(const char* name, uint32_t nslots,
+                                 uint32_t capacity);
+HullRingHeader* hull_ring_attach(const char* name);
+
+/* unmap a ring; the service also unlinks its name */
+void hull_ring_detach(HullRingHeader* hdr);
+void hull_ring_unlink(const char* name);
+
+/* wait until *word == target. Return 0, or -1 if the service shut
+   down while waiting */
+int hull_ring_wait(HullRingHeader* hdr, HullSlot* slot, uint32_t target);
+
+/* set *word = value and wake the threads waiting on it */
+void hull_ring_post(HullSlot* slot, uint32_t value);
+
+/* service side: wait until ticket t is submitted. Return 0, 1 if its
+   client is gone and the slot went to the next round, or -1 if the
+   service shut down */
+int hull_ring_serve_wait(HullRingHeader* hdr, uint64_t t);
+
+static inline uint32_t hull_ring_word(uint64_t ticket, uint32_t phase) {
+  return (uint32_t) (ticket << 2) | phase;
+}
+
+
+/* **************************************** */
+/* client library */
+
+typedef struct _hull_request {
+  HullSlot* slot;
+  uint64_t ticket;
+} HullRequest;
+
+/* take the next ticket and wait for its slot; return the buffer to
+   write up to capacity points into, or NULL if the service is gone
+   (errno ECONNRESET) or gave the ticket away (ETIMEDOUT) */
+point2D* hull_request_begin(HullRingHeader* hdr, HullRequest* r);
+
+/* hand the first npoints points of the buffer to the service */
+void hull_request_submit(HullRingHeader* hdr, HullRequest* r,
+                         uint32_t npoints);
+
+/* wait for the hull. Return a pointer to it inside the slot (same
+   form as monotone_chain) and set *nhull to its size; NULL if the
+   service is gone. The pointer is valid until hull_request_end. */
+const point2D* hull_request_wait(HullRingHeader* hdr, HullRequest* r,
+                                 uint32_t* nhull);
+
+/* give the slot back */
+void hull_request_end(HullRingHeader* hdr, HullRequest* r);
+
+/* all of the above: compute the hull of p through the service.
+   Return 0, or -1 if p does not fit in a slot or the service is
+   gone */
+int hull_request(HullRingHeader* hdr, const vector<point2D>& p,
+                 vector<point2D>& hull);
+
+#endif
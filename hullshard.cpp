@@ -0,0 +1,396 @@
+/* hullshard.cpp
+
+   Sharded hull over several processes. A coordinator partitions a
+   point file into ranges, hands one range to each worker process,
+   and merges the partial hulls the workers send back (hullmerge.h).
+
+   Coordinator and workers talk through framed messages (pointio.h)
+   over a Unix domain socket (addr is a path) or TCP (addr is
+   host:port), so the workers can run on other machines:
+
+     hullshard gen <file> <generator> <n> [seed]
+         write a point file
+     hullshard run <file> <workers> [addr]
+         fork <workers> local workers; they read their range of the
+         file directly
+     hullshard serve <file> <workers> <addr>
+         wait for <workers> workers started elsewhere with
+         'hullshard worker <addr>'; their points are sent over the
+         socket, so they do not need access to the file
+     hullshard worker <addr>
+         connect to a coordinator, compute one partial hull, exit
+     hullshard scale <file> <maxworkers> [addr]
+         run with 1, 2, 4, ... maxworkers local workers and report
+         the speedup and efficiency of each worker count
+
+   Over TCP the coordinator gives up on a worker that sends or takes
+   nothing for $HULLSHARD_TIMEOUT seconds (default 300), instead of
+   waiting forever for a hung machine.
+*/
+
+#include "geom.h"
+#include "generators.h"
+#include "hullmerge.h"
+#include "pointio.h"
+#include "rtimer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <netdb.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <vector>
+using namespace std;
+
+/* message types */
+enum {
+  MSG_JOB_RANGE = 1,  //payload: uint64 offset, uint64 count, file path
+  MSG_JOB_POINTS = 2, //payload: the points
+  MSG_HULL = 3,       //payload: the partial hull
+  MSG_ERROR = 4,      //payload: why the worker could not do its job
+};
+
+#define die(msg) { perror(msg); exit(1); }
+
+/* seconds a TCP worker may stay silent, see above */
+static int worker_timeout() {
+  const char* env = getenv("HULLSHARD_TIMEOUT");
+  return (env && atoi(env) > 0) ? atoi(env) : 300;
+}
+
+
+/* ****************************** */
+/* sockets: addr is host:port for TCP, anything else is the path of a
+   Unix domain socket */
+
+static int is_tcp(const char* addr) {
+  return addr[0] != '/' && strchr(addr, ':') != NULL;
+}
+
+static struct addrinfo* tcp_addr(const char* addr, int passive) {
+  char host[256];
+  const char* colon = strrchr(addr, ':');
+  size_t len = colon - addr;
+  assert(len < sizeof(host));
+  memcpy(host, addr, len);
+  host[len] = '\0';
+
+  struct addrinfo hints, *res;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = passive ? AI_PASSIVE : 0;
+  int r = getaddrinfo(len ? host : NULL, colon + 1, &hints, &res);
+  if (r != 0) {
+    fprintf(stderr, "%s: %s\n", addr, gai_strerror(r));
+    exit(1);
+  }
+  return res;
+}
+
+static int listen_on(const char* addr, int backlog) {
+  int fd;
+  if (is_tcp(addr)) {
+    struct addrinfo* ai = tcp_addr(addr, 1);
+    fd = socket(ai->ai_family, SOCK_STREAM, 0);
+    if (fd < 0) die(addr);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen) < 0) die(addr);
+    freeaddrinfo(ai);
+  } else {
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    assert(strlen(addr) < sizeof(sa.sun_path));
+    strcpy(sa.sun_path, addr);
+    unlink(addr);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr*) &sa, sizeof(sa)) < 0) die(addr);
+  }
+  if (listen(fd, backlog) < 0) die("listen");
+  return fd;
+}
+
+/* connect to addr, retrying for a few seconds while the coordinator
+   starts up */
+static int connect_to(const char* addr) {
+  for (int attempt = 0; attempt < 100; attempt++) {
+    int fd;
+    int r;
+    if (is_tcp(addr)) {
+      struct addrinfo* ai = tcp_addr(addr, 0);
+      fd = socket(ai->ai_family, SOCK_STREAM, 0);
+      r = connect(fd, ai->ai_addr, ai->ai_addrlen);
+      freeaddrinfo(ai);
+    } else {
+      struct sockaddr_un sa;
+      memset(&sa, 0, sizeof(sa));
+      sa.sun_family = AF_UNIX;
+      strcpy(sa.sun_path, addr);
+      fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      r = connect(fd, (struct sockaddr*) &sa, sizeof(sa));
+    }
+    if (r == 0) {
+      return fd;
+    }
+    close(fd);
+    usleep(50000);
+  }
+  die(addr);
+}
+
+
+/* ****************************** */
+/* worker: tell the coordinator why the job failed, and exit */
+static void reject(int fd, const char* why) {
+  fprintf(stderr, "worker: %s\n", why);
+  send_msg(fd, MSG_ERROR, why, strlen(why));
+  exit(1);
+}
+
+/* worker: receive one job, send back its partial hull */
+static int worker(const char* addr) {
+  int fd = connect_to(addr);
+  uint32_t type;
+  vector<char> payload;
+  if (recv_msg(fd, &type, payload) < 0) die("worker: recv");
+
+  vector<point2D> p;
+  if (type == MSG_JOB_RANGE) {
+    uint64_t range[2];
+    if (payload.size() <= sizeof(range)) {
+      reject(fd, "range job without a file name");
+    }
+    memcpy(range, &payload[0], sizeof(range));
+    range[0] = le64(range[0]);
+    range[1] = le64(range[1]);
+    string path(&payload[sizeof(range)], payload.size() - sizeof(range));
+    if (read_point_file(path.c_str(), range[0], range[1], p) < 0) {
+      reject(fd, strerror(errno));
+    }
+  } else if (type == MSG_JOB_POINTS) {
+    if (payload_points(payload, 0, p) < 0) {
+      reject(fd, "points job with a partial point");
+    }
+  } else {
+    reject(fd, "unexpected message");
+  }
+
+  vector<point2D> hull = monotone_chain(p);
+  if (send_points(fd, MSG_HULL, hull) < 0) die("worker: send");
+  close(fd);
+  return 0;
+}
+
+
+/* ****************************** */
+/* coordinator: partition the file over nworkers workers and merge
+   their hulls. If spawn, fork the workers locally and let them read
+   the file; otherwise wait for remote workers and send them their
+   points. Returns the wall time in microseconds from handing out the
+   jobs to having the merged hull. */
+static double coordinate(const char* path, int nworkers, const char* addr,
+                         int spawn, vector<point2D>& hull) {
+  long n = point_file_count(path);
+  if (n < 0) die(path);
+
+  int lfd = listen_on(addr, nworkers);
+  vector<pid_t> children;
+  if (spawn) {
+    for (int w = 0; w < nworkers; w++) {
+      pid_t pid = fork();
+      if (pid < 0) die("fork");
+      if (pid == 0) {
+        close(lfd);
+        _exit(worker(addr));
+      }
+      children.push_back(pid);
+    }
+  }
+  vector<int> conns;
+  struct timeval tv = {worker_timeout(), 0};
+  for (int w = 0; w < nworkers; w++) {
+    int fd = accept(lfd, NULL, NULL);
+    if (fd < 0) die("accept");
+    if (is_tcp(addr) && (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0
+                         || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0)) {
+      die("setsockopt");
+    }
+    conns.push_back(fd);
+  }
+  close(lfd);
+  if (!is_tcp(addr)) {
+    unlink(addr);
+  }
+
+  Rtimer rt;
+  rt_start(rt);
+  for (int w = 0; w < nworkers; w++) {
+    long begin = n * w / nworkers, end = n * (w + 1) / nworkers;
+    if (spawn) {
+      vector<char> job(2 * sizeof(uint64_t));
+      uint64_t range[2] = {le64(begin), le64(end - begin)};
+      memcpy(&job[0], range, sizeof(range));
+      job.insert(job.end(), path, path + strlen(path));
+      if (send_msg(conns[w], MSG_JOB_RANGE, &job[0], job.size()) < 0) {
+        die("send job");
+      }
+    } else {
+      vector<point2D> p;
+      if (read_point_file(path, begin, end - begin, p) < 0) die(path);
+      if (send_points(conns[w], MSG_JOB_POINTS, p) < 0) die("send job");
+    }
+  }
+
+  vector<vector<point2D> > partial(nworkers);
+  for (int w = 0; w < nworkers; w++) {
+    uint32_t type;
+    vector<char> payload;
+    if (recv_msg(conns[w], &type, payload) < 0) {
+      fprintf(stderr, "worker %d: ", w);
+      die("receive hull");
+    }
+    if (type == MSG_ERROR) {
+      fprintf(stderr, "worker %d: %.*s\n", w, (int) payload.size(),
+              payload.size() ? &payload[0] : "");
+      exit(1);
+    }
+    if (type != MSG_HULL || payload_points(payload, 0, partial[w]) < 0) {
+      errno = EPROTO;
+      die("receive hull");
+    }
+    close(conns[w]);
+  }
+  hull = hull_merge_all(&partial[0], nworkers, 1);
+  rt_stop(rt);
+
+  for (size_t w = 0; w < children.size(); w++) {
+    int status;
+    waitpid(children[w], &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      fprintf(stderr, "worker %d failed\n", (int) w);
+      exit(1);
+    }
+  }
+  return rt_w_useconds(rt);
+}
+
+/* time a single-process hull of the whole file, read included */
+static double single_process(const char* path, vector<point2D>& hull) {
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> p;
+  if (read_point_file(path, 0, -1, p) < 0) die(path);
+  hull = monotone_chain(p);
+  rt_stop(rt);
+  return rt_w_useconds(rt);
+}
+
+static int same_points(const vector<point2D>& a, const vector<point2D>& b) {
+  if (a.size() != b.size()) return 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y) return 0;
+  }
+  return 1;
+}
+
+static void default_addr(char* buf, size_t len) {
+  snprintf(buf, len, "/tmp/hullshard.%d.sock", (int) getpid());
+}
+
+
+/* ****************************** */
+static void usage() {
+  printf("usage:\n");
+  printf("  hullshard gen <file> <generator> <n> [seed]\n");
+  printf("  hullshard run <file> <workers> [addr]\n");
+  printf("  hullshard serve <file> <workers> <addr>\n");
+  printf("  hullshard worker <addr>\n");
+  printf("  hullshard scale <file> <maxworkers> [addr]\n");
+  printf("addr is the path of a Unix domain socket, or host:port\n");
+}
+
+int main(int argc, char** argv) {
+  signal(SIGPIPE, SIG_IGN);
+  if (argc < 3) {
+    usage();
+    exit(1);
+  }
+  const char* cmd = argv[1];
+  char addr[256];
+  default_addr(addr, sizeof(addr));
+
+  if (strcmp(cmd, "gen") == 0 && argc >= 5) {
+    int gen = generator_by_name(argv[3]);
+    if (gen < 0) {
+      printf("unknown generator %s\n", argv[3]);
+      exit(1);
+    }
+    uint64_t seed = (argc > 5) ? strtoull(argv[5], NULL, 10) : 1;
+    vector<point2D> p;
+    generate_points(gen, atol(argv[4]), seed, p);
+    if (write_point_file(argv[2], p) < 0) die(argv[2]);
+    printf("wrote %ld points to %s\n", (long) p.size(), argv[2]);
+    return 0;
+  }
+
+  if (strcmp(cmd, "worker") == 0) {
+    return worker(argv[2]);
+  }
+
+  if ((strcmp(cmd, "run") == 0 || strcmp(cmd, "serve") == 0) && argc >= 4) {
+    int spawn = (strcmp(cmd, "run") == 0);
+    if (argc > 4) {
+      snprintf(addr, sizeof(addr), "%s", argv[4]);
+    } else if (!spawn) {
+      usage();
+      exit(1);
+    }
+    int nworkers = atoi(argv[3]);
+    assert(nworkers > 0);
+    vector<point2D> hull;
+    double us = coordinate(argv[2], nworkers, addr, spawn, hull);
+    printf("%s: %d workers, h=%d, %.0f us\n", argv[2], nworkers,
+           (int) hull.size() - 1, us);
+    return 0;
+  }
+
+  if (strcmp(cmd, "scale") == 0 && argc >= 4) {
+    if (argc > 4) {
+      snprintf(addr, sizeof(addr), "%s", argv[4]);
+    }
+    int maxworkers = atoi(argv[3]);
+    assert(maxworkers > 0);
+    vector<point2D> ref, hull;
+    double t0 = single_process(argv[2], ref);
+    printf("%s: %ld points, h=%d\n", argv[2], point_file_count(argv[2]),
+           (int) ref.size() - 1);
+    printf("  single process %10.0f us\n", t0);
+
+    double t1 = 0;
+    int fail = 0;
+    for (int w = 1; w <= maxworkers; w *= 2) {
+      double t = coordinate(argv[2], w, addr, 1, hull);
+      if (w == 1) {
+        t1 = t;
+      }
+      int ok = same_points(hull, ref);
+      fail |= !ok;
+      printf("  %3d workers %10.0f us  speedup %5.2f  efficiency %5.1f%%  %s\n",
+             w, t, t1 / t, 100.0 * t1 / (w * t), ok ? "ok" : "MISMATCH");
+    }
+    return fail;
+  }
+
+  usage();
+  return 1;
+}
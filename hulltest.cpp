@@ -0,0 +1,1533 @@
+/* hulltest.cpp
+
+   Differential correctness and performance regression suite for the
+   hull engines. Does not need GLUT.
+
+   usage: hulltest [-q] [-t threshold] [-b baseline] [-u]
+
+   Correctness: every engine (those of hull.h, hull_merge_all,
+   warm_hull, the accumulator of hullacc.h, melkman_hull,
+   pipeline_hull from a point file and from the generator, and
+   packed_hull when the points fit) is run on all
+   generators at several
+   sizes, including the README's star at n=100000 and butterfly at
+   n=1000000, and on random degenerate sets (repeated points,
+   collinear points, tiny n, coordinates close to 2^30). Every hull
+   must be identical to a gift-wrapping reference, which shares no
+   code with the engines except the orientation test; the
+   approximate engine must stay within its error bound, and every
+   step of the anytime engine must be inside the reference and the
+   last one identical to it. The range hull index (rangehull.h) is
+   queried on the whole set and on a few windows of each set.
+
+   The metrics of calipers.h (diameter, width, minimum-area and
+   minimum-perimeter rectangles) are compared with O(h^2) brute force
+   on the hulls of the generators and of points, segments and small
+   degenerate sets.
+
+   The queries of hullquery.h (containment, extreme vertex, tangents,
+   and their batch versions) are compared with linear scans of the
+   vertices, on hulls of 1, 2 and more vertices, for points on the
+   vertices and edges and directions along the edges.
+
+   The hull cache (hullcache.h) is checked separately: hits return
+   the stored hull, eviction keeps the most recently used hulls, and
+   the disk tier survives reopening. The viewer's quadtree
+   (quadtree.h) is checked on random views: the cells it draws hold
+   every visible point exactly once.
+
+   The adaptive orientation test of predicates.h is compared with
+   128-bit integer arithmetic on random and nearly collinear triples
+   of doubles, and the double hull (doublehull.h) is checked to be
+   convex and to contain nearly collinear sets.
+
+   Convex layers (layers.h) are compared with peeling the reference
+   hull again and again, on random sets with many collinear and
+   repeated points.
+
+   Hull deltas (hulldelta.h) are followed along random sequences of
+   changing point sets: each delta is encoded, decoded and applied
+   to the previous hull, closed and not closed, and must give the new
+   one; every truncated encoding must be rejected.
+
+   The pairwise operations of convex.h are checked on random pairs of
+   hulls, including points, segments and coordinates close to 2^30,
+   against brute force: all pairs of edges for the overlap test,
+   clipping one hull by every edge line of the other for the area of
+   the intersection, and the hull of all sums of vertices for the
+   Minkowski sum.
+
+   Performance: each timed case is run seven times and the median
+   time compared with the baseline file (default hulltest.baseline).
+   A case slower than the baseline by more than threshold percent
+   (default 25, or $HULL_PERF_THRESHOLD) fails; cases whose baseline
+   is under 1 ms are only reported. Missing entries are
+   added to the file; -u rewrites it with the current timings. -q
+   skips the performance part.
+
+   Exits with 1 if anything failed.
+*/
+
+#include "geom.h"
+#include "anytime.h"
+#include "approxhull.h"
+#include "calipers.h"
+#include "convex.h"
+#include "doublehull.h"
+#include "generators.h"
+#include "hull.h"
+#include "hullacc.h"
+#include "hullcache.h"
+#include "hulldelta.h"
+#include "hullmerge.h"
+#include "hullquery.h"
+#include "layers.h"
+#include "melkman.h"
+#include "packed.h"
+#include "pipeline.h"
+#include "pointio.h"
+#include "predicates.h"
+#include "quadtree.h"
+#include "rangehull.h"
+#include "warmhull.h"
+#include "rtimer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+static int failures = 0;
+
+
+/* ****************************** */
+/* the reference: gift wrapping, O(nh). Same form as monotone_chain */
+static vector<point2D> reference_hull(const vector<point2D>& p) {
+  vector<point2D> h;
+  if (p.size() == 0) {
+    return h;
+  }
+  long start = 0;
+  for (size_t i = 1; i < p.size(); i++) {
+    if (p[i].y < p[start].y || (p[i].y == p[start].y && p[i].x < p[start].x)) {
+      start = i;
+    }
+  }
+  point2D cur = p[start];
+  do {
+    h.push_back(cur);
+    //the next vertex has every point on or left of cur->next, and is
+    //the farthest such point
+    point2D next = cur;
+    for (size_t i = 0; i < p.size(); i++) {
+      point2D r = p[i];
+      if (next.x == cur.x && next.y == cur.y) {
+        next = r;
+        continue;
+      }
+      long long o = orient2D(cur, next, r);
+      if (o < 0 || (o == 0 && llabs((long long) r.x - cur.x) + llabs((long long) r.y - cur.y)
+                    > llabs((long long) next.x - cur.x) + llabs((long long) next.y - cur.y))) {
+        next = r;
+      }
+    }
+    cur = next;
+  } while (cur.x != h[0].x || cur.y != h[0].y);
+  h.push_back(h[0]);
+  return h;
+}
+
+static int same_points(const vector<point2D>& a, const vector<point2D>& b) {
+  if (a.size() != b.size()) {
+    return 0;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* return 1 if every vertex of a is inside the hull h (in the form of
+   reference_hull) or on its boundary */
+static int inside_hull(const vector<point2D>& a, const vector<point2D>& h) {
+  for (size_t i = 0; i < a.size(); i++) {
+    point2D v = a[i];
+    if (h.size() <= 3) {
+      //a point or a segment
+      if (h.size() == 0 || orient2D(h[0], h[1], v) != 0
+          || v.x < min(h[0].x, h[1].x) || v.x > max(h[0].x, h[1].x)
+          || v.y < min(h[0].y, h[1].y) || v.y > max(h[0].y, h[1].y)) {
+        return 0;
+      }
+      continue;
+    }
+    for (size_t j = 0; j + 1 < h.size(); j++) {
+      if (orient2D(h[j], h[j+1], v) < 0) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+/* sort p ccw around the centroid of a sample of it, like
+   presorted_order expects; the points on the same ray from it are
+   shuffled */
+static void angular_sort(vector<point2D>& p) {
+  long n = p.size();
+  if (n == 0) {
+    return;
+  }
+  long m = min(n, 256L);
+  long long sx = 0, sy = 0;
+  for (long i = 0; i < m; i++) {
+    sx += p[i * n / m].x;
+    sy += p[i * n / m].y;
+  }
+  long long cx = sx / m, cy = sy / m;
+  sort(p.begin(), p.end(), [&](point2D a, point2D b) {
+      long long ax = a.x - cx, ay = a.y - cy, bx = b.x - cx, by = b.y - cy;
+      int ha = ay > 0 || (ay == 0 && ax > 0);
+      int hb = by > 0 || (by == 0 && bx > 0);
+      if (ha != hb) {
+        return ha > hb;
+      }
+      long long o = ax * by - ay * bx;
+      if (o != 0) {
+        return o > 0;
+      }
+      return rng_u64(3, (uint64_t) a.x << 32 | (uint32_t) a.y, 0)
+        < rng_u64(3, (uint64_t) b.x << 32 | (uint32_t) b.y, 0);
+    });
+}
+
+static void report(const char* engine, const char* set, long n, int ok) {
+  if (!ok) {
+    printf("FAIL %-10s %s n=%ld\n", engine, set, n);
+    failures++;
+  }
+}
+
+
+static const int BIG = (1 << 30) - 1;
+
+
+/* ****************************** */
+/* run every engine on p and compare with the reference. gen, if not
+   NULL, is a source of the same points for the pipeline */
+static int check_set(const char* set, const vector<point2D>& p,
+                     const PointSource* gen = NULL) {
+  long n = p.size();
+  vector<point2D> ref = reference_hull(p);
+  int before = failures;
+
+  HullOptions opt;
+  hull_default_options(&opt);
+  for (int e = 0; e < NB_HULL_ENGINES; e++) {
+    opt.engine = e;
+    if (e == HULL_APPROX) {
+      double bound;
+      vector<point2D> a = approx_hull(p, 0, opt.strips, &bound);
+      report(hull_engine_name(e), set, n,
+             approx_hull_error(p, a) <= bound * (1 + 1e-9));
+      //an epsilon is a promise, however many strips it takes
+      for (double eps = 1; eps <= 1e6; eps *= 1000) {
+        a = approx_hull(p, eps, 0, &bound);
+        report(hull_engine_name(e), set, n, bound <= eps
+               && approx_hull_error(p, a) <= bound * (1 + 1e-9));
+      }
+    } else if (e == HULL_ANYTIME) {
+      report(hull_engine_name(e), set, n, inside_hull(compute_hull(p, opt), ref));
+      AnytimeHull a;
+      anytime_hull_init(a);
+      anytime_hull_start(a, p);
+      while (anytime_hull_step(a)) {
+        report(hull_engine_name(e), set, n, inside_hull(a.hull, ref));
+      }
+      report(hull_engine_name(e), set, n, a.exact && same_points(a.hull, ref));
+    } else {
+      report(hull_engine_name(e), set, n, same_points(compute_hull(p, opt), ref));
+    }
+  }
+
+  //packed storage, when the points fit
+  PackedPoints pp;
+  if (pack_points(n ? &p[0] : NULL, n, pp) == 0) {
+    report("packed", set, n, same_points(packed_hull(pp), ref));
+  }
+
+  //merge of the hulls of 7 shards
+  vector<vector<point2D> > hulls(7);
+  for (long i = 0; i < 7; i++) {
+    vector<point2D> part(p.begin() + n * i / 7, p.begin() + n * (i + 1) / 7);
+    hulls[i] = monotone_chain(part);
+  }
+  report("merge", set, n, same_points(hull_merge_all(&hulls[0], 7, 1), ref));
+
+  //accumulator: three producers taking turns with batches of 5,
+  //publishing every 16 points
+  HullAccumulator* acc = hull_acc_create(3, 16);
+  for (int s = 0; s < 3; s++) {
+    hull_acc_register(acc);
+  }
+  for (long i = 0; i < n; i += 5) {
+    hull_acc_add(acc, (i / 5) % 3, &p[i], min(n - i, 5L));
+  }
+  for (int s = 0; s < 3; s++) {
+    hull_acc_flush(acc, s);
+  }
+  report("acc", set, n, same_points(hull_acc_hull(acc, 0), ref));
+  hull_acc_destroy(acc);
+
+  //presorted input: the points in xy order, backwards, and around
+  //their centroid, with the points on a ray from it in random order
+  vector<point2D> s(p);
+  sort(s.begin(), s.end(), xy_less);
+  int order;
+  report("auto", set, n, same_points(auto_hull(s, &order), ref)
+         && (n == 0 || order == ORDER_XY));
+  reverse(s.begin(), s.end());
+  report("auto", set, n, same_points(auto_hull(s, &order), ref)
+         && order != ORDER_NONE);
+  angular_sort(s);
+  if (presorted_order(s) == ORDER_ANGULAR) {
+    report("melkman", set, n, same_points(melkman_hull(s), ref));
+  }
+
+  //warm start: a cold frame, then the points moved by one
+  WarmHull w;
+  warm_hull_reset(w);
+  report("warm", set, n, same_points(warm_hull(w, p), ref));
+  vector<point2D> moved(p);
+  for (long i = 0; i < n; i++) {
+    uint64_t r = rng_u64(7, i, 0);
+    int dx = (int) (r % 3) - 1, dy = (int) ((r >> 32) % 3) - 1;
+    if (llabs((long long) moved[i].x + dx) < (1 << 30)) moved[i].x += dx;
+    if (llabs((long long) moved[i].y + dy) < (1 << 30)) moved[i].y += dy;
+  }
+  report("warm", set, n, same_points(warm_hull(w, moved),
+                                     reference_hull(moved)));
+
+  //pipeline: small blocks, so that sets of a few hundred points take
+  //several, read from a point file and from the generator
+  PipelineOptions popt;
+  pipeline_default_options(&popt);
+  popt.block = 64;
+  popt.filters = 2;
+  char path[64];
+  sprintf(path, "/tmp/hulltest_%d.pts", (int) getpid());
+  PointSource src;
+  vector<point2D> h;
+  int ok = write_point_file(path, p) == 0 && file_source(&src, path) == 0;
+  if (ok) {
+    ok = pipeline_hull(&src, popt, h) == 0 && same_points(h, ref);
+    close_source(&src);
+  }
+  unlink(path);
+  report("pipeline", set, n, ok);
+  if (gen) {
+    report("pipeline", set, n, pipeline_hull(gen, popt, h) == 0
+           && same_points(h, ref));
+  }
+
+  //range hulls: the whole set, then windows spanned by pairs of
+  //points, with small leaves so that small sets have inner nodes
+  RangeHullIndex idx;
+  range_hull_build(idx, p, 4, 2);
+  report("range", set, n, same_points(range_hull(idx, -BIG, -BIG, BIG, BIG),
+                                      ref));
+  for (int q = 0; n > 0 && q < 4; q++) {
+    point2D a = p[rng_u64(11, q, 0) % n], b = p[rng_u64(11, q, 1) % n];
+    int x0 = min(a.x, b.x), x1 = max(a.x, b.x);
+    int y0 = min(a.y, b.y), y1 = max(a.y, b.y);
+    vector<point2D> in;
+    for (long i = 0; i < n; i++) {
+      if (p[i].x >= x0 && p[i].x <= x1 && p[i].y >= y0 && p[i].y <= y1) {
+        in.push_back(p[i]);
+      }
+    }
+    report("range", set, n, same_points(range_hull(idx, x0, y0, x1, y1),
+                                        reference_hull(in)));
+  }
+  return failures == before;
+}
+
+
+/* ****************************** */
+/* degenerate sets, drawn with rnd from the stream of rng_seed */
+static uint64_t rng_seed, rng_index;
+static long rnd(long m) {
+  return (long) (rng_u64(rng_seed, rng_index++, 1) % (uint64_t) m);
+}
+
+
+static void repeated_set(long n, vector<point2D>& p) {
+  //n copies of a few distinct points
+  long distinct = 1 + rnd(4);
+  vector<point2D> d(distinct);
+  for (long i = 0; i < distinct; i++) {
+    d[i].x = rnd(10);
+    d[i].y = rnd(10);
+  }
+  p.resize(n);
+  for (long i = 0; i < n; i++) {
+    p[i] = d[rnd(distinct)];
+  }
+}
+
+static void collinear_set(long n, int big, vector<point2D>& p) {
+  //points on a line through a with direction (dx, dy)
+  long range = big ? BIG / 2 : 100;
+  long steps = big ? 1000 : 50;
+  point2D a = {(int) (rnd(2 * range) - range), (int) (rnd(2 * range) - range)};
+  int dx = (int) rnd(5) - 2, dy = (int) rnd(5) - 2;
+  if (dx == 0 && dy == 0) {
+    dx = 1;
+  }
+  if (big) {
+    dx *= rnd(range / steps / 2) + 1;
+    dy *= rnd(range / steps / 2) + 1;
+  }
+  p.resize(n);
+  for (long i = 0; i < n; i++) {
+    long t = rnd(steps) - steps / 2;
+    p[i].x = a.x + t * dx;
+    p[i].y = a.y + t * dy;
+  }
+}
+
+static void random_set(long n, int range, vector<point2D>& p) {
+  p.resize(n);
+  for (long i = 0; i < n; i++) {
+    p[i].x = (int) (rnd(2L * range + 1) - range);
+    p[i].y = (int) (rnd(2L * range + 1) - range);
+  }
+}
+
+static void big_circle_set(long n, vector<point2D>& p) {
+  //points near a circle of radius close to 2^30, so that many are on
+  //the hull and orientations are large
+  p.resize(n);
+  for (long i = 0; i < n; i++) {
+    double a = rnd(1L << 30) * (2 * M_PI / (1L << 30));
+    p[i].x = (int) ((BIG - 2) * cos(a));
+    p[i].y = (int) ((BIG - 2) * sin(a));
+  }
+}
+
+static void check_degenerate() {
+  vector<point2D> p;
+  char name[64];
+  for (int s = 0; s < 2000; s++) {
+    rng_seed = 1000 + s;
+    long n = (s < 1000) ? rnd(7) : 1 + rnd(500);
+    switch (s % 6) {
+    case 0: repeated_set(n, p); strcpy(name, "repeated"); break;
+    case 1: collinear_set(n, 0, p); strcpy(name, "collinear"); break;
+    case 2: collinear_set(n, 1, p); strcpy(name, "collinear_big"); break;
+    case 3: random_set(n, 3, p); strcpy(name, "random_small"); break;
+    case 4: random_set(n, BIG, p); strcpy(name, "random_big"); break;
+    case 5: big_circle_set(n, p); strcpy(name, "circle_big"); break;
+    }
+    sprintf(name + strlen(name), "#%d", s);
+    check_set(name, p);
+  }
+  rng_seed = 99;
+  random_set(200000, BIG, p);
+  check_set("random_big", p);
+  big_circle_set(10000, p);
+  check_set("circle_big", p);
+}
+
+/* reads the points of a generator source, but fails on the block at
+   50000 */
+static int failing_read(const PointSource* src, long first, long count,
+                        point2D* out) {
+  if (first <= 50000 && 50000 < first + count) {
+    errno = EIO;
+    return -1;
+  }
+  generate_range(src->gen, src->n, src->seed, first, count, out, 1);
+  return 0;
+}
+
+static void check_generators() {
+  long sizes[] = {1, 2, 3, 5, 10, 100, 1000, 100000};
+  vector<point2D> p;
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+      for (uint64_t seed = 1; seed <= (sizes[k] <= 1000 ? 5u : 1u); seed++) {
+        generate_points(g, sizes[k], seed, p);
+        PointSource src;
+        generator_source(&src, g, sizes[k], seed);
+        check_set(generator_name(g), p, &src);
+      }
+    }
+  }
+  //the cases the README reports for graham_scan
+  generate_points(GEN_STAR, 100000, 1, p);
+  check_set("star", p);
+  generate_points(GEN_BUTTERFLY, 1000000, 1, p);
+  check_set("butterfly", p);
+
+  //a source that fails part way must fail the pipeline, not give the
+  //hull of the blocks read before
+  PointSource bad;
+  generator_source(&bad, GEN_RANDOM, 100000, 1);
+  bad.read = failing_read;
+  PipelineOptions popt;
+  pipeline_default_options(&popt);
+  popt.block = 1000;
+  vector<point2D> h(1);
+  errno = 0;
+  report("pipeline", "read error", bad.count,
+         pipeline_hull(&bad, popt, h) < 0 && errno == EIO && h.size() == 0);
+}
+
+
+/* ****************************** */
+/* pairwise operations on hulls (convex.h) */
+
+/* 1 if the closed segments ab and cd intersect */
+static int segments_meet(point2D a, point2D b, point2D c, point2D d) {
+  long long o1 = orient2D(a, b, c), o2 = orient2D(a, b, d);
+  long long o3 = orient2D(c, d, a), o4 = orient2D(c, d, b);
+  if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0))
+      && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0))) {
+    return 1;
+  }
+  vector<point2D> ab, cd;
+  ab.push_back(a); ab.push_back(b); ab.push_back(a);
+  cd.push_back(c); cd.push_back(d); cd.push_back(c);
+  vector<point2D> one(1);
+  for (int k = 0; k < 2; k++) {
+    one[0] = k ? d : c;
+    if (o1 == 0 && k == 0 && inside_hull(one, ab)) return 1;
+    if (o2 == 0 && k == 1 && inside_hull(one, ab)) return 1;
+    one[0] = k ? b : a;
+    if (o3 == 0 && k == 0 && inside_hull(one, cd)) return 1;
+    if (o4 == 0 && k == 1 && inside_hull(one, cd)) return 1;
+  }
+  return 0;
+}
+
+/* hulls in the form of reference_hull */
+static int brute_overlap(const vector<point2D>& a, const vector<point2D>& b) {
+  if (a.empty() || b.empty()) {
+    return 0;
+  }
+  if (inside_hull(vector<point2D>(1, a[0]), b)
+      || inside_hull(vector<point2D>(1, b[0]), a)) {
+    return 1;
+  }
+  for (size_t i = 0; i + 1 < a.size(); i++) {
+    for (size_t j = 0; j + 1 < b.size(); j++) {
+      if (segments_meet(a[i], a[i+1], b[j], b[j+1])) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/* area of a intersected with b, clipping a by every edge line of b */
+static long double clipped_area(const vector<point2D>& a,
+                                const vector<point2D>& b) {
+  if (a.size() < 4 || b.size() < 4) {
+    return 0;
+  }
+  vector<long double> x, y;
+  for (size_t i = 0; i + 1 < a.size(); i++) {
+    x.push_back(a[i].x);
+    y.push_back(a[i].y);
+  }
+  for (size_t j = 0; j + 1 < b.size() && !x.empty(); j++) {
+    long double ex = (long double) b[j+1].x - b[j].x;
+    long double ey = (long double) b[j+1].y - b[j].y;
+    vector<long double> nx, ny;
+    for (size_t i = 0; i < x.size(); i++) {
+      size_t k = (i + 1) % x.size();
+      long double si = ex * (y[i] - b[j].y) - ey * (x[i] - b[j].x);
+      long double sk = ex * (y[k] - b[j].y) - ey * (x[k] - b[j].x);
+      if (si >= 0) {
+        nx.push_back(x[i]);
+        ny.push_back(y[i]);
+      }
+      if ((si >= 0) != (sk >= 0)) {
+        long double t = si / (si - sk);
+        nx.push_back(x[i] + t * (x[k] - x[i]));
+        ny.push_back(y[i] + t * (y[k] - y[i]));
+      }
+    }
+    x = nx;
+    y = ny;
+  }
+  long double area = 0;
+  for (size_t i = 0; i < x.size(); i++) {
+    size_t k = (i + 1) % x.size();
+    area += x[i] * y[k] - x[k] * y[i];
+  }
+  return area / 2;
+}
+
+static long double polygon_area(const vector<point2Dd>& p) {
+  long double area = 0;
+  for (size_t i = 0; i + 1 < p.size(); i++) {
+    area += (long double) p[i].x * p[i+1].y - (long double) p[i+1].x * p[i].y;
+  }
+  return area / 2;
+}
+
+static vector<point2D> brute_minkowski(const vector<point2D>& a,
+                                       const vector<point2D>& b) {
+  vector<point2D> s;
+  for (size_t i = 0; i < a.size(); i++) {
+    for (size_t j = 0; j < b.size(); j++) {
+      point2D q;
+      q.x = a[i].x + b[j].x;
+      q.y = a[i].y + b[j].y;
+      s.push_back(q);
+    }
+  }
+  return reference_hull(s);
+}
+
+/* a random hull of up to 12 points in a box of side range at (ox,oy) */
+static vector<point2D> random_hull(int range, int ox, int oy) {
+  vector<point2D> p(1 + rnd(12));
+  for (size_t i = 0; i < p.size(); i++) {
+    p[i].x = ox + rnd(range);
+    p[i].y = oy + rnd(range);
+  }
+  if (rnd(4) == 0) {
+    //collinear: a segment, or a point
+    for (size_t i = 0; i < p.size(); i++) {
+      p[i].x = ox + (p[i].x - ox) / 2 * 2;
+      p[i].y = oy + (p[i].x - ox) / 2;
+    }
+  }
+  return reference_hull(p);
+}
+
+static void check_convex() {
+  int npairs = 3000;
+  vector<vector<point2D> > hulls;
+  vector<HullPair> pairs;
+  char name[64];
+  for (int s = 0; s < npairs; s++) {
+    rng_seed = 5000 + s;
+    //small coordinates touch and share edges often
+    int range = (s % 3 == 0) ? 8 : (s % 3 == 1) ? 1000 : BIG / 2;
+    int off = range / 2;
+    vector<point2D> a = random_hull(range, 0, 0);
+    vector<point2D> b = random_hull(range, rnd(off + 1), rnd(off + 1));
+    sprintf(name, "pair#%d", s);
+
+    int overlap = brute_overlap(a, b);
+    report("overlap", name, a.size() + b.size(),
+           convex_overlap(a, b) == overlap && convex_overlap(b, a) == overlap);
+
+    vector<point2Dd> c = convex_intersection(a, b);
+    long double ref = clipped_area(a, b);
+    long double scale = (long double) range * range;
+    report("intersection", name, a.size() + b.size(),
+           fabsl(polygon_area(c) - ref) <= 1e-9 * scale
+           && (overlap || c.empty()) && (c.empty() || c.size() >= 4));
+
+    report("minkowski", name, a.size() + b.size(),
+           same_points(minkowski_sum(a, b), brute_minkowski(a, b)));
+
+    hulls.push_back(a);
+    hulls.push_back(b);
+    HullPair pr = {2L * s, 2L * s + 1};
+    pairs.push_back(pr);
+  }
+
+  //the batches give the same results
+  vector<char> out(npairs);
+  convex_overlap_batch(&hulls[0], &pairs[0], npairs, &out[0], 3);
+  vector<point2Dd> ci;
+  vector<point2D> ms;
+  vector<long> first, size;
+  convex_intersection_batch(&hulls[0], &pairs[0], npairs, ci, first, size, 3);
+  int ok = 1;
+  for (int i = 0; i < npairs; i++) {
+    const vector<point2D>& a = hulls[pairs[i].a];
+    const vector<point2D>& b = hulls[pairs[i].b];
+    vector<point2Dd> c = convex_intersection(a, b);
+    ok = ok && out[i] == convex_overlap(a, b) && size[i] == (long) c.size();
+    for (long k = 0; ok && k < size[i]; k++) {
+      ok = ci[first[i] + k].x == c[k].x && ci[first[i] + k].y == c[k].y;
+    }
+  }
+  minkowski_sum_batch(&hulls[0], &pairs[0], npairs, ms, first, size, 3);
+  for (int i = 0; i < npairs; i++) {
+    vector<point2D> m(ms.begin() + first[i], ms.begin() + first[i] + size[i]);
+    ok = ok && same_points(m, minkowski_sum(hulls[pairs[i].a],
+                                            hulls[pairs[i].b]));
+  }
+  report("convex batch", "pairs", npairs, ok);
+
+  //empty hulls, alone and with a triangle
+  vector<point2D> e, tri = random_hull(1000, 0, 0);
+  report("intersection", "empty", 0, convex_intersection(e, e).empty()
+         && convex_intersection(e, tri).empty()
+         && convex_intersection(tri, e).empty());
+  report("overlap", "empty", 0, !convex_overlap(e, e) && !convex_overlap(e, tri));
+  report("minkowski", "empty", 0, minkowski_sum(e, e).empty()
+         && minkowski_sum(e, tri).empty());
+}
+
+
+/* ****************************** */
+/* rotating calipers (calipers.h) against O(h^2) brute force: the
+   diameter over all pairs of vertices, the width as the smallest
+   over edges of the farthest vertex from the edge line, and the
+   rectangles from trying every edge direction */
+static int close_to(long double a, long double b, long double scale) {
+  return fabsl(a - b) <= 1e-9 * scale;
+}
+
+/* the corners of r span area and perimeter, and every vertex of h is
+   inside r (up to rounding) */
+static int rect_ok(const HullRect& r, const vector<point2D>& h,
+                   long double scale) {
+  long double area = 0, perim = 0;
+  for (int c = 0; c < 4; c++) {
+    int d = (c + 1) % 4;
+    area += (long double) r.x[c] * r.y[d] - (long double) r.x[d] * r.y[c];
+    perim += hypotl((long double) r.x[d] - r.x[c],
+                    (long double) r.y[d] - r.y[c]);
+  }
+  int ok = close_to(area / 2, r.area, scale * scale)
+    && close_to(perim, r.perimeter, scale);
+  for (int c = 0; c < 4; c++) {
+    int d = (c + 1) % 4;
+    long double ex = (long double) r.x[d] - r.x[c];
+    long double ey = (long double) r.y[d] - r.y[c];
+    long double len = sqrtl(ex * ex + ey * ey);
+    for (size_t i = 0; len > 0 && i < h.size(); i++) {
+      long double o = (ex * ((long double) h[i].y - r.y[c])
+                       - ey * ((long double) h[i].x - r.x[c])) / len;
+      ok = ok && o >= -1e-9 * scale;
+    }
+  }
+  return ok;
+}
+
+static int check_metrics(const char* set, const vector<point2D>& h) {
+  HullMetrics m;
+  hull_metrics(h, &m);
+  long nv = h.size() > 1 ? h.size() - 1 : h.size();
+  long double scale = 1;
+  long long d2 = 0;
+  for (long a = 0; a < nv; a++) {
+    scale = max(scale, (long double) llabs(h[a].x) + llabs(h[a].y));
+    for (long b = a + 1; b < nv; b++) {
+      long long dx = (long long) h[a].x - h[b].x;
+      long long dy = (long long) h[a].y - h[b].y;
+      d2 = max(d2, dx * dx + dy * dy);
+    }
+  }
+  int ok = m.diameter2 == d2 && close_to(m.diameter, sqrtl(d2), scale);
+  if (nv > 0) {
+    long long dx = (long long) h[m.diam_a].x - h[m.diam_b].x;
+    long long dy = (long long) h[m.diam_a].y - h[m.diam_b].y;
+    ok = ok && dx * dx + dy * dy == d2;
+  }
+
+  //a point or a segment: no width, flat rectangles
+  long double width = 0, area = 0, perim = 2 * sqrtl(d2);
+  if (nv >= 3) {
+    width = area = perim = -1;
+    for (long i = 0; i < nv; i++) {
+      point2D a = h[i], b = h[i + 1];
+      long double ex = (long double) b.x - a.x, ey = (long double) b.y - a.y;
+      long double len = sqrtl(ex * ex + ey * ey);
+      long double ht = 0, smin = 0, smax = 0;
+      for (long j = 0; j < nv; j++) {
+        long double qx = (long double) h[j].x - a.x, qy = (long double) h[j].y - a.y;
+        ht = max(ht, (ex * qy - ey * qx) / len);
+        smin = min(smin, (ex * qx + ey * qy) / len);
+        smax = max(smax, (ex * qx + ey * qy) / len);
+      }
+      if (width < 0 || ht < width) width = ht;
+      if (area < 0 || ht * (smax - smin) < area) area = ht * (smax - smin);
+      if (perim < 0 || 2 * (ht + smax - smin) < perim) perim = 2 * (ht + smax - smin);
+    }
+    //the width is attained by the vertex and edge reported
+    point2D a = h[m.width_edge], b = h[m.width_edge + 1];
+    long double len = hypotl((long double) b.x - a.x, (long double) b.y - a.y);
+    ok = ok && close_to(orient2D(a, b, h[m.width_vertex]) / len, width, scale);
+  }
+  ok = ok && close_to(m.width, width, scale)
+    && close_to(m.min_area_rect.area, area, scale * scale)
+    && close_to(m.min_perimeter_rect.perimeter, perim, scale)
+    && rect_ok(m.min_area_rect, h, scale)
+    && rect_ok(m.min_perimeter_rect, h, scale);
+  report("calipers", set, nv, ok);
+  return ok;
+}
+
+static void check_calipers() {
+  vector<vector<point2D> > hulls;
+  vector<point2D> p;
+  char name[64];
+  long sizes[] = {1, 2, 3, 4, 10, 1000, 100000};
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+      generate_points(g, sizes[k], 1, p);
+      hulls.push_back(reference_hull(p));
+      check_metrics(generator_name(g), hulls.back());
+    }
+  }
+  //points, segments, triangles and thin hulls, small and near 2^30
+  for (int s = 0; s < 1000; s++) {
+    rng_seed = 7000 + s;
+    long n = 1 + rnd(s < 500 ? 4 : 100);
+    switch (s % 5) {
+    case 0: repeated_set(n, p); strcpy(name, "repeated"); break;
+    case 1: collinear_set(n, s % 2, p); strcpy(name, "collinear"); break;
+    case 2: random_set(n, 3, p); strcpy(name, "random_small"); break;
+    case 3: random_set(n, BIG, p); strcpy(name, "random_big"); break;
+    case 4: big_circle_set(n, p); strcpy(name, "circle_big"); break;
+    }
+    sprintf(name + strlen(name), "#%d", s);
+    hulls.push_back(reference_hull(p));
+    check_metrics(name, hulls.back());
+  }
+  //the batch gives the same metrics
+  vector<HullMetrics> m(hulls.size());
+  hull_metrics_batch(&hulls[0], hulls.size(), &m[0], 3);
+  int ok = 1;
+  for (size_t i = 0; i < hulls.size(); i++) {
+    HullMetrics one;
+    hull_metrics(hulls[i], &one);
+    ok = ok && m[i].diameter2 == one.diameter2 && m[i].width == one.width
+      && m[i].min_area_rect.area == one.min_area_rect.area
+      && m[i].min_perimeter_rect.perimeter == one.min_perimeter_rect.perimeter;
+  }
+  report("calipers batch", "hulls", hulls.size(), ok);
+}
+
+
+/* ****************************** */
+/* hull queries (hullquery.h) against linear scans of the vertices */
+static int scan_contains(const vector<point2D>& v, point2D q) {
+  long h = v.size();
+  if (h == 0) {
+    return 0;
+  }
+  if (h <= 2) {
+    //on the segment (or the point)
+    point2D a = v[0], b = v[h - 1];
+    return orient2D(a, b, q) == 0
+      && min(a.x, b.x) <= q.x && q.x <= max(a.x, b.x)
+      && min(a.y, b.y) <= q.y && q.y <= max(a.y, b.y);
+  }
+  for (long i = 0; i < h; i++) {
+    if (orient2D(v[i], v[(i + 1) % h], q) < 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* every vertex is on or right of q->v[t] (side < 0), or on or left
+   of it (side > 0) */
+static int scan_tangent(const vector<point2D>& v, point2D q, int t, int side) {
+  if (t < 0 || t >= (int) v.size()) {
+    return 0;
+  }
+  for (size_t i = 0; i < v.size(); i++) {
+    long long o = orient2D(q, v[t], v[i]);
+    if ((side < 0 && o > 0) || (side > 0 && o < 0)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static int scan_extreme(const vector<point2D>& v, point2D d, int e) {
+  if (v.empty()) {
+    return e == -1;
+  }
+  if (e < 0 || e >= (int) v.size()) {
+    return 0;
+  }
+  long long best = (long long) v[e].x * d.x + (long long) v[e].y * d.y;
+  for (size_t i = 0; i < v.size(); i++) {
+    if ((long long) v[i].x * d.x + (long long) v[i].y * d.y > best) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static long long gcd_ll(long long a, long long b) {
+  a = llabs(a);
+  b = llabs(b);
+  while (b) {
+    long long r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+/* run the queries on the hull of p: the vertices, lattice points on
+   the edges and on their lines just past the ends, points next to
+   the vertices and random points around the hull; directions along,
+   against and across the edges, and random ones */
+static void check_queries_on(const char* set, const vector<point2D>& p) {
+  HullQuery hq;
+  hq_build(hq, reference_hull(p));
+  const vector<point2D>& v = hq.v;
+  long h = v.size();
+
+  vector<point2D> q, d;
+  for (long i = 0; i < h; i++) {
+    point2D a = v[i], b = v[(i + 1) % h];
+    q.push_back(a);
+    for (int dx = -1; dx <= 1; dx++) {
+      for (int dy = -1; dy <= 1; dy++) {
+        point2D r = {a.x + dx, a.y + dy};
+        if (llabs(r.x) < (1 << 30) && llabs(r.y) < (1 << 30)) q.push_back(r);
+      }
+    }
+    long long ex = (long long) b.x - a.x, ey = (long long) b.y - a.y;
+    long long g = gcd_ll(ex, ey);
+    if (g > 0) {
+      //lattice points on the edge, and one step past each end
+      for (long long j = -1; j <= g + 1; j += max(1LL, g / 4)) {
+        point2D r = {(int) (a.x + ex / g * j), (int) (a.y + ey / g * j)};
+        if (llabs(r.x) < (1 << 30) && llabs(r.y) < (1 << 30)) q.push_back(r);
+      }
+      point2D r = {(int) (ex / g), (int) (ey / g)};
+      d.push_back(r);
+      r.x = -r.x; r.y = -r.y;
+      d.push_back(r);
+      point2D s = {(int) (-ey / g), (int) (ex / g)};
+      d.push_back(s);
+    }
+  }
+  int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  for (long i = 0; i < h; i++) {
+    x0 = min(x0, v[i].x); x1 = max(x1, v[i].x);
+    y0 = min(y0, v[i].y); y1 = max(y1, v[i].y);
+  }
+  long long wx = (long long) x1 - x0 + 3, wy = (long long) y1 - y0 + 3;
+  for (int i = 0; i < 200; i++) {
+    long rx = x0 - 1 + rnd(wx), ry = y0 - 1 + rnd(wy);
+    point2D r = {(int) max(-(long) BIG, min((long) BIG, rx)),
+                 (int) max(-(long) BIG, min((long) BIG, ry))};
+    q.push_back(r);
+    point2D e = {(int) rnd(2001) - 1000, (int) rnd(2001) - 1000};
+    d.push_back(e);
+  }
+  point2D zero = {0, 0};
+  d.push_back(zero);
+
+  long m = q.size(), md = d.size();
+  int ok = 1;
+  vector<char> inside(m);
+  vector<int> left(m), right(m), ext(md);
+  hq_contains_batch(hq, &q[0], m, &inside[0], 3);
+  hq_tangents_batch(hq, &q[0], m, &left[0], &right[0], 3);
+  hq_extreme_batch(hq, &d[0], md, &ext[0], 3);
+  for (long i = 0; i < m; i++) {
+    int c = hq_contains(hq, q[i]);
+    int l = -1, r = -1;
+    int t = hq_tangents(hq, q[i], &l, &r);
+    //an empty hull has no tangents
+    ok = ok && c == scan_contains(v, q[i]) && c == inside[i]
+      && t == (!c && h > 0);
+    if (t) {
+      ok = ok && scan_tangent(v, q[i], l, -1) && scan_tangent(v, q[i], r, 1)
+        && l == left[i] && r == right[i];
+    } else {
+      ok = ok && left[i] == -1 && right[i] == -1;
+    }
+  }
+  for (long i = 0; i < md; i++) {
+    int e = hq_extreme(hq, d[i]);
+    ok = ok && scan_extreme(v, d[i], e) && e == ext[i];
+  }
+  report("query", set, h, ok);
+}
+
+static void check_queries() {
+  vector<point2D> p;
+  char name[64];
+  long sizes[] = {1, 2, 3, 10, 1000};
+  rng_seed = 11000;
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+      generate_points(g, sizes[k], 1, p);
+      check_queries_on(generator_name(g), p);
+    }
+  }
+  //points, segments, triangles, small and near 2^30
+  for (int s = 0; s < 600; s++) {
+    rng_seed = 12000 + s;
+    long n = 1 + rnd(s < 300 ? 4 : 60);
+    switch (s % 5) {
+    case 0: repeated_set(n, p); strcpy(name, "repeated"); break;
+    case 1: collinear_set(n, s % 2, p); strcpy(name, "collinear"); break;
+    case 2: random_set(n, 3, p); strcpy(name, "random_small"); break;
+    case 3: random_set(n, BIG, p); strcpy(name, "random_big"); break;
+    case 4: big_circle_set(n, p); strcpy(name, "circle_big"); break;
+    }
+    sprintf(name + strlen(name), "#%d", s);
+    check_queries_on(name, p);
+  }
+}
+
+
+/* ****************************** */
+/* the viewer's quadtree: the cells partition the points and bound
+   them, and the cells drawn for random views hold every point of the
+   view exactly once, aggregated only when they are small enough */
+static int check_views(const QuadTree& t) {
+  long n = t.p.size();
+  int ok = 1;
+  for (size_t k = 0; k < t.node.size(); k++) {
+    const QuadNode& nd = t.node[k];
+    for (long i = nd.lo; i < nd.hi; i++) {
+      ok = ok && t.p[i].x >= nd.x0 && t.p[i].x <= nd.x1
+        && t.p[i].y >= nd.y0 && t.p[i].y <= nd.y1;
+    }
+    if (nd.child >= 0) {
+      ok = ok && nd.nchild >= 1 && t.node[nd.child].lo == nd.lo
+        && t.node[nd.child + nd.nchild - 1].hi == nd.hi;
+      for (int c = 1; c < nd.nchild; c++) {
+        ok = ok && t.node[nd.child + c].lo == t.node[nd.child + c - 1].hi;
+      }
+    } else {
+      ok = ok && (nd.hi - nd.lo <= t.leaf
+                  || (nd.x0 == nd.x1 && nd.y0 == nd.y1));
+    }
+  }
+
+  const QuadNode& root = t.node[0];
+  vector<long> cells, leaves;
+  vector<int> seen(n);
+  for (int v = 0; ok && v < 20; v++) {
+    double pixel = (root.x1 - root.x0 + 1.0) / (1 << rnd(16)) / 500;
+    double x0 = root.x0 + rnd(root.x1 - root.x0 + 1L) - 250 * pixel;
+    double y0 = root.y0 + rnd(root.y1 - root.y0 + 1L) - 250 * pixel;
+    double x1 = x0 + 500 * pixel, y1 = y0 + 500 * pixel;
+    qt_visible(t, x0, y0, x1, y1, pixel, 2, cells, leaves);
+    fill(seen.begin(), seen.end(), 0);
+    for (size_t c = 0; c < cells.size(); c++) {
+      const QuadNode& nd = t.node[cells[c]];
+      ok = ok && nd.x1 - nd.x0 <= 2 * pixel && nd.y1 - nd.y0 <= 2 * pixel;
+      for (long i = nd.lo; i < nd.hi; i++) seen[i]++;
+    }
+    for (size_t l = 0; l < leaves.size(); l++) {
+      const QuadNode& nd = t.node[leaves[l]];
+      ok = ok && nd.child < 0;
+      for (long i = nd.lo; i < nd.hi; i++) seen[i]++;
+    }
+    for (long i = 0; i < n; i++) {
+      int in = t.p[i].x >= x0 && t.p[i].x <= x1
+        && t.p[i].y >= y0 && t.p[i].y <= y1;
+      ok = ok && seen[i] <= 1 && (!in || seen[i] == 1);
+    }
+  }
+  return ok;
+}
+
+static void check_quadtree() {
+  rng_seed = 9000;
+  QuadTree t;
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    vector<point2D> p;
+    generate_points(g, 20000, 1, p);
+    qt_build_from(t, p, 16);
+    report("quadtree", generator_name(g), t.p.size(), check_views(t)
+           && p.empty() && (long) t.p.size() == generator_count(g, 20000));
+  }
+  vector<point2D> p;
+  repeated_set(1000, p);
+  qt_build(t, p, 16);
+  report("quadtree", "repeated", p.size(), check_views(t));
+  big_circle_set(5000, p);
+  qt_build(t, p, 16);
+  report("quadtree", "big circle", p.size(), check_views(t));
+}
+
+
+/* ****************************** */
+/* the adaptive predicates, on coordinates that are multiples of 1/16
+   below 2^56 in magnitude, so that the determinant can be computed
+   exactly in 128-bit integers for reference */
+static double dyadic(long bits) {
+  //a random double with up to bits significant bits, a random
+  //exponent and a random sign, rounded to a multiple of 1/16
+  long k = 1 + rnd(bits);
+  double m = ldexp((double) rnd(1L << k), (int) rnd(56 - k + 1) - 4);
+  m = ldexp(nearbyint(ldexp(m, 4)), -4);
+  return rnd(2) ? m : -m;
+}
+
+static int exact_sign(point2Dd a, point2Dd b, point2Dd c) {
+  __int128 ax = (long long) ldexp(a.x, 4), ay = (long long) ldexp(a.y, 4);
+  __int128 bx = (long long) ldexp(b.x, 4), by = (long long) ldexp(b.y, 4);
+  __int128 cx = (long long) ldexp(c.x, 4), cy = (long long) ldexp(c.y, 4);
+  __int128 d = (ax - cx) * (by - cy) - (ay - cy) * (bx - cx);
+  return (d > 0) - (d < 0);
+}
+
+static int sign_of(double d) {
+  return (d > 0) - (d < 0);
+}
+
+/* a point close to the line ab, off by a few units in the last place */
+static point2Dd near_line(point2Dd a, point2Dd b) {
+  double t = rnd(1 << 20) / (double) (1 << 20);
+  point2Dd c = {a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)};
+  for (long j = rnd(3); j > 0; j--) {
+    c.x = nextafter(c.x, rnd(2) ? INFINITY : -INFINITY);
+  }
+  c.x = ldexp(nearbyint(ldexp(c.x, 4)), -4);
+  c.y = ldexp(nearbyint(ldexp(c.y, 4)), -4);
+  return c;
+}
+
+static void check_predicates() {
+  rng_seed = 11000;
+  predicate_stats_reset();
+  long wrong = 0;
+  for (long i = 0; i < 300000; i++) {
+    point2Dd a = {dyadic(53), dyadic(53)}, b = {dyadic(53), dyadic(53)};
+    point2Dd c;
+    if (i % 3 == 0) {
+      c.x = dyadic(53);
+      c.y = dyadic(53);
+    } else {
+      c = near_line(a, b);
+    }
+    int e = exact_sign(a, b, c);
+    wrong += sign_of(orient2d_adapt(a, b, c)) != e;
+    wrong += sign_of(orient2d_exact(a, b, c)) != e;
+  }
+  PredicateStats st;
+  predicate_stats(&st);
+  //the nearly collinear triples must have reached both slow stages
+  report("orient2d", "triples", 300000, wrong == 0 && st.adapt > 0
+         && st.exact > 0);
+
+  //hulls of nearly collinear sets: strictly convex, and no point
+  //outside
+  for (int s = 0; s < 300; s++) {
+    point2Dd a = {dyadic(53), dyadic(53)}, b = {dyadic(53), dyadic(53)};
+    long n = 1 + rnd(200);
+    vector<point2Dd> p(n);
+    for (long i = 0; i < n; i++) {
+      p[i] = (i % 8 == 0) ? a : near_line(a, b);
+    }
+    vector<point2Dd> h = monotone_chain_d(p);
+    int ok = h.size() >= 2 && h.front().x == h.back().x
+      && h.front().y == h.back().y;
+    for (size_t i = 0; ok && h.size() > 3 && i + 1 < h.size(); i++) {
+      ok = exact_sign(h[i], h[i + 1], h[(i + 2) % (h.size() - 1)]) > 0;
+    }
+    for (long i = 0; ok && i < n; i++) {
+      for (size_t j = 0; ok && j + 1 < h.size(); j++) {
+        ok = exact_sign(h[j], h[j + 1], p[i]) >= 0;
+      }
+    }
+    report("hull double", "nearly collinear", n, ok);
+  }
+
+  //on int coordinates it is the int hull
+  for (int g = 0; g < NB_GENERATORS; g++) {
+    vector<point2D> p;
+    generate_points(g, 10000, 1, p);
+    vector<point2Dd> pd(p.size());
+    for (size_t i = 0; i < p.size(); i++) {
+      pd[i].x = p[i].x;
+      pd[i].y = p[i].y;
+    }
+    vector<point2D> h = monotone_chain(p);
+    vector<point2Dd> hd = monotone_chain_d(pd);
+    int ok = h.size() == hd.size();
+    for (size_t i = 0; ok && i < h.size(); i++) {
+      ok = h[i].x == hd[i].x && h[i].y == hd[i].y;
+    }
+    report("hull double", generator_name(g), p.size(), ok);
+  }
+}
+
+
+/* ****************************** */
+/* hull deltas: a point set changes a little from frame to frame
+   (points moved, added, removed, sometimes all of them replaced);
+   the delta of consecutive hulls goes through the encoding and is
+   applied to the consumer's copy, closed and not closed */
+static int same_delta(const HullDelta& a, const HullDelta& b) {
+  int ok = a.old_size == b.old_size && a.new_size == b.new_size
+    && a.rotate == b.rotate && a.ops.size() == b.ops.size()
+    && same_points(a.pts, b.pts);
+  for (size_t i = 0; ok && i < a.ops.size(); i++) {
+    ok = a.ops[i].pos == b.ops[i].pos && a.ops[i].del == b.ops[i].del
+      && a.ops[i].ins == b.ops[i].ins;
+  }
+  return ok;
+}
+
+static void check_delta() {
+  char name[64];
+  for (int s = 0; s < 200; s++) {
+    rng_seed = 12000 + s;
+    int range = (s % 3 == 0) ? 20 : (s % 3 == 1) ? 1000 : BIG;
+    vector<point2D> p;
+    random_set(rnd(3) ? 1 + rnd(300) : rnd(3), range, p);
+    vector<point2D> prev = reference_hull(p);
+    vector<point2D> closed = prev, open = hull_canonical(prev);
+    int ok = 1;
+    for (int f = 0; ok && f < 20; f++) {
+      long k = rnd(4);
+      if (k == 0 && !p.empty()) {
+        //move a few points
+        for (long c = 1 + rnd(3); c > 0; c--) {
+          point2D& q = p[rnd(p.size())];
+          q.x = max(-range, min(range, q.x + (int) rnd(21) - 10));
+          q.y = max(-range, min(range, q.y + (int) rnd(21) - 10));
+        }
+      } else if (k == 1) {
+        vector<point2D> more;
+        random_set(1 + rnd(5), range, more);
+        p.insert(p.end(), more.begin(), more.end());
+      } else if (k == 2 && !p.empty()) {
+        p.erase(p.begin() + rnd(p.size()));
+      } else if (rnd(4) == 0) {
+        random_set(rnd(50), range, p);
+      }
+      vector<point2D> h = reference_hull(p);
+
+      HullDelta d, got;
+      hull_diff(prev, h, d);
+      vector<uint8_t> buf;
+      size_t bytes = hull_delta_encode(d, buf);
+      ok = hull_delta_decode(&buf[0], bytes, got) == (long) bytes
+        && same_delta(d, got);
+      //every truncation of the encoding is rejected
+      for (size_t b = 0; ok && b < bytes; b++) {
+        HullDelta t;
+        ok = hull_delta_decode(&buf[0], b, t) < 0;
+      }
+      //an empty hull comes back closed, so the open copy is kept open
+      int was_empty = open.empty();
+      ok = ok && hull_apply(closed, got) == 0 && same_points(closed, h)
+        && hull_apply(open, got) == 0;
+      if (was_empty) {
+        open = hull_canonical(open);
+      }
+      ok = ok && same_points(open, hull_canonical(h));
+      prev = h;
+    }
+    sprintf(name, "sequence#%d", s);
+    report("delta", name, p.size(), ok);
+  }
+}
+
+
+/* ****************************** */
+/* convex layers against peeling: the points on the boundary of the
+   reference hull of the remaining points are the next layer */
+static int peel_reference(const vector<point2D>& p, vector<int>& layer) {
+  layer.assign(p.size(), -1);
+  int l = 0;
+  for (size_t left = p.size(); left > 0; l++) {
+    vector<point2D> rest;
+    for (size_t i = 0; i < p.size(); i++) {
+      if (layer[i] < 0) {
+        rest.push_back(p[i]);
+      }
+    }
+    vector<point2D> h = reference_hull(rest);
+    for (size_t i = 0; i < p.size(); i++) {
+      point2D a = p[i];
+      for (size_t e = 0; layer[i] < 0 && e + 1 < h.size(); e++) {
+        if (orient2D(h[e], h[e+1], a) == 0
+            && min(h[e].x, h[e+1].x) <= a.x && a.x <= max(h[e].x, h[e+1].x)
+            && min(h[e].y, h[e+1].y) <= a.y && a.y <= max(h[e].y, h[e+1].y)) {
+          layer[i] = l;
+          left--;
+        }
+      }
+    }
+  }
+  return l;
+}
+
+static void check_layers() {
+  vector<point2D> p;
+  char name[64];
+  for (int s = 0; s < 600; s++) {
+    rng_seed = 13000 + s;
+    long n = 1 + rnd(s < 300 ? 20 : 400);
+    switch (s % 5) {
+    case 0: repeated_set(n, p); strcpy(name, "repeated"); break;
+    case 1: collinear_set(n, s % 2, p); strcpy(name, "collinear"); break;
+    case 2: random_set(n, 4, p); strcpy(name, "random_small"); break;
+    case 3: random_set(n, 30, p); strcpy(name, "random"); break;
+    case 4: random_set(n, BIG, p); strcpy(name, "random_big"); break;
+    }
+    sprintf(name + strlen(name), "#%d", s);
+    vector<int> layer, ref;
+    int l = convex_layers(p, layer);
+    report("layers", name, n, l == peel_reference(p, ref) && layer == ref);
+  }
+}
+
+
+/* ****************************** */
+/* the hull cache: two passes over some generator sets, the second
+   one all hits, through a budget that only holds some of them, and
+   then through a new cache that only has the disk tier */
+static void check_cache() {
+  HullOptions opt;
+  hull_default_options(&opt);
+  int nsets = 6;
+  vector<vector<point2D> > sets(nsets), ref(nsets);
+  for (int g = 0; g < nsets; g++) {
+    generate_points(g, 1000, 1, sets[g]);
+    ref[g] = reference_hull(sets[g]);
+  }
+  char path[] = "/tmp/hulltestXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror(path);
+    failures++;
+    return;
+  }
+  close(fd);
+
+  //room for about 3 of the hulls in memory
+  HullCache* c = hull_cache_create(3 * (ref[0].size() * sizeof(point2D) + 200));
+  report("cache", "disk", 0, hull_cache_open_disk(c, path, 1 << 20) == 0);
+  for (int pass = 0; pass < 2; pass++) {
+    for (int g = 0; g < nsets; g++) {
+      int hit;
+      vector<point2D> h = cached_hull(c, sets[g], opt, &hit);
+      report("cache", generator_name(g), 1000, same_points(h, ref[g])
+             && hit == pass);
+    }
+  }
+  HullCacheStats st;
+  hull_cache_stats(c, &st);
+  report("cache", "evict", 0, st.evictions > 0 && st.entries < nsets
+         && st.bytes <= c->budget && st.disk_hits > 0);
+
+  //the key depends on the order of the points and on the options
+  vector<point2D> rev(sets[0].rbegin(), sets[0].rend());
+  HullKey k0 = hull_key(&sets[0][0], sets[0].size(), opt);
+  report("cache", "key", 0, !(k0 == hull_key(&rev[0], rev.size(), opt)));
+  HullOptions approx = opt;
+  approx.engine = HULL_APPROX;
+  HullKey k1 = hull_key(&sets[0][0], sets[0].size(), approx);
+  approx.strips = 10;
+  report("cache", "key", 0, !(k0 == k1)
+         && !(k1 == hull_key(&sets[0][0], sets[0].size(), approx)));
+  hull_cache_destroy(c);
+
+  c = hull_cache_create(1 << 20);
+  report("cache", "reopen", 0, hull_cache_open_disk(c, path, 1 << 20) == 0);
+  for (int g = 0; g < nsets; g++) {
+    int hit;
+    vector<point2D> h = cached_hull(c, sets[g], opt, &hit);
+    report("cache", generator_name(g), 1000, same_points(h, ref[g]) && hit);
+  }
+  hull_cache_destroy(c);
+
+  //the header is magic, size, used; a record is two hash words, n,
+  //nhull. A record past used, left by a process that died before
+  //committing it, is ignored; a corrupt nhull starts the log over
+  uint64_t used = 0, big = 1ULL << 61;
+  fd = open(path, O_RDWR);
+  int ok = fd >= 0 && pread(fd, &used, 8, 16) == 8
+    && pwrite(fd, &big, 8, used + 24) == 8;
+  c = hull_cache_create(1 << 20);
+  ok = ok && hull_cache_open_disk(c, path, 1 << 20) == 0;
+  for (int g = 0; g < nsets; g++) {
+    int hit;
+    vector<point2D> h = cached_hull(c, sets[g], opt, &hit);
+    ok = ok && same_points(h, ref[g]) && hit;
+  }
+  hull_cache_destroy(c);
+  report("cache", "uncommitted", 0, ok);
+
+  //an nhull for the first record that would make it end exactly at
+  //used if its size wrapped around
+  big = (1ULL << 61) + (used - 32 - 40) / 8;
+  ok = fd >= 0 && pwrite(fd, &big, 8, 32 + 24) == 8;
+  c = hull_cache_create(1 << 20);
+  ok = ok && hull_cache_open_disk(c, path, 1 << 20) == 0;
+  int hit = 1;
+  vector<point2D> h = cached_hull(c, sets[0], opt, &hit);
+  report("cache", "corrupt", 0, ok && same_points(h, ref[0]) && !hit);
+  hull_cache_destroy(c);
+  if (fd >= 0) {
+    close(fd);
+  }
+  unlink(path);
+}
+
+
+/* ****************************** */
+/* performance */
+static map<string, double> load_baseline(const char* path) {
+  map<string, double> b;
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    return b;
+  }
+  char name[256];
+  double us;
+  while (fscanf(f, "%255s %lf", name, &us) == 2) {
+    b[name] = us;
+  }
+  fclose(f);
+  return b;
+}
+
+static void save_baseline(const char* path, const map<string, double>& b) {
+  FILE* f = fopen(path, "w");
+  if (f == NULL) {
+    perror(path);
+    failures++;
+    return;
+  }
+  for (map<string, double>::const_iterator it = b.begin(); it != b.end(); it++) {
+    fprintf(f, "%s %.0f\n", it->first.c_str(), it->second);
+  }
+  fclose(f);
+}
+
+/* median wall time of seven runs of f, in microseconds: one slow
+   or one lucky run does not move it */
+template<class F> static double median_time(F f) {
+  double us[7];
+  for (int r = 0; r < 7; r++) {
+    Rtimer rt;
+    rt_start(rt);
+    f();
+    rt_stop(rt);
+    us[r] = rt_w_useconds(rt);
+  }
+  sort(us, us + 7);
+  return us[3];
+}
+
+//cases shorter than this are reported but not compared: a few
+//microseconds of noise is a large fraction of them
+static const double MIN_GATED_US = 1000;
+
+static void check_performance(const char* path, double threshold, int update) {
+  map<string, double> baseline = load_baseline(path);
+  map<string, double> now;
+  const int gens[] = {GEN_CIRCLE, GEN_STAR, GEN_RANDOM, GEN_BUTTERFLY};
+  const long n = 1000000;
+  vector<point2D> p;
+  HullOptions opt;
+  hull_default_options(&opt);
+
+  printf("%-28s %10s %10s\n", "case", "us", "baseline");
+  for (size_t k = 0; k < sizeof(gens) / sizeof(gens[0]); k++) {
+    generate_points(gens[k], n, 1, p);
+    for (int e = 0; e < NB_HULL_ENGINES; e++) {
+      opt.engine = e;
+      string name = string(hull_engine_name(e)) + "/" + generator_name(gens[k]);
+      now[name] = median_time([&]() { compute_hull(p, opt); });
+    }
+  }
+
+  int added = 0;
+  for (map<string, double>::iterator it = now.begin(); it != now.end(); it++) {
+    map<string, double>::iterator b = baseline.find(it->first);
+    if (b == baseline.end() || update) {
+      printf("%-28s %10.0f %10s\n", it->first.c_str(), it->second, "new");
+      baseline[it->first] = it->second;
+      added = 1;
+      continue;
+    }
+    int gated = b->second >= MIN_GATED_US;
+    int slow = gated && it->second > b->second * (1 + threshold / 100);
+    printf("%-28s %10.0f %10.0f %+6.1f%%%s\n", it->first.c_str(), it->second,
+           b->second, 100 * (it->second / b->second - 1),
+           slow ? "  SLOWER THAN THRESHOLD" : gated ? "" : "  (not gated)");
+    failures += slow;
+  }
+  if (added) {
+    save_baseline(path, baseline);
+  }
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+  const char* path = "hulltest.baseline";
+  const char* env = getenv("HULL_PERF_THRESHOLD");
+  double threshold = env ? atof(env) : 25;
+  int quick = 0, update = 0;
+  int c;
+  while ((c = getopt(argc, argv, "qt:b:u")) != -1) {
+    switch (c) {
+    case 'q': quick = 1; break;
+    case 't': threshold = atof(optarg); break;
+    case 'b': path = optarg; break;
+    case 'u': update = 1; break;
+    default:
+      printf("usage: hulltest [-q] [-t threshold] [-b baseline] [-u]\n");
+      exit(1);
+    }
+  }
+
+  check_generators();
+  printf("generators: %d failures\n", failures);
+  int before = failures;
+  check_degenerate();
+  printf("degenerate sets: %d failures\n", failures - before);
+  before = failures;
+  check_convex();
+  printf("convex pairs: %d failures\n", failures - before);
+  before = failures;
+  check_cache();
+  printf("cache: %d failures\n", failures - before);
+  before = failures;
+  check_calipers();
+  printf("calipers: %d failures\n", failures - before);
+  before = failures;
+  check_queries();
+  printf("hull queries: %d failures\n", failures - before);
+  before = failures;
+  check_quadtree();
+  printf("quadtree: %d failures\n", failures - before);
+  before = failures;
+  check_predicates();
+  printf("predicates: %d failures\n", failures - before);
+  before = failures;
+  check_delta();
+  printf("hull deltas: %d failures\n", failures - before);
+  before = failures;
+  check_layers();
+  printf("convex layers: %d failures\n", failures - before);
+  if (!quick) {
+    check_performance(path, threshold, update);
+  }
+  printf("%s\n", failures ? "FAILED" : "passed");
+  return failures != 0;
+}
@@ -0,0 +1,635 @@
+#include "kernels.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+
+/* **************************************** */
+/* extremes: the key each direction maximizes, and how the SIMD lanes
+   map to directions. The SIMD variants track, per lane, the min and
+   max of V = (x, y) and W = (x + y, x - y) with the first index
+   attaining them; extremes_reduce folds the lanes together. */
+static inline void extreme_keys(point2D q, long long* key) {
+  long long x = q.x, y = q.y;
+  key[EXT_MIN_Y] = -y;
+  key[EXT_MAX_X_MIN_Y] = x - y;
+  key[EXT_MAX_X] = x;
+  key[EXT_MAX_X_PLUS_Y] = x + y;
+  key[EXT_MAX_Y] = y;
+  key[EXT_MIN_X_MIN_Y] = y - x;
+  key[EXT_MIN_X] = -x;
+  key[EXT_MIN_X_PLUS_Y] = -x - y;
+}
+
+//direction of the min and max of lane parity 0 (even) and 1 (odd)
+static const int V_MIN[2] = {EXT_MIN_X, EXT_MIN_Y};
+static const int V_MAX[2] = {EXT_MAX_X, EXT_MAX_Y};
+static const int W_MIN[2] = {EXT_MIN_X_PLUS_Y, EXT_MIN_X_MIN_Y};
+static const int W_MAX[2] = {EXT_MAX_X_PLUS_Y, EXT_MAX_X_MIN_Y};
+
+static inline void extreme_update(long long* best, long* idx, int d,
+                                  long long key, long i) {
+  if (key > best[d] || (key == best[d] && i < idx[d])) {
+    best[d] = key;
+    idx[d] = i;
+  }
+}
+
+/* fold the L lanes of the SIMD trackers into best/idx */
+static void extremes_reduce(int L, const int* vmin, const int* vmini,
+                            const int* vmax, const int* vmaxi,
+                            const int* wmin, const int* wmini,
+                            const int* wmax, const int* wmaxi,
+                            long long* best, long* idx) {
+  for (int l = 0; l < L; l++) {
+    int s = l & 1;
+    extreme_update(best, idx, V_MIN[s], -(long long) vmin[l], vmini[l]);
+    extreme_update(best, idx, V_MAX[s], vmax[l], vmaxi[l]);
+    extreme_update(best, idx, W_MIN[s], -(long long) wmin[l], wmini[l]);
+    extreme_update(best, idx, W_MAX[s], wmax[l], wmaxi[l]);
+  }
+}
+
+/* scan p[start..n) into best/idx */
+static void extremes_tail(const point2D* p, long start, long n,
+                          long long* best, long* idx) {
+  long long key[NB_EXTREMES];
+  for (long i = start; i < n; i++) {
+    extreme_keys(p[i], key);
+    for (int d = 0; d < NB_EXTREMES; d++) {
+      if (key[d] > best[d]) {
+        best[d] = key[d];
+        idx[d] = i;
+      }
+    }
+  }
+}
+
+
+/* **************************************** */
+/* scalar */
+static void orient_scalar(point2D a, point2D b, const point2D* c, long n,
+                          long long* out) {
+  for (long i = 0; i < n; i++) {
+    out[i] = orient2D(a, b, c[i]);
+  }
+}
+
+static long prefilter_scalar(const point2D* p, long n, const point2D* poly,
+                             int k, point2D* out) {
+  long m = 0;
+  for (long i = 0; i < n; i++) {
+    point2D q = p[i];
+    int inside = 1;
+    for (int e = 0; e < k && inside; e++) {
+      inside = orient2D(poly[e], poly[(e + 1) % k], q) > 0;
+    }
+    if (!inside) {
+      out[m++] = q;
+    }
+  }
+  return m;
+}
+
+static void extremes_scalar(const point2D* p, long n, long* idx) {
+  long long best[NB_EXTREMES];
+  extreme_keys(p[0], best);
+  for (int d = 0; d < NB_EXTREMES; d++) {
+    idx[d] = 0;
+  }
+  extremes_tail(p, 1, n, best, idx);
+}
+
+
+/* the packed prefilter has a single body, compiled for each ISA by
+   inlining it into functions with different target attributes; the
+   compiler vectorizes it. Packed coordinates are < 2^16, so the
+   orientations are exact in double. The polygon is padded to 8 edges
+   with edges every point is inside of (0 > -1) so the inner loop has
+   a fixed count */
+__attribute__((always_inline))
+static inline void inside_packed_body(const uint32_t* k, long n,
+                                      const uint32_t* poly, int m,
+                                      unsigned char* inside) {
+  assert(m >= 3 && m <= 8);
+  double ax[8], ay[8], ex[8], ey[8], c[8];
+  for (int e = 0; e < 8; e++) {
+    uint32_t a = poly[e % m], b = poly[(e + 1) % m];
+    ax[e] = (int) (a >> 16);
+    ay[e] = (int) (a & 0xFFFF);
+    ex[e] = (e < m) ? (int) (b >> 16) - ax[e] : 0;
+    ey[e] = (e < m) ? (int) (b & 0xFFFF) - ay[e] : 0;
+    c[e] = (e < m) ? 0 : -1;
+  }
+  for (long i = 0; i < n; i++) {
+    double x = (int) (k[i] >> 16), y = (int) (k[i] & 0xFFFF);
+    int in = 1;
+    for (int e = 0; e < 8; e++) {
+      in &= ex[e] * (y - ay[e]) - (x - ax[e]) * ey[e] > c[e];
+    }
+    inside[i] = in;
+  }
+}
+
+static void inside_packed_scalar(const uint32_t* k, long n,
+                                 const uint32_t* poly, int m,
+                                 unsigned char* inside) {
+  inside_packed_body(k, n, poly, m, inside);
+}
+
+
+#ifdef HAVE_X86
+/* **************************************** */
+/* the SIMD variants all work on points as 64-bit lanes (x in the low
+   32 bits, y in the high ones). For an edge ab and a point c:
+   D = c - a in 32-bit lanes (exact, |coordinates| < 2^30), then
+   orient = dy * (bx - ax) - dx * (by - ay) with mul_epi32, which
+   multiplies the signed low halves of the 64-bit lanes into 64 bits */
+static inline long long pack_point(point2D a) {
+  return (long long) (((uint64_t) (uint32_t) a.y << 32) | (uint32_t) a.x);
+}
+
+typedef struct {
+  long long a, kx, ky;  //a packed, by - ay, bx - ax
+} EdgeConst;
+
+static inline EdgeConst edge_const(point2D a, point2D b) {
+  EdgeConst c = {pack_point(a), (long long) b.y - a.y, (long long) b.x - a.x};
+  return c;
+}
+
+
+/* **************************************** */
+/* SSE4.2: 2 points per vector (mul_epi32 is SSE4.1, cmpgt_epi64 is
+   SSE4.2) */
+__attribute__((target("sse4.2")))
+static inline __m128i orient_vec_sse42(__m128i c, __m128i a, __m128i kx,
+                                       __m128i ky) {
+  __m128i d = _mm_sub_epi32(c, a);
+  return _mm_sub_epi64(_mm_mul_epi32(_mm_srli_epi64(d, 32), ky),
+                       _mm_mul_epi32(d, kx));
+}
+
+__attribute__((target("sse4.2")))
+static void orient_sse42(point2D a, point2D b, const point2D* c, long n,
+                         long long* out) {
+  EdgeConst e = edge_const(a, b);
+  __m128i va = _mm_set1_epi64x(e.a);
+  __m128i kx = _mm_set1_epi64x(e.kx), ky = _mm_set1_epi64x(e.ky);
+  long i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (c + i));
+    _mm_storeu_si128((__m128i*) (out + i), orient_vec_sse42(v, va, kx, ky));
+  }
+  orient_scalar(a, b, c + i, n - i, out + i);
+}
+
+__attribute__((target("sse4.2")))
+static long prefilter_sse42(const point2D* p, long n, const point2D* poly,
+                            int k, point2D* out) {
+  assert(k <= 8);
+  __m128i va[8], kx[8], ky[8];
+  for (int j = 0; j < k; j++) {
+    EdgeConst e = edge_const(poly[j], poly[(j + 1) % k]);
+    va[j] = _mm_set1_epi64x(e.a);
+    kx[j] = _mm_set1_epi64x(e.kx);
+    ky[j] = _mm_set1_epi64x(e.ky);
+  }
+  __m128i zero = _mm_setzero_si128();
+  long m = 0, i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (p + i));
+    __m128i in = _mm_set1_epi64x(-1);
+    for (int j = 0; j < k; j++) {
+      __m128i o = orient_vec_sse42(v, va[j], kx[j], ky[j]);
+      in = _mm_and_si128(in, _mm_cmpgt_epi64(o, zero));
+    }
+    int mask = _mm_movemask_pd(_mm_castsi128_pd(in));
+    point2D q0 = p[i], q1 = p[i + 1];
+    if (!(mask & 1)) out[m++] = q0;
+    if (!(mask & 2)) out[m++] = q1;
+  }
+  return m + prefilter_scalar(p + i, n - i, poly, k, out + m);
+}
+
+__attribute__((target("sse4.2")))
+static void extremes_sse42(const point2D* p, long n, long* idx) {
+  if (n < 2) {
+    extremes_scalar(p, n, idx);
+    return;
+  }
+  __m128i v = _mm_loadu_si128((const __m128i*) p);
+  __m128i sw = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+  __m128i w = _mm_blend_epi16(_mm_add_epi32(v, sw), _mm_sub_epi32(sw, v), 0xCC);
+  __m128i lane = _mm_set_epi32(1, 1, 0, 0), step = _mm_set1_epi32(2);
+  __m128i vmin = v, vmax = v, wmin = w, wmax = w;
+  __m128i vmini = lane, vmaxi = lane, wmini = lane, wmaxi = lane;
+  long i = 2;
+  for (; i + 2 <= n; i += 2) {
+    lane = _mm_add_epi32(lane, step);
+    v = _mm_loadu_si128((const __m128i*) (p + i));
+    sw = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    //odd lanes: swapped - v = x - y there
+    w = _mm_blend_epi16(_mm_add_epi32(v, sw), _mm_sub_epi32(sw, v), 0xCC);
+    __m128i lt = _mm_cmpgt_epi32(vmin, v), gt = _mm_cmpgt_epi32(v, vmax);
+    vmin = _mm_blendv_epi8(vmin, v, lt);
+    vmini = _mm_blendv_epi8(vmini, lane, lt);
+    vmax = _mm_blendv_epi8(vmax, v, gt);
+    vmaxi = _mm_blendv_epi8(vmaxi, lane, gt);
+    lt = _mm_cmpgt_epi32(wmin, w);
+    gt = _mm_cmpgt_epi32(w, wmax);
+    wmin = _mm_blendv_epi8(wmin, w, lt);
+    wmini = _mm_blendv_epi8(wmini, lane, lt);
+    wmax = _mm_blendv_epi8(wmax, w, gt);
+    wmaxi = _mm_blendv_epi8(wmaxi, lane, gt);
+  }
+  int t[8][4];
+  _mm_storeu_si128((__m128i*) t[0], vmin);
+  _mm_storeu_si128((__m128i*) t[1], vmini);
+  _mm_storeu_si128((__m128i*) t[2], vmax);
+  _mm_storeu_si128((__m128i*) t[3], vmaxi);
+  _mm_storeu_si128((__m128i*) t[4], wmin);
+  _mm_storeu_si128((__m128i*) t[5], wmini);
+  _mm_storeu_si128((__m128i*) t[6], wmax);
+  _mm_storeu_si128((__m128i*) t[7], wmaxi);
+  long long best[NB_EXTREMES];
+  for (int d = 0; d < NB_EXTREMES; d++) {
+    best[d] = -(1LL << 62);
+    idx[d] = n;
+  }
+  extremes_reduce(4, t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], best, idx);
+  extremes_tail(p, i, n, best, idx);
+}
+
+
+__attribute__((target("sse4.2")))
+static void inside_packed_sse42(const uint32_t* k, long n,
+                                const uint32_t* poly, int m,
+                                unsigned char* inside) {
+  inside_packed_body(k, n, poly, m, inside);
+}
+
+
+/* **************************************** */
+/* AVX2: 4 points per vector */
+__attribute__((target("avx2")))
+static inline __m256i orient_vec_avx2(__m256i c, __m256i a, __m256i kx,
+                                      __m256i ky) {
+  __m256i d = _mm256_sub_epi32(c, a);
+  return _mm256_sub_epi64(_mm256_mul_epi32(_mm256_srli_epi64(d, 32), ky),
+                          _mm256_mul_epi32(d, kx));
+}
+
+__attribute__((target("avx2")))
+static void orient_avx2(point2D a, point2D b, const point2D* c, long n,
+                        long long* out) {
+  EdgeConst e = edge_const(a, b);
+  __m256i va = _mm256_set1_epi64x(e.a);
+  __m256i kx = _mm256_set1_epi64x(e.kx), ky = _mm256_set1_epi64x(e.ky);
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (c + i));
+    _mm256_storeu_si256((__m256i*) (out + i), orient_vec_avx2(v, va, kx, ky));
+  }
+  orient_scalar(a, b, c + i, n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+static long prefilter_avx2(const point2D* p, long n, const point2D* poly,
+                           int k, point2D* out) {
+  assert(k <= 8);
+  __m256i va[8], kx[8], ky[8];
+  for (int j = 0; j < k; j++) {
+    EdgeConst e = edge_const(poly[j], poly[(j + 1) % k]);
+    va[j] = _mm256_set1_epi64x(e.a);
+    kx[j] = _mm256_set1_epi64x(e.kx);
+    ky[j] = _mm256_set1_epi64x(e.ky);
+  }
+  __m256i zero = _mm256_setzero_si256();
+  long m = 0, i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (p + i));
+    __m256i in = _mm256_set1_epi64x(-1);
+    for (int j = 0; j < k; j++) {
+      __m256i o = orient_vec_avx2(v, va[j], kx[j], ky[j]);
+      in = _mm256_and_si256(in, _mm256_cmpgt_epi64(o, zero));
+    }
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(in));
+    if (mask == 15) {
+      continue;
+    }
+    //the points are read before any is written, so out may be p
+    point2D q[4] = {p[i], p[i + 1], p[i + 2], p[i + 3]};
+    for (int l = 0; l < 4; l++) {
+      if (!(mask & (1 << l))) out[m++] = q[l];
+    }
+  }
+  return m + prefilter_scalar(p + i, n - i, poly, k, out + m);
+}
+
+__attribute__((target("avx2")))
+static void extremes_avx2(const point2D* p, long n, long* idx) {
+  if (n < 4) {
+    extremes_scalar(p, n, idx);
+    return;
+  }
+  __m256i v = _mm256_loadu_si256((const __m256i*) p);
+  __m256i sw = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+  __m256i w = _mm256_blend_epi32(_mm256_add_epi32(v, sw),
+                                 _mm256_sub_epi32(sw, v), 0xAA);
+  __m256i lane = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+  __m256i step = _mm256_set1_epi32(4);
+  __m256i vmin = v, vmax = v, wmin = w, wmax = w;
+  __m256i vmini = lane, vmaxi = lane, wmini = lane, wmaxi = lane;
+  long i = 4;
+  for (; i + 4 <= n; i += 4) {
+    lane = _mm256_add_epi32(lane, step);
+    v = _mm256_loadu_si256((const __m256i*) (p + i));
+    sw = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    w = _mm256_blend_epi32(_mm256_add_epi32(v, sw), _mm256_sub_epi32(sw, v), 0xAA);
+    __m256i lt = _mm256_cmpgt_epi32(vmin, v), gt = _mm256_cmpgt_epi32(v, vmax);
+    vmin = _mm256_blendv_epi8(vmin, v, lt);
+    vmini = _mm256_blendv_epi8(vmini, lane, lt);
+    vmax = _mm256_blendv_epi8(vmax, v, gt);
+    vmaxi = _mm256_blendv_epi8(vmaxi, lane, gt);
+    lt = _mm256_cmpgt_epi32(wmin, w);
+    gt = _mm256_cmpgt_epi32(w, wmax);
+    wmin = _mm256_blendv_epi8(wmin, w, lt);
+    wmini = _mm256_blendv_epi8(wmini, lane, lt);
+    wmax = _mm256_blendv_epi8(wmax, w, gt);
+    wmaxi = _mm256_blendv_epi8(wmaxi, lane, gt);
+  }
+  int t[8][8];
+  _mm256_storeu_si256((__m256i*) t[0], vmin);
+  _mm256_storeu_si256((__m256i*) t[1], vmini);
+  _mm256_storeu_si256((__m256i*) t[2], vmax);
+  _mm256_storeu_si256((__m256i*) t[3], vmaxi);
+  _mm256_storeu_si256((__m256i*) t[4], wmin);
+  _mm256_storeu_si256((__m256i*) t[5], wmini);
+  _mm256_storeu_si256((__m256i*) t[6], wmax);
+  _mm256_storeu_si256((__m256i*) t[7], wmaxi);
+  long long best[NB_EXTREMES];
+  for (int d = 0; d < NB_EXTREMES; d++) {
+    best[d] = -(1LL << 62);
+    idx[d] = n;
+  }
+  extremes_reduce(8, t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], best, idx);
+  extremes_tail(p, i, n, best, idx);
+}
+
+
+__attribute__((target("avx2")))
+static void inside_packed_avx2(const uint32_t* k, long n,
+                               const uint32_t* poly, int m,
+                               unsigned char* inside) {
+  inside_packed_body(k, n, poly, m, inside);
+}
+
+
+/* **************************************** */
+/* AVX-512: 8 points per vector, with mask compares and compress
+   stores. (gcc 12 warns about an uninitialized variable inside its
+   own avx512fintrin.h set1/setzero; that is a false positive) */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static inline __m512i orient_vec_avx512(__m512i c, __m512i a, __m512i kx,
+                                        __m512i ky) {
+  __m512i d = _mm512_sub_epi32(c, a);
+  return _mm512_sub_epi64(_mm512_mul_epi32(_mm512_srli_epi64(d, 32), ky),
+                          _mm512_mul_epi32(d, kx));
+}
+
+__attribute__((target("avx512f")))
+static void orient_avx512(point2D a, point2D b, const point2D* c, long n,
+                          long long* out) {
+  EdgeConst e = edge_const(a, b);
+  __m512i va = _mm512_set1_epi64(e.a);
+  __m512i kx = _mm512_set1_epi64(e.kx), ky = _mm512_set1_epi64(e.ky);
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512i v = _mm512_loadu_si512((const void*) (c + i));
+    _mm512_storeu_si512((void*) (out + i), orient_vec_avx512(v, va, kx, ky));
+  }
+  orient_scalar(a, b, c + i, n - i, out + i);
+}
+
+__attribute__((target("avx512f")))
+static long prefilter_avx512(const point2D* p, long n, const point2D* poly,
+                             int k, point2D* out) {
+  assert(k <= 8);
+  __m512i va[8], kx[8], ky[8];
+  for (int j = 0; j < k; j++) {
+    EdgeConst e = edge_const(poly[j], poly[(j + 1) % k]);
+    va[j] = _mm512_set1_epi64(e.a);
+    kx[j] = _mm512_set1_epi64(e.kx);
+    ky[j] = _mm512_set1_epi64(e.ky);
+  }
+  __m512i zero = _mm512_setzero_si512();
+  long m = 0, i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512i v = _mm512_loadu_si512((const void*) (p + i));
+    __mmask8 in = 0xFF;
+    for (int j = 0; j < k; j++) {
+      __m512i o = orient_vec_avx512(v, va[j], kx[j], ky[j]);
+      in = _mm512_mask_cmpgt_epi64_mask(in, o, zero);
+    }
+    //m <= i, so with out == p this only overwrites points of v
+    __mmask8 keep = (__mmask8) ~in;
+    _mm512_mask_compressstoreu_epi64((void*) (out + m), keep, v);
+    m += __builtin_popcount(keep);
+  }
+  return m + prefilter_scalar(p + i, n - i, poly, k, out + m);
+}
+
+__attribute__((target("avx512f")))
+static void extremes_avx512(const point2D* p, long n, long* idx) {
+  if (n < 8) {
+    extremes_scalar(p, n, idx);
+    return;
+  }
+  const __mmask16 odd = 0xAAAA;
+  __m512i v = _mm512_loadu_si512((const void*) p);
+  __m512i sw = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
+  __m512i w = _mm512_mask_blend_epi32(odd, _mm512_add_epi32(v, sw),
+                                      _mm512_sub_epi32(sw, v));
+  __m512i lane = _mm512_set_epi32(7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+  __m512i step = _mm512_set1_epi32(8);
+  __m512i vmin = v, vmax = v, wmin = w, wmax = w;
+  __m512i vmini = lane, vmaxi = lane, wmini = lane, wmaxi = lane;
+  long i = 8;
+  for (; i + 8 <= n; i += 8) {
+    lane = _mm512_add_epi32(lane, step);
+    v = _mm512_loadu_si512((const void*) (p + i));
+    sw = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
+    w = _mm512_mask_blend_epi32(odd, _mm512_add_epi32(v, sw), _mm512_sub_epi32(sw, v));
+    __mmask16 lt = _mm512_cmpgt_epi32_mask(vmin, v), gt = _mm512_cmpgt_epi32_mask(v, vmax);
+    vmin = _mm512_mask_mov_epi32(vmin, lt, v);
+    vmini = _mm512_mask_mov_epi32(vmini, lt, lane);
+    vmax = _mm512_mask_mov_epi32(vmax, gt, v);
+    vmaxi = _mm512_mask_mov_epi32(vmaxi, gt, lane);
+    lt = _mm512_cmpgt_epi32_mask(wmin, w);
+    gt = _mm512_cmpgt_epi32_mask(w, wmax);
+    wmin = _mm512_mask_mov_epi32(wmin, lt, w);
+    wmini = _mm512_mask_mov_epi32(wmini, lt, lane);
+    wmax = _mm512_mask_mov_epi32(wmax, gt, w);
+    wmaxi = _mm512_mask_mov_epi32(wmaxi, gt, lane);
+  }
+  int t[8][16];
+  _mm512_storeu_si512((void*) t[0], vmin);
+  _mm512_storeu_si512((void*) t[1], vmini);
+  _mm512_storeu_si512((void*) t[2], vmax);
+  _mm512_storeu_si512((void*) t[3], vmaxi);
+  _mm512_storeu_si512((void*) t[4], wmin);
+  _mm512_storeu_si512((void*) t[5], wmini);
+  _mm512_storeu_si512((void*) t[6], wmax);
+  _mm512_storeu_si512((void*) t[7], wmaxi);
+  long long best[NB_EXTREMES];
+  for (int d = 0; d < NB_EXTREMES; d++) {
+    best[d] = -(1LL << 62);
+    idx[d] = n;
+  }
+  extremes_reduce(16, t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], best, idx);
+  extremes_tail(p, i, n, best, idx);
+}
+__attribute__((target("avx512f,avx512dq,avx512vl,avx512bw")))
+static void inside_packed_avx512(const uint32_t* k, long n,
+                                 const uint32_t* poly, int m,
+                                 unsigned char* inside) {
+  inside_packed_body(k, n, poly, m, inside);
+}
+#pragma GCC diagnostic pop
+#endif //HAVE_X86
+
+
+/* **************************************** */
+/* dispatch */
+static const char* isa_names[NB_ISAS] = {
+  "scalar", "sse4.2", "avx2", "avx512"
+};
+
+static const HullKernels all_kernels[NB_ISAS] = {
+  {ISA_SCALAR, "scalar", orient_scalar, prefilter_scalar, extremes_scalar,
+   inside_packed_scalar},
+#ifdef HAVE_X86
+  {ISA_SSE42, "sse4.2", orient_sse42, prefilter_sse42, extremes_sse42,
+   inside_packed_sse42},
+  {ISA_AVX2, "avx2", orient_avx2, prefilter_avx2, extremes_avx2,
+   inside_packed_avx2},
+  {ISA_AVX512, "avx512", orient_avx512, prefilter_avx512, extremes_avx512,
+   inside_packed_avx512},
+#endif
+};
+
+static int isa_supported(int isa) {
+#ifdef HAVE_X86
+  switch (isa) {
+  case ISA_SCALAR: return 1;
+  case ISA_SSE42: return __builtin_cpu_supports("sse4.2");
+  case ISA_AVX2: return __builtin_cpu_supports("avx2");
+  case ISA_AVX512:
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")
+      && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw");
+  }
+  return 0;
+#else
+  return isa == ISA_SCALAR;
+#endif
+}
+
+int hull_isa_by_name(const char* name) {
+  for (int i = 0; i < NB_ISAS; i++) {
+    if (strcmp(name, isa_names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const HullKernels* hull_kernels_isa(int isa) {
+  if (isa < 0 || isa >= NB_ISAS || !isa_supported(isa)) {
+    return NULL;
+  }
+  return &all_kernels[isa];
+}
+
+static const HullKernels* pick_kernels() {
+  const char* env = getenv("HULL_ISA");
+  if (env) {
+    const HullKernels* k = hull_kernels_isa(hull_isa_by_name(env));
+    if (k) {
+      return k;
+    }
+    fprintf(stderr, "HULL_ISA=%s is not supported here, ignored\n", env);
+  }
+  for (int isa = NB_ISAS - 1; isa > 0; isa--) {
+    if (isa_supported(isa)) {
+      return &all_kernels[isa];
+    }
+  }
+  return &all_kernels[ISA_SCALAR];
+}
+
+const HullKernels* hull_kernels() {
+  static const HullKernels* k = pick_kernels();
+  return k;
+}
+
+
+/* **************************************** */
+int hull_octagon(const point2D* p, long n, point2D* poly,
+                 const HullKernels* k) {
+  if (k == NULL) {
+    k = hull_kernels();
+  }
+  if (n == 0) {
+    return 0;
+  }
+  long idx[NB_EXTREMES];
+  k->extremes(p, n, idx);
+  int m = 0;
+  for (int d = 0; d < NB_EXTREMES; d++) {
+    point2D q = p[idx[d]];
+    if (m == 0 || q.x != poly[m-1].x || q.y != poly[m-1].y) {
+      poly[m++] = q;
+    }
+  }
+  while (m > 1 && poly[m-1].x == poly[0].x && poly[m-1].y == poly[0].y) {
+    m--;
+  }
+  return m;
+}
+
+vector<point2D> filtered_hull(const vector<point2D>& p,
+                              const HullKernels* k) {
+  if (k == NULL) {
+    k = hull_kernels();
+  }
+  long n = p.size();
+  if (n == 0) {
+    return vector<point2D>();
+  }
+
+  point2D poly[NB_EXTREMES];
+  int m = hull_octagon(&p[0], n, poly, k);
+  vector<point2D> s(n);
+  long left = n;
+  if (m >= 3) {
+    left = k->prefilter(&p[0], n, poly, m, &s[0]);
+  } else {
+    copy(p.begin(), p.end(), s.begin());
+  }
+  s.resize(left);
+  sort(s.begin(), s.end(), xy_less);
+  return monotone_chain_sorted(s);
+}
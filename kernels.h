@@ -0,0 +1,90 @@
+#ifndef __kernels_h
+#define __kernels_h
+
+#include "geom.h"
+#include <stdint.h>
+
+/* Batch geometry kernels with runtime CPU dispatch.
+
+   Every kernel is compiled in several ISA variants (scalar, SSE4.2,
+   AVX2, AVX-512) with per-function target attributes, so the build
+   needs no -march flag and the binary runs on any x86-64. The best
+   variant the CPU supports is picked once, at the first call of
+   hull_kernels(), from CPUID; $HULL_ISA (scalar, sse4.2, avx2,
+   avx512) forces one, e.g. for benchmarking.
+
+   All variants give identical results: the orientations are computed
+   exactly in 64 bits, like orient2D, so coordinates must have
+   absolute value < 2^30. The AVX-512 variant needs the F, DQ, VL and
+   BW subsets.
+*/
+
+enum hull_isa {
+  ISA_SCALAR = 0,
+  ISA_SSE42,
+  ISA_AVX2,
+  ISA_AVX512,
+  NB_ISAS
+};
+
+/* the extreme-point directions, in ccw order of their normals; an
+   extremes kernel sets idx[d] to the first index of a point extreme
+   in direction d */
+enum extreme_direction {
+  EXT_MIN_Y = 0,     //bottom
+  EXT_MAX_X_MIN_Y,   //bottom right: largest x - y
+  EXT_MAX_X,         //right
+  EXT_MAX_X_PLUS_Y,  //top right: largest x + y
+  EXT_MAX_Y,         //top
+  EXT_MIN_X_MIN_Y,   //top left: smallest x - y
+  EXT_MIN_X,         //left
+  EXT_MIN_X_PLUS_Y,  //bottom left: smallest x + y
+  NB_EXTREMES
+};
+
+typedef struct _hull_kernels {
+  int isa;
+  const char* name;
+
+  /* out[i] = orient2D(a, b, c[i]) for i in [0, n) */
+  void (*orient)(point2D a, point2D b, const point2D* c, long n,
+                 long long* out);
+
+  /* copy to out, in order, the points of p[0..n) that are not
+     strictly inside the ccw convex polygon poly[0..k), k <= 8, and
+     return how many. out may be p. */
+  long (*prefilter)(const point2D* p, long n, const point2D* poly, int k,
+                    point2D* out);
+
+  /* set idx[0..NB_EXTREMES) (see extreme_direction); n > 0 */
+  void (*extremes)(const point2D* p, long n, long* idx);
+
+  /* the prefilter test for packed keys (see packed.h): set inside[i]
+     to 1 if key k[i] is strictly inside the ccw convex polygon of
+     keys poly[0..m), 3 <= m <= 8, and to 0 otherwise */
+  void (*inside_packed)(const uint32_t* k, long n, const uint32_t* poly,
+                        int m, unsigned char* inside);
+} HullKernels;
+
+/* the kernels picked at startup */
+const HullKernels* hull_kernels();
+
+/* the kernels for one ISA, or NULL if the CPU does not support it */
+const HullKernels* hull_kernels_isa(int isa);
+
+/* the ISA with the given name (as in $HULL_ISA), or -1 */
+int hull_isa_by_name(const char* name);
+
+/* set poly to the ccw octagon of the extreme points of p[0..n) (see
+   extreme_direction), without repeated vertices, and return its
+   number of vertices (< 3 if it is degenerate) */
+int hull_octagon(const point2D* p, long n, point2D* poly,
+                 const HullKernels* k = NULL);
+
+/* compute the hull of p like monotone_chain, after dropping the
+   points strictly inside the octagon of the extreme points
+   (Akl-Toussaint) with the kernels k (NULL: hull_kernels()) */
+vector<point2D> filtered_hull(const vector<point2D>& p,
+                              const HullKernels* k = NULL);
+
+#endif
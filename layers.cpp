@@ -0,0 +1,261 @@
+#include "layers.h"
+#include <assert.h>
+#include <limits.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+/* The hull tree: a complete binary tree over the distinct points in
+   sorted order, leaves N..N+m-1. Node v stores how many of its points
+   are alive and, when both children have some, the bridge of its
+   upper chain: the last point of the left child's chain and the first
+   point of the right child's chain that are on the chain of v. The
+   chain of v is then the left chain up to the bridge followed by the
+   right chain from it. Collinear points are kept, so the chains hold
+   every point on the boundary. The lower chain is the upper chain
+   with y negated, side 1 below.
+
+   Bridges are found in O(lg n) by walking down both children at once
+   (Overmars and van Leeuwen's case analysis, on the bridges of the
+   nodes instead of a search on stored chains), so removing a point
+   costs O(lg^2 n). */
+typedef struct _hull_node {
+  int count;         //alive points under the node
+  int bl[2], br[2];  //bridges of the upper and lower chains
+} HullNode;
+
+typedef struct _tree_point {
+  point2D q;
+  long long X;       //sheared x, see shear()
+} TreePoint;
+
+typedef struct _hull_tree {
+  vector<TreePoint> p;   //the distinct points, sorted
+  vector<HullNode> node;
+  long N;
+} HullTree;
+
+/* X = x 2^31 + y orders the points as xy_less does, with no two
+   equal, and the shear has a positive determinant: orientations keep
+   their sign. In these coordinates no chain edge is vertical */
+static inline long long shear(point2D a) {
+  return (long long) a.x * (1LL << 31) + a.y;
+}
+
+static inline long long orient_side(const HullTree& t, int s, long a, long b,
+                                    long c) {
+  long long o = orient2D(t.p[a].q, t.p[b].q, t.p[c].q);
+  return s ? -o : o;
+}
+
+/* the sign of the slope of cd minus the slope of ab */
+static inline long long slope_cmp(const HullTree& t, int s, long a, long b,
+                                  long c, long d) {
+  point2D pa = t.p[a].q, pb = t.p[b].q, pc = t.p[c].q, pd = t.p[d].q;
+  long long o = ((long long) pb.x - pa.x) * ((long long) pd.y - pc.y)
+    - ((long long) pb.y - pa.y) * ((long long) pd.x - pc.x);
+  return s ? -o : o;
+}
+
+/* go down from v, which has alive points, while one child is empty */
+static inline long solid(const HullTree& t, long v) {
+  while (v < t.N && (t.node[2*v].count == 0 || t.node[2*v+1].count == 0)) {
+    v = t.node[2*v].count ? 2*v : 2*v+1;
+  }
+  return v;
+}
+
+/* the bridge of v, both of whose children have alive points. al and
+   be are nodes of the left and right child holding the two ends. At
+   each step, with the bridges (a1,a2) of al and (b1,b2) of be, and m
+   the sheared x of the last point under the left child, compare the
+   lines of the two bridges at x = m: the side whose line is higher
+   there, or the slopes, tell which half of al or be keeps its end */
+static void find_bridge(HullTree& t, int s, long v) {
+  long f = 2*v+1;
+  while (f < t.N) {
+    f = 2*f;
+  }
+  __int128 m = t.p[f - t.N - 1].X;
+
+  long al = 2*v, be = 2*v+1;
+  for (;;) {
+    al = solid(t, al);
+    be = solid(t, be);
+    if (al >= t.N && be >= t.N) {
+      break;
+    }
+    if (al >= t.N) {
+      //be moves right if the end a is above the line of its bridge
+      long a = al - t.N;
+      be = 2*be + (orient_side(t, s, t.node[be].bl[s], t.node[be].br[s], a) > 0);
+      continue;
+    }
+    long a1 = t.node[al].bl[s], a2 = t.node[al].br[s];
+    if (be >= t.N) {
+      al = 2*al + (orient_side(t, s, a1, a2, be - t.N) <= 0);
+      continue;
+    }
+    long b1 = t.node[be].bl[s], b2 = t.node[be].br[s];
+
+    //the point of line a1a2 at x = m is above line b1b2 when e > 0
+    __int128 e = (t.p[a2].X - m) * (__int128) orient_side(t, s, b1, b2, a1)
+      + (m - t.p[a1].X) * (__int128) orient_side(t, s, b1, b2, a2);
+    long long c = slope_cmp(t, s, a1, a2, b1, b2);
+    if (c >= 0) {
+      //a1a2 is not steeper downwards than b1b2
+      if (e < 0 || (e == 0 && c > 0)) {
+        al = 2*al;
+      } else if (e > 0) {
+        be = 2*be+1;
+      } else {
+        al = 2*al+1;
+        be = 2*be;
+      }
+    } else {
+      if (e > 0) {
+        al = 2*al+1;
+      } else if (e < 0) {
+        be = 2*be;
+      } else {
+        al = 2*al+1;
+        be = 2*be;
+      }
+    }
+  }
+  t.node[v].bl[s] = al - t.N;
+  t.node[v].br[s] = be - t.N;
+}
+
+/* recount v and find its bridges again. Points are only removed, so
+   the chains only go down: a bridge whose two ends are left is still
+   above every point, and still the bridge */
+static void update(HullTree& t, long v) {
+  t.node[v].count = t.node[2*v].count + t.node[2*v+1].count;
+  if (t.node[2*v].count && t.node[2*v+1].count) {
+    for (int s = 0; s < 2; s++) {
+      if (t.node[v].bl[s] < 0 || !t.node[t.N + t.node[v].bl[s]].count
+          || !t.node[t.N + t.node[v].br[s]].count) {
+        find_bridge(t, s, v);
+      }
+    }
+  }
+}
+
+/* append the points of the chain of v with index in [lo, hi] */
+static void chain(const HullTree& t, int s, long v, long lo, long hi,
+                  vector<long>& out) {
+  v = solid(t, v);
+  if (v >= t.N) {
+    long i = v - t.N;
+    if (lo <= i && i <= hi) {
+      out.push_back(i);
+    }
+    return;
+  }
+  long a = t.node[v].bl[s], b = t.node[v].br[s];
+  if (lo <= a) {
+    chain(t, s, 2*v, lo, min(hi, a), out);
+  }
+  if (hi >= b) {
+    chain(t, s, 2*v+1, max(lo, b), hi, out);
+  }
+}
+
+
+/* **************************************** */
+int convex_layers(const vector<point2D>& p, int* layer) {
+  long n = p.size();
+  if (n == 0) {
+    return 0;
+  }
+
+  //sort once
+  vector<long> order(n);
+  for (long i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  sort(order.begin(), order.end(), [&p](long a, long b) {
+    return xy_less(p[a], p[b]) || (!xy_less(p[b], p[a]) && a < b);
+  });
+
+  //collapse repeated points: q[] holds the distinct points in sorted
+  //order, and the tree works on their indices
+  vector<point2D> q;
+  q.reserve(n);
+  for (long j = 0; j < n; j++) {
+    point2D a = p[order[j]];
+    if (q.size() == 0 || xy_less(q.back(), a)) {
+      q.push_back(a);
+    }
+  }
+  long m = q.size();
+  assert(m < INT_MAX);
+
+  HullTree t;
+  t.N = 1;
+  while (t.N < m) {
+    t.N *= 2;
+  }
+  t.p.resize(m);
+  for (long i = 0; i < m; i++) {
+    t.p[i].q = q[i];
+    t.p[i].X = shear(q[i]);
+  }
+  HullNode empty = {0, {-1, -1}, {-1, -1}};
+  t.node.assign(2 * t.N, empty);
+  for (long i = 0; i < m; i++) {
+    t.node[t.N + i].count = 1;
+  }
+  for (long v = t.N - 1; v >= 1; v--) {
+    update(t, v);
+  }
+
+  //peel: a layer is the upper and lower chain of the root. Removing
+  //it updates the nodes above its points, children first
+  vector<int> qlayer(m, -1);
+  vector<long> on, dirty;
+  vector<char> mark(t.N, 0);
+  int l = 0;
+  while (t.node[1].count > 0) {
+    on.clear();
+    chain(t, 0, 1, 0, m - 1, on);
+    chain(t, 1, 1, 0, m - 1, on);
+    dirty.clear();
+    for (size_t j = 0; j < on.size(); j++) {
+      long i = on[j];
+      if (qlayer[i] >= 0) {
+        continue;  //an end of both chains
+      }
+      qlayer[i] = l;
+      t.node[t.N + i].count = 0;
+      for (long v = (t.N + i) / 2; v >= 1 && !mark[v]; v /= 2) {
+        mark[v] = 1;
+        dirty.push_back(v);
+      }
+    }
+    sort(dirty.begin(), dirty.end(), greater<long>());
+    for (size_t j = 0; j < dirty.size(); j++) {
+      update(t, dirty[j]);
+      mark[dirty[j]] = 0;
+    }
+    l++;
+  }
+
+  //repeated points take the layer of their distinct point
+  long r = -1;
+  for (long j = 0; j < n; j++) {
+    if (r < 0 || xy_less(q[r], p[order[j]])) {
+      r++;
+    }
+    layer[order[j]] = qlayer[r];
+  }
+  return l;
+}
+
+int convex_layers(const vector<point2D>& p, vector<int>& layer) {
+  layer.resize(p.size());
+  return convex_layers(p, layer.size() ? &layer[0] : NULL);
+}
@@ -0,0 +1,34 @@
+#ifndef __layers_h
+#define __layers_h
+
+#include "geom.h"
+
+/* Convex layers (onion peeling).
+
+   Layer 0 is the set of points on the boundary of the hull of all
+   points, including points in the middle of an edge and repeated
+   points; layer 1 is the boundary of the hull of the remaining
+   points, and so on. The layer of a point is its depth, which is
+   what outlier ranking uses.
+
+   The points are sorted once and repeated points collapsed into one
+   entry. The upper and lower chains of the remaining points are kept
+   in a hull tree, a balanced tree over the sorted entries whose nodes
+   store the bridge between the chains of their children, and each
+   layer is read off the root and removed from the tree. Removing a
+   point costs O(lg^2 n), so the total is O(n lg^2 n) whatever the
+   number of layers; random points on a large grid have about n^(2/3)
+   of them.
+
+   All predicates are exact for coordinates of absolute value < 2^30.
+*/
+
+/* compute the convex layers of p: set layer[i] to the layer of p[i]
+   (layer must have room for p.size() entries) and return the number
+   of layers */
+int convex_layers(const vector<point2D>& p, int* layer);
+
+/* vector version; resizes layer */
+int convex_layers(const vector<point2D>& p, vector<int>& layer);
+
+#endif
@@ -0,0 +1,208 @@
+#include "melkman.h"
+#include <assert.h>
+#include <algorithm>
+
+using namespace std;
+
+static const char* order_names[NB_POINT_ORDERS] = {
+  "none", "xy", "xy-reversed", "angular"
+};
+
+const char* point_order_name(int order) {
+  assert(order >= 0 && order < NB_POINT_ORDERS);
+  return order_names[order];
+}
+
+static inline int same_point(point2D a, point2D b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+
+/* **************************************** */
+/* Melkman's algorithm. The deque d[bot..top] holds the hull of the
+   polyline so far, ccw, with d[bot] == d[top] the last vertex added.
+   Because the polyline is simple, once it is inside the hull it can
+   only leave it across one of the two edges at d[top]; so a point
+   left of (or on) both edges is skipped, and otherwise it is pushed
+   at both ends after popping the vertices it makes reflex. */
+vector<point2D> melkman_hull(const vector<point2D>& p) {
+  long n = p.size();
+  vector<point2D> h;
+  if (n == 0) {
+    return h;
+  }
+
+  //the points up to the first one off the line through the first
+  //two distinct points are collinear; their hull is the segment
+  //lo-hi
+  long j = 1;
+  while (j < n && same_point(p[j], p[0])) j++;
+  point2D lo = p[0], hi = p[0];
+  long k = 1;
+  for (; k < n; k++) {
+    if (j < n && orient2D(p[0], p[j], p[k]) != 0) {
+      break;
+    }
+    if (xy_less(p[k], lo)) lo = p[k];
+    if (xy_less(hi, p[k])) hi = p[k];
+  }
+  if (k == n) {
+    h.push_back(lo);
+    if (!same_point(lo, hi)) {
+      h.push_back(hi);
+    }
+    h = hull_canonical(h);
+    hull_close(h);
+    return h;
+  }
+
+  vector<point2D> d(2 * n + 4);
+  long bot = n + 1, top = bot + 3;
+  point2D c = p[k];
+  d[bot] = d[top] = c;
+  if (orient2D(lo, hi, c) > 0) {
+    d[bot+1] = lo;
+    d[bot+2] = hi;
+  } else {
+    d[bot+1] = hi;
+    d[bot+2] = lo;
+  }
+
+  for (long i = k + 1; i < n; i++) {
+    point2D q = p[i];
+    if (orient2D(d[top-1], d[top], q) >= 0
+        && orient2D(d[bot], d[bot+1], q) >= 0) {
+      continue;
+    }
+    while (orient2D(d[top-1], d[top], q) <= 0) top--;
+    d[++top] = q;
+    while (orient2D(d[bot], d[bot+1], q) <= 0) bot++;
+    d[--bot] = q;
+  }
+
+  h.assign(d.begin() + bot, d.begin() + top + 1);
+  h = hull_canonical(h);
+  hull_close(h);
+  return h;
+}
+
+
+/* **************************************** */
+/* 1 if a is in the half-plane of angles [0, pi) around the origin */
+static inline int upper_half(long long x, long long y) {
+  return y > 0 || (y == 0 && x > 0);
+}
+
+/* p is a star-shaped polygon around c, the centroid of a sample of
+   p, if every edge
+   turns the same way around c, or runs along a ray from c, and the
+   edges turn once around c in total. Consecutive edges along one ray
+   must all go away from c or all towards it, or the polygon would
+   overlap itself there. Each edge turns by less than pi, so the
+   turns are counted by the edges that cross from the lower to the
+   upper half-plane around c */
+static int angular_order(const vector<point2D>& p) {
+  long n = p.size();
+  if (n < 3) {
+    return 0;
+  }
+  //the centroid of a sample is enough, and does not cost a pass
+  //over p when the check fails early
+  long m = min(n, 256L);
+  long long sx = 0, sy = 0;
+  for (long i = 0; i < m; i++) {
+    sx += p[i * n / m].x;
+    sy += p[i * n / m].y;
+  }
+  long long cx = sx / m, cy = sy / m;
+
+  //start after an edge that turns, so that no run of edges along a
+  //ray wraps around the end of p
+  long first = -1;
+  for (long i = 0; i < n && first < 0; i++) {
+    point2D a = p[(i + n - 1) % n], b = p[i];
+    long long ax = a.x - cx, ay = a.y - cy, bx = b.x - cx, by = b.y - cy;
+    if (ax * by != ay * bx) {
+      first = i;
+    } else if (ax * bx + ay * by <= 0) {
+      return 0;
+    }
+  }
+  if (first < 0) {
+    return 0;
+  }
+
+  int sign = 0, radial = 0;
+  long turns = 0;
+  long long ax = p[first].x - cx, ay = p[first].y - cy;
+  for (long k = 1; k <= n; k++) {
+    point2D q = p[(first + k) % n];
+    long long bx = q.x - cx, by = q.y - cy;
+    if (bx == 0 && by == 0) {
+      return 0;
+    }
+    long long o = ax * by - ay * bx;
+    if (o == 0) {
+      if (ax * bx + ay * by <= 0) {
+        return 0;
+      }
+      long long d = (bx * bx + by * by) - (ax * ax + ay * ay);
+      if (d != 0) {
+        int r = (d > 0) ? 1 : -1;
+        if (radial == 0) {
+          radial = r;
+        } else if (r != radial) {
+          return 0;
+        }
+      }
+    } else {
+      int s = (o > 0) ? 1 : -1;
+      if (sign == 0) {
+        sign = s;
+      } else if (s != sign) {
+        return 0;
+      }
+      radial = 0;
+    }
+    if (upper_half(bx, by) && !upper_half(ax, ay)) {
+      if (++turns > 1) {
+        return 0;
+      }
+    }
+    ax = bx;
+    ay = by;
+  }
+  return turns == 1;
+}
+
+int presorted_order(const vector<point2D>& p) {
+  long n = p.size();
+  int forward = 1, backward = 1;
+  for (long i = 0; i + 1 < n && (forward || backward); i++) {
+    if (xy_less(p[i+1], p[i])) forward = 0;
+    if (xy_less(p[i], p[i+1])) backward = 0;
+  }
+  if (forward) {
+    return ORDER_XY;
+  }
+  if (backward) {
+    return ORDER_XY_REVERSED;
+  }
+  return angular_order(p) ? ORDER_ANGULAR : ORDER_NONE;
+}
+
+vector<point2D> auto_hull(const vector<point2D>& p, int* order) {
+  int o = presorted_order(p);
+  if (order) {
+    *order = o;
+  }
+  switch (o) {
+  case ORDER_XY:
+    return monotone_chain_sorted(p);
+  case ORDER_XY_REVERSED:
+    return monotone_chain_sorted(vector<point2D>(p.rbegin(), p.rend()));
+  case ORDER_ANGULAR:
+    return melkman_hull(p);
+  }
+  return monotone_chain(p);
+}
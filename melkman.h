@@ -0,0 +1,43 @@
+#ifndef __melkman_h
+#define __melkman_h
+
+#include "geom.h"
+
+/* Linear-time hulls of ordered input.
+
+   Many point sets come in boundary order: the circle, heart and
+   hemisphere generators, GPS tracks, contours. Their hull can be
+   found in O(n) without sorting: with Melkman's deque algorithm if
+   the points form a simple polyline, or with monotone_chain_sorted
+   if they are already in xy order. Whether a polyline is simple
+   cannot be checked in linear time in general, so presorted_order
+   checks two sufficient conditions in O(n), stopping at the first
+   point that breaks them; auto_hull uses it to skip the sort when it
+   can.
+*/
+
+/* return the hull of p, in the same form as monotone_chain, in O(n).
+   p[0], p[1], ... must form a simple polyline (open or closed; points
+   may repeat consecutively); otherwise the result is undefined */
+vector<point2D> melkman_hull(const vector<point2D>& p);
+
+enum point_order {
+  ORDER_NONE = 0,    //none of the below
+  ORDER_XY,          //sorted by xy_less
+  ORDER_XY_REVERSED, //sorted by xy_less, backwards
+  ORDER_ANGULAR,     //a star-shaped polygon: (cw or ccw) angularly
+                     //sorted around a point, one turn
+  NB_POINT_ORDERS
+};
+
+const char* point_order_name(int order);
+
+/* return the order of p (see point_order), in O(n). An ORDER_ANGULAR
+   set is a simple polygon, so melkman_hull applies */
+int presorted_order(const vector<point2D>& p);
+
+/* the hull of p, like monotone_chain, without sorting if p is
+   presorted. If order is not NULL it gets presorted_order(p) */
+vector<point2D> auto_hull(const vector<point2D>& p, int* order = NULL);
+
+#endif
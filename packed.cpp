@@ -0,0 +1,181 @@
+#include "packed.h"
+#include "kernels.h"
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+void packed_init(PackedPoints& pp, int ox, int oy) {
+  pp.ox = ox;
+  pp.oy = oy;
+  pp.k.clear();
+}
+
+int packed_append(PackedPoints& pp, const point2D* p, long n) {
+  for (long i = 0; i < n; i++) {
+    long dx = (long) p[i].x - pp.ox, dy = (long) p[i].y - pp.oy;
+    if (dx < 0 || dx >= PACKED_RANGE || dy < 0 || dy >= PACKED_RANGE) {
+      return -1;
+    }
+  }
+  size_t base = pp.k.size();
+  pp.k.resize(base + n);
+  for (long i = 0; i < n; i++) {
+    pp.k[base + i] = ((uint32_t) (p[i].x - pp.ox) << 16)
+      | (uint32_t) (p[i].y - pp.oy);
+  }
+  return 0;
+}
+
+int pack_points(const point2D* p, long n, PackedPoints& pp) {
+  int ox = 0, oy = 0;
+  for (long i = 0; i < n; i++) {
+    if (i == 0 || p[i].x < ox) ox = p[i].x;
+    if (i == 0 || p[i].y < oy) oy = p[i].y;
+  }
+  packed_init(pp, ox, oy);
+  return packed_append(pp, p, n);
+}
+
+void unpack_points(const PackedPoints& pp, vector<point2D>& p) {
+  p.resize(pp.k.size());
+  for (size_t i = 0; i < p.size(); i++) {
+    p[i] = packed_point(pp, i);
+  }
+}
+
+
+/* **************************************** */
+/* LSD radix sort of a[0..n) in two 16-bit passes, using tmp */
+static void radix_sort16(uint32_t* a, uint32_t* tmp, long n) {
+  vector<long> count(65536 + 1);
+  for (int shift = 0; shift < 32; shift += 16) {
+    fill(count.begin(), count.end(), 0);
+    for (long i = 0; i < n; i++) {
+      count[((a[i] >> shift) & 0xFFFF) + 1]++;
+    }
+    for (int d = 0; d < 65536; d++) {
+      count[d + 1] += count[d];
+    }
+    for (long i = 0; i < n; i++) {
+      tmp[count[(a[i] >> shift) & 0xFFFF]++] = a[i];
+    }
+    swap(a, tmp);
+  }
+  //two passes: the result is back in a
+}
+
+/* orientation of keys a, b, c; the keys are points relative to the
+   same origin, so the origin cancels out */
+static inline long long key_orient(uint32_t a, uint32_t b, uint32_t c) {
+  long long ax = a >> 16, ay = a & 0xFFFF;
+  long long bx = b >> 16, by = b & 0xFFFF;
+  long long cx = c >> 16, cy = c & 0xFFFF;
+  return (bx - ax) * (cy - ay) - (cx - ax) * (by - ay);
+}
+
+vector<point2D> packed_hull(const PackedPoints& pp) {
+  long n = pp.k.size();
+  if (n == 0) {
+    return vector<point2D>();
+  }
+  const uint32_t* k = &pp.k[0];
+
+  //the octagon of the extreme points, as in filtered_hull, ccw: the
+  //extremes of y, x - y, x, x + y, -y, y - x, -x, -x - y. First the
+  //extreme values (a branch-free pass), then a point for each
+  int lo[4] = {INT_MAX, INT_MAX, INT_MAX, INT_MAX};
+  int hi[4] = {INT_MIN, INT_MIN, INT_MIN, INT_MIN};
+  for (long i = 0; i < n; i++) {
+    int x = k[i] >> 16, y = k[i] & 0xFFFF;
+    int v[4] = {x, y, x + y, x - y};
+    for (int j = 0; j < 4; j++) {
+      lo[j] = min(lo[j], v[j]);
+      hi[j] = max(hi[j], v[j]);
+    }
+  }
+  //direction d is extreme where quantity q[d] equals want[d]
+  const int q[8] = {1, 3, 0, 2, 1, 3, 0, 2};
+  const int want[8] = {lo[1], hi[3], hi[0], hi[2], hi[1], lo[3], lo[0], lo[2]};
+  uint32_t ext[8];
+  int found = 0;
+  for (long i = 0; i < n && found != 0xFF; i++) {
+    int x = k[i] >> 16, y = k[i] & 0xFFFF;
+    int v[4] = {x, y, x + y, x - y};
+    for (int d = 0; d < 8; d++) {
+      if (!(found & (1 << d)) && v[q[d]] == want[d]) {
+        ext[d] = k[i];
+        found |= 1 << d;
+      }
+    }
+  }
+  uint32_t poly[8];
+  int m = 0;
+  for (int d = 0; d < 8; d++) {
+    if (m == 0 || ext[d] != poly[m-1]) {
+      poly[m++] = ext[d];
+    }
+  }
+  while (m > 1 && poly[m-1] == poly[0]) {
+    m--;
+  }
+
+  //keep the keys not strictly inside it, testing them in blocks
+  //with the dispatched kernel
+  vector<uint32_t> s(n);
+  long ns = 0;
+  if (m < 3) {
+    copy(k, k + n, s.begin());
+    ns = n;
+  } else {
+    const HullKernels* kr = hull_kernels();
+    const long B = 4096;
+    unsigned char inside[B];
+    for (long i0 = 0; i0 < n; i0 += B) {
+      long nb = min(B, n - i0);
+      kr->inside_packed(k + i0, nb, poly, m, inside);
+      for (long i = 0; i < nb; i++) {
+        s[ns] = k[i0 + i];
+        ns += !inside[i];
+      }
+    }
+  }
+  s.resize(ns);
+
+  //sort, drop repeated points, and scan
+  vector<uint32_t> tmp(ns);
+  radix_sort16(&s[0], &tmp[0], ns);
+  ns = unique(s.begin(), s.end()) - s.begin();
+  vector<uint32_t>& h = tmp;
+  h.resize(2 * ns + 2);
+  long t = 0;
+  for (long i = 0; i < ns; i++) {
+    while (t >= 2 && key_orient(h[t-2], h[t-1], s[i]) <= 0) t--;
+    h[t++] = s[i];
+  }
+  long lower = t + 1;
+  for (long i = ns - 2; i >= 0; i--) {
+    while (t >= lower && key_orient(h[t-2], h[t-1], s[i]) <= 0) t--;
+    h[t++] = s[i];
+  }
+  if (t > 1) t--;
+
+  //decode, starting at the lowest (then leftmost) vertex, and close
+  vector<point2D> result(t);
+  long first = 0;
+  for (long i = 0; i < t; i++) {
+    result[i].x = pp.ox + (int) (h[i] >> 16);
+    result[i].y = pp.oy + (int) (h[i] & 0xFFFF);
+    if (result[i].y < result[first].y
+        || (result[i].y == result[first].y && result[i].x < result[first].x)) {
+      first = i;
+    }
+  }
+  rotate(result.begin(), result.begin() + first, result.end());
+  hull_close(result);
+  return result;
+}
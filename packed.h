@@ -0,0 +1,50 @@
+#ifndef __packed_h
+#define __packed_h
+
+#include "geom.h"
+#include <stdint.h>
+
+/* Compact point storage for points on a bounded grid: 4 bytes per
+   point instead of 8.
+
+   Each point is stored as one 32-bit key, (x - ox) << 16 | (y - oy),
+   relative to an origin (ox, oy), so every point must be within
+   65536 of the origin in x and y (all generators fit, with room to
+   spare). The order of the keys as integers is the xy_less order of
+   the points, so a sort of the keys is a sort of the points, and
+   packed_hull reads the keys directly instead of decoding them into
+   a vector<point2D> first.
+*/
+typedef struct _packed_points {
+  int ox, oy;
+  vector<uint32_t> k;
+} PackedPoints;
+
+const long PACKED_RANGE = 65536;
+
+/* start an empty set with origin (ox, oy) */
+void packed_init(PackedPoints& pp, int ox, int oy);
+
+/* append p[0..n). Return 0, or -1 (and append nothing) if a point is
+   out of range */
+int packed_append(PackedPoints& pp, const point2D* p, long n);
+
+/* pack p[0..n) with the origin at the lower left corner of its
+   bounding box. Return 0, or -1 if the box is too large */
+int pack_points(const point2D* p, long n, PackedPoints& pp);
+
+inline point2D packed_point(const PackedPoints& pp, long i) {
+  point2D q = {pp.ox + (int) (pp.k[i] >> 16), pp.oy + (int) (pp.k[i] & 0xFFFF)};
+  return q;
+}
+
+void unpack_points(const PackedPoints& pp, vector<point2D>& p);
+
+/* compute the hull of the packed points, in the same form as
+   monotone_chain. The points strictly inside the octagon of the
+   extreme points are dropped while scanning the keys; the keys of
+   the others are radix sorted and scanned. Only hull vertices are
+   decoded to point2D. */
+vector<point2D> packed_hull(const PackedPoints& pp);
+
+#endif
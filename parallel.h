@@ -0,0 +1,50 @@
+#ifndef __parallel_h
+#define __parallel_h
+
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* number of worker threads to use when the caller passes
+   nthreads <= 0: $HULL_THREADS if set, else the number of cores */
+inline int default_nthreads() {
+  const char* env = getenv("HULL_THREADS");
+  if (env && atoi(env) > 0) {
+    return atoi(env);
+  }
+  int hw = (int) thread::hardware_concurrency();
+  return (hw > 0) ? hw : 1;
+}
+
+/* split [0,n) into nthreads contiguous ranges and call
+   f(begin, end, tid) on each one from its own thread. Range
+   boundaries depend only on n and nthreads. Thread 0 runs on the
+   calling thread. */
+template <class F>
+void parallel_for(long n, int nthreads, F f) {
+  if (nthreads <= 0) {
+    nthreads = default_nthreads();
+  }
+  if (nthreads > n) {
+    nthreads = (n > 0) ? (int) n : 1;
+  }
+  if (nthreads == 1) {
+    f(0L, n, 0);
+    return;
+  }
+
+  vector<thread> workers;
+  for (int t = 1; t < nthreads; t++) {
+    long begin = n * t / nthreads;
+    long end = n * (t + 1) / nthreads;
+    workers.push_back(thread(f, begin, end, t));
+  }
+  f(0L, n / nthreads, 0);
+  for (size_t t = 0; t < workers.size(); t++) {
+    workers[t].join();
+  }
+}
+
+#endif
@@ -0,0 +1,269 @@
+#include "pipeline.h"
+#include "generators.h"
+#include "hullmerge.h"
+#include "kernels.h"
+#include "parallel.h"
+#include "pointio.h"
+#include "rtimer.h"
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+using namespace std;
+
+
+/* **************************************** */
+static int read_generator(const PointSource* src, long first, long count,
+                          point2D* out) {
+  generate_range(src->gen, src->n, src->seed, first, count, out, 1);
+  return 0;
+}
+
+void generator_source(PointSource* src, int gen, long n, uint64_t seed) {
+  src->count = generator_count(gen, n);
+  src->read = read_generator;
+  src->gen = gen;
+  src->n = n;
+  src->seed = seed;
+  src->fd = -1;
+}
+
+static int read_file(const PointSource* src, long first, long count,
+                     point2D* out) {
+  return read_points_fd(src->fd, first, count, out);
+}
+
+int file_source(PointSource* src, const char* path) {
+  src->fd = open_point_file(path, &src->count);
+  if (src->fd < 0) {
+    return -1;
+  }
+  src->read = read_file;
+  src->gen = -1;
+  src->n = 0;
+  src->seed = 0;
+  return 0;
+}
+
+void close_source(PointSource* src) {
+  if (src->fd >= 0) {
+    close(src->fd);
+    src->fd = -1;
+  }
+}
+
+
+/* **************************************** */
+/* a bounded blocking queue; pop returns 0 once the queue is closed
+   and empty */
+template <class T>
+struct BoundedQueue {
+  mutex m;
+  condition_variable not_empty, not_full;
+  deque<T> q;
+  size_t capacity;
+  int closed;
+};
+
+template <class T>
+static void queue_init(BoundedQueue<T>& bq, size_t capacity) {
+  bq.capacity = capacity;
+  bq.closed = 0;
+}
+
+template <class T>
+static void queue_push(BoundedQueue<T>& bq, T v) {
+  unique_lock<mutex> g(bq.m);
+  bq.not_full.wait(g, [&]() { return bq.q.size() < bq.capacity; });
+  bq.q.push_back(v);
+  bq.not_empty.notify_one();
+}
+
+template <class T>
+static int queue_pop(BoundedQueue<T>& bq, T* v) {
+  unique_lock<mutex> g(bq.m);
+  bq.not_empty.wait(g, [&]() { return !bq.q.empty() || bq.closed; });
+  if (bq.q.empty()) {
+    return 0;
+  }
+  *v = bq.q.front();
+  bq.q.pop_front();
+  bq.not_full.notify_one();
+  return 1;
+}
+
+template <class T>
+static void queue_close(BoundedQueue<T>& bq) {
+  lock_guard<mutex> g(bq.m);
+  bq.closed = 1;
+  bq.not_empty.notify_all();
+}
+
+
+/* **************************************** */
+void pipeline_default_options(PipelineOptions* opt) {
+  opt->block = 65536;
+  opt->producers = 1;
+  opt->filters = max(1, default_nthreads() - 2);
+  opt->buffers = 2 * (opt->producers + opt->filters);
+}
+
+typedef struct _full_block {
+  int buffer;
+  long count;
+} FullBlock;
+
+int pipeline_hull(const PointSource* src, const PipelineOptions& opt,
+                  vector<point2D>& hull, PipelineStats* st) {
+  assert(opt.block > 0 && opt.producers > 0 && opt.filters > 0
+         && opt.buffers > 0);
+  Rtimer total;
+  rt_start(total);
+
+  vector<vector<point2D> > buffers(opt.buffers);
+  BoundedQueue<int> free_buffers;
+  BoundedQueue<FullBlock> full;
+  BoundedQueue<vector<point2D>*> hulls;
+  queue_init(free_buffers, opt.buffers);
+  queue_init(full, opt.buffers);
+  queue_init(hulls, opt.buffers);
+  for (int b = 0; b < opt.buffers; b++) {
+    buffers[b].resize(opt.block);
+    queue_push(free_buffers, b);
+  }
+
+  //the octagon of the hull so far, published by the hull stage
+  mutex octagon_lock;
+  point2D octagon[NB_EXTREMES];
+  int octagon_size = 0;
+
+  long nblocks = (src->count + opt.block - 1) / opt.block;
+  long next_block = 0;
+  int producers_left = opt.producers, filters_left = opt.filters;
+  int error = 0;  //errno of the first failed read
+  vector<double> busy(opt.producers + opt.filters, 0);
+  long kept = 0;
+
+  vector<thread> workers;
+  for (int t = 0; t < opt.producers; t++) {
+    workers.push_back(thread([&, t]() {
+          Rtimer rt;
+          while (1) {
+            long k = __atomic_fetch_add(&next_block, 1, __ATOMIC_RELAXED);
+            if (k >= nblocks || __atomic_load_n(&error, __ATOMIC_RELAXED)) {
+              break;
+            }
+            FullBlock fb;
+            if (!queue_pop(free_buffers, &fb.buffer)) {
+              break;
+            }
+            rt_start(rt);
+            fb.count = min(opt.block, src->count - k * opt.block);
+            if (src->read(src, k * opt.block, fb.count,
+                          &buffers[fb.buffer][0]) < 0) {
+              //keep the first errno for the caller
+              int none = 0;
+              __atomic_compare_exchange_n(&error, &none, errno ? errno : EIO,
+                                          false, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED);
+              fb.count = 0;
+            }
+            rt_stop(rt);
+            busy[t] += rt_w_useconds(rt);
+            queue_push(full, fb);
+          }
+          if (__atomic_sub_fetch(&producers_left, 1, __ATOMIC_ACQ_REL) == 0) {
+            queue_close(full);
+          }
+        }));
+  }
+  for (int t = 0; t < opt.filters; t++) {
+    workers.push_back(thread([&, t]() {
+          const HullKernels* k = hull_kernels();
+          Rtimer rt;
+          FullBlock fb;
+          long mine = 0;
+          while (queue_pop(full, &fb)) {
+            rt_start(rt);
+            point2D poly[NB_EXTREMES];
+            int m;
+            {
+              lock_guard<mutex> g(octagon_lock);
+              m = octagon_size;
+              copy(octagon, octagon + m, poly);
+            }
+            point2D* b = &buffers[fb.buffer][0];
+            long left = fb.count;
+            if (m >= 3) {
+              left = k->prefilter(b, fb.count, poly, m, b);
+            }
+            mine += left;
+            sort(b, b + left, xy_less);
+            vector<point2D>* h = new vector<point2D>(left * 2 + 2);
+            h->resize(monotone_chain_buffer(b, left, &(*h)[0]));
+            rt_stop(rt);
+            busy[opt.producers + t] += rt_w_useconds(rt);
+            queue_push(free_buffers, fb.buffer);
+            queue_push(hulls, h);
+          }
+          __atomic_add_fetch(&kept, mine, __ATOMIC_RELAXED);
+          if (__atomic_sub_fetch(&filters_left, 1, __ATOMIC_ACQ_REL) == 0) {
+            queue_close(hulls);
+          }
+        }));
+  }
+
+  //the hull stage
+  vector<point2D> running;
+  vector<point2D>* h;
+  double hull_busy = 0;
+  size_t largest = 0;
+  Rtimer rt;
+  while (queue_pop(hulls, &h)) {
+    rt_start(rt);
+    largest = max(largest, h->size());
+    if (!h->empty()) {
+      running = running.empty() ? *h : hull_merge(running, *h);
+      point2D poly[NB_EXTREMES];
+      int m = hull_octagon(&running[0], running.size(), poly);
+      lock_guard<mutex> g(octagon_lock);
+      octagon_size = m;
+      copy(poly, poly + m, octagon);
+    }
+    delete h;
+    rt_stop(rt);
+    hull_busy += rt_w_useconds(rt);
+  }
+  for (size_t t = 0; t < workers.size(); t++) {
+    workers[t].join();
+  }
+  rt_stop(total);
+
+  if (st) {
+    st->produce = st->filter = 0;
+    for (int t = 0; t < opt.producers; t++) {
+      st->produce += busy[t];
+    }
+    for (int t = 0; t < opt.filters; t++) {
+      st->filter += busy[opt.producers + t];
+    }
+    st->hull = hull_busy;
+    st->total = rt_w_useconds(total);
+    st->blocks = nblocks;
+    st->kept = kept;
+    st->peak_bytes = (opt.buffers * opt.block + largest + running.size())
+      * sizeof(point2D);
+    st->error = (error != 0);
+  }
+  if (error) {
+    hull.clear();
+    errno = error;
+    return -1;
+  }
+  hull.swap(running);
+  return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef __pipeline_h
+#define __pipeline_h
+
+#include "geom.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Pipelined hull: read -> filter -> hull, on separate threads.
+
+   Instead of reading (or generating) all the points, then sorting
+   them, then scanning, the points flow through three stages
+   connected by bounded queues, so the stages overlap:
+
+   - producers read blocks of points from a source into a fixed pool
+     of block buffers;
+   - filters drop the points of a block strictly inside the octagon
+     of the extreme points of the hull so far (Akl-Toussaint, with
+     the SIMD kernel), hull the survivors, and recycle the buffer;
+   - the hull stage, on the calling thread, merges the block hulls
+     into the running hull and publishes its octagon to the filters.
+
+   Memory is the pool of block buffers plus the hulls, whatever the
+   number of points, and a stage that falls behind blocks the ones
+   before it. The result is the exact hull, in the same form as
+   monotone_chain.
+*/
+
+/* a source of points that can be read by range from several threads
+   at once */
+typedef struct _point_source {
+  long count;
+  //read points [first, first+count) into out; return 0, or -1 on
+  //error
+  int (*read)(const struct _point_source* src, long first, long count,
+              point2D* out);
+  //generator sources
+  int gen;
+  long n;
+  uint64_t seed;
+  //file sources
+  int fd;
+} PointSource;
+
+/* the points of generate_points(gen, n, seed) */
+void generator_source(PointSource* src, int gen, long n, uint64_t seed);
+
+/* the points of a point file (see pointio.h); return 0, or -1 with
+   errno set */
+int file_source(PointSource* src, const char* path);
+
+/* release what the source holds (the file of a file source) */
+void close_source(PointSource* src);
+
+typedef struct _pipeline_options {
+  long block;     //points per block
+  int producers;  //producer threads
+  int filters;    //filter threads
+  int buffers;    //block buffers in the pool
+} PipelineOptions;
+
+/* set the defaults: blocks of 65536 points, 1 producer, filters on
+   the remaining cores (at least 1), two buffers per producer and
+   filter thread */
+void pipeline_default_options(PipelineOptions* opt);
+
+typedef struct _pipeline_stats {
+  //time spent working (not waiting on a queue), summed over the
+  //threads of each stage, and the wall time, in us
+  double produce, filter, hull, total;
+  long blocks;
+  long kept;          //points that survived the filters
+  size_t peak_bytes;  //block buffers, largest block hull, and hull
+  int error;          //1 if reading the source failed
+} PipelineStats;
+
+/* set hull to the hull of the points of src. Return 0, or -1 with
+   errno set (and hull empty) if reading the source failed. If st is
+   not NULL it gets the statistics */
+int pipeline_hull(const PointSource* src, const PipelineOptions& opt,
+                  vector<point2D>& hull, PipelineStats* st = NULL);
+
+#endif
@@ -0,0 +1,277 @@
+#include "pointio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+using namespace std;
+
+static const char POINT_MAGIC[4] = {'P', 'T', 'S', '1'};
+static const uint32_t MSG_MAGIC = 0x31485348; //"HSH1"
+
+typedef struct _point_file_header {
+  char magic[4];
+  uint32_t reserved;
+  uint64_t count;
+} point_file_header;
+
+typedef struct _msg_header {
+  uint32_t magic;
+  uint32_t type;
+  uint64_t len;
+} msg_header;
+
+
+/* **************************************** */
+int write_all(int fd, const void* buf, size_t len) {
+  const char* p = (const char*) buf;
+  while (len > 0) {
+    ssize_t k = write(fd, p, len);
+    if (k < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) errno = ETIMEDOUT;
+      return -1;
+    }
+    p += k;
+    len -= k;
+  }
+  return 0;
+}
+
+int read_all(int fd, void* buf, size_t len) {
+  char* p = (char*) buf;
+  while (len > 0) {
+    ssize_t k = read(fd, p, len);
+    if (k < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) errno = ETIMEDOUT;
+      return -1;
+    }
+    if (k == 0) {
+      //the other end closed in the middle of a message
+      errno = EPIPE;
+      return -1;
+    }
+    p += k;
+    len -= k;
+  }
+  return 0;
+}
+
+static int pread_all(int fd, void* buf, size_t len, off_t offset) {
+  char* p = (char*) buf;
+  while (len > 0) {
+    ssize_t k = pread(fd, p, len, offset);
+    if (k < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    if (k == 0) {
+      errno = EINVAL;
+      return -1;
+    }
+    p += k;
+    len -= k;
+    offset += k;
+  }
+  return 0;
+}
+
+
+/* swap points between host order and little-endian, in place */
+static void points_le(point2D* p, size_t n) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  for (size_t i = 0; i < n; i++) {
+    p[i].x = (int) le32((uint32_t) p[i].x);
+    p[i].y = (int) le32((uint32_t) p[i].y);
+  }
+#endif
+}
+
+/* write n points, little-endian */
+static int write_points(int fd, const point2D* p, size_t n) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  point2D buf[4096];
+  while (n > 0) {
+    size_t k = min(n, sizeof(buf) / sizeof(buf[0]));
+    memcpy(buf, p, k * sizeof(point2D));
+    points_le(buf, k);
+    if (write_all(fd, buf, k * sizeof(point2D)) < 0) {
+      return -1;
+    }
+    p += k;
+    n -= k;
+  }
+  return 0;
+#else
+  return write_all(fd, p, n * sizeof(point2D));
+#endif
+}
+
+
+/* **************************************** */
+int write_point_file(const char* path, const vector<point2D>& p) {
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+  point_file_header hdr;
+  memcpy(hdr.magic, POINT_MAGIC, 4);
+  hdr.reserved = 0;
+  hdr.count = le64(p.size());
+  int r = write_all(fd, &hdr, sizeof(hdr));
+  if (r == 0 && p.size() > 0) {
+    r = write_points(fd, &p[0], p.size());
+  }
+  if (close(fd) < 0) {
+    r = -1;
+  }
+  return r;
+}
+
+static long read_header(int fd) {
+  point_file_header hdr;
+  if (pread_all(fd, &hdr, sizeof(hdr), 0) < 0) {
+    return -1;
+  }
+  if (memcmp(hdr.magic, POINT_MAGIC, 4) != 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  return (long) le64(hdr.count);
+}
+
+long point_file_count(const char* path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  long count = read_header(fd);
+  close(fd);
+  return count;
+}
+
+int open_point_file(const char* path, long* count) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  *count = read_header(fd);
+  if (*count < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int read_points_fd(int fd, long offset, long count, point2D* out) {
+  if (count == 0) {
+    return 0;
+  }
+  if (pread_all(fd, out, count * sizeof(point2D),
+                sizeof(point_file_header) + offset * sizeof(point2D)) < 0) {
+    return -1;
+  }
+  points_le(out, count);
+  return 0;
+}
+
+int read_point_file(const char* path, long offset, long count,
+                    vector<point2D>& p) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  long total = read_header(fd);
+  if (total < 0) {
+    close(fd);
+    return -1;
+  }
+  if (count < 0) {
+    count = total - offset;
+  }
+  if (offset < 0 || count < 0 || offset + count > total) {
+    close(fd);
+    errno = EINVAL;
+    return -1;
+  }
+  p.resize(count);
+  int r = 0;
+  if (count > 0) {
+    r = pread_all(fd, &p[0], count * sizeof(point2D),
+                  sizeof(point_file_header) + offset * sizeof(point2D));
+    points_le(&p[0], count);
+  }
+  close(fd);
+  return r;
+}
+
+
+/* **************************************** */
+static int send_header(int fd, uint32_t type, uint64_t len) {
+  msg_header hdr;
+  hdr.magic = le32(MSG_MAGIC);
+  hdr.type = le32(type);
+  hdr.len = le64(len);
+  return write_all(fd, &hdr, sizeof(hdr));
+}
+
+int send_msg(int fd, uint32_t type, const void* payload, uint64_t len) {
+  if (send_header(fd, type, len) < 0) {
+    return -1;
+  }
+  return (len > 0) ? write_all(fd, payload, len) : 0;
+}
+
+int recv_msg(int fd, uint32_t* type, vector<char>& payload) {
+  msg_header hdr;
+  if (read_all(fd, &hdr, sizeof(hdr)) < 0) {
+    return -1;
+  }
+  hdr.magic = le32(hdr.magic);
+  hdr.type = le32(hdr.type);
+  hdr.len = le64(hdr.len);
+  if (hdr.magic != MSG_MAGIC || hdr.len > MSG_MAX_PAYLOAD) {
+    errno = EPROTO;
+    return -1;
+  }
+  *type = hdr.type;
+  //grow the buffer as the payload arrives, so that a peer has to
+  //send the bytes it announces before we allocate them
+  payload.clear();
+  for (uint64_t got = 0; got < hdr.len; ) {
+    uint64_t chunk = hdr.len - got;
+    if (chunk > (1 << 20)) {
+      chunk = 1 << 20;
+    }
+    payload.resize(got + chunk);
+    if (read_all(fd, &payload[got], chunk) < 0) {
+      return -1;
+    }
+    got += chunk;
+  }
+  return 0;
+}
+
+int send_points(int fd, uint32_t type, const vector<point2D>& p) {
+  if (send_header(fd, type, p.size() * sizeof(point2D)) < 0) {
+    return -1;
+  }
+  return p.size() ? write_points(fd, &p[0], p.size()) : 0;
+}
+
+int payload_points(const vector<char>& payload, size_t skip,
+                   vector<point2D>& p) {
+  if (payload.size() < skip
+      || (payload.size() - skip) % sizeof(point2D) != 0) {
+    errno = EPROTO;
+    return -1;
+  }
+  p.resize((payload.size() - skip) / sizeof(point2D));
+  if (p.size() > 0) {
+    memcpy(&p[0], &payload[skip], p.size() * sizeof(point2D));
+    points_le(&p[0], p.size());
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+#ifndef __pointio_h
+#define __pointio_h
+
+#include "geom.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/* Point files and framed messages over file descriptors.
+
+   A point file is a 16-byte header (magic "PTS1", 4 reserved bytes,
+   uint64 count) followed by count points stored as two int32 each.
+   Workers can read any range of it directly.
+
+   A message is a 16-byte header (magic, uint32 type, uint64 payload
+   length) followed by the payload. The same framing works on pipes,
+   Unix domain sockets and TCP sockets.
+
+   Both formats are little-endian, whatever the host, so files and
+   messages can go between machines; the points of a payload are
+   converted by send_points and payload_points, other fields of a
+   payload with le32 and le64.
+
+   All functions return 0 (or a count) on success and -1 on error,
+   with errno set. */
+
+/* convert between host order and little-endian (the same swap both
+   ways; nothing on little-endian hosts) */
+static inline uint32_t le32(uint32_t x) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return __builtin_bswap32(x);
+#else
+  return x;
+#endif
+}
+
+static inline uint64_t le64(uint64_t x) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return __builtin_bswap64(x);
+#else
+  return x;
+#endif
+}
+
+/* write points p to a new point file */
+int write_point_file(const char* path, const vector<point2D>& p);
+
+/* return the number of points in a point file, or -1 */
+long point_file_count(const char* path);
+
+/* read points [offset, offset+count) of a point file into p;
+   count < 0 reads to the end */
+int read_point_file(const char* path, long offset, long count,
+                    vector<point2D>& p);
+
+/* open a point file for reading with read_points_fd; return the fd
+   and set *count to its number of points, or return -1 */
+int open_point_file(const char* path, long* count);
+
+/* read points [offset, offset+count) of the point file open on fd
+   into out. Uses pread, so threads can share fd */
+int read_points_fd(int fd, long offset, long count, point2D* out);
+
+/* read or write exactly len bytes, retrying short transfers. A
+   socket timeout (SO_RCVTIMEO, SO_SNDTIMEO) fails with ETIMEDOUT */
+int write_all(int fd, const void* buf, size_t len);
+int read_all(int fd, void* buf, size_t len);
+
+/* send a message with the given type and payload */
+int send_msg(int fd, uint32_t type, const void* payload, uint64_t len);
+
+/* the largest payload recv_msg accepts: 2^30 bytes, 128M points */
+#define MSG_MAX_PAYLOAD (1ULL << 30)
+
+/* receive a message; the payload is stored in payload. A payload
+   longer than MSG_MAX_PAYLOAD fails with EPROTO */
+int recv_msg(int fd, uint32_t* type, vector<char>& payload);
+
+/* send / receive a vector of points as a message payload */
+int send_points(int fd, uint32_t type, const vector<point2D>& p);
+int payload_points(const vector<char>& payload, size_t skip,
+                   vector<point2D>& p);
+
+#endif
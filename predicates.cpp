@@ -0,0 +1,152 @@
+#include "predicates.h"
+
+/* The expansion arithmetic relies on every operation being rounded
+   on its own: this file must not be compiled with fused multiply-add
+   contraction (the Makefile passes -ffp-contract=off) or with
+   -ffast-math. */
+
+
+/* **************************************** */
+static long stat_calls, stat_adapt, stat_exact;
+
+void predicate_count_calls(long calls) {
+  __atomic_fetch_add(&stat_calls, calls, __ATOMIC_RELAXED);
+}
+
+void predicate_stats(PredicateStats* st) {
+  st->calls = __atomic_load_n(&stat_calls, __ATOMIC_RELAXED);
+  st->adapt = __atomic_load_n(&stat_adapt, __ATOMIC_RELAXED);
+  st->exact = __atomic_load_n(&stat_exact, __ATOMIC_RELAXED);
+}
+
+void predicate_stats_reset() {
+  __atomic_store_n(&stat_calls, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&stat_adapt, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&stat_exact, 0, __ATOMIC_RELAXED);
+}
+
+
+/* **************************************** */
+/* error-free transformations: x is the rounded result, y the error */
+static inline void two_sum(double a, double b, double& x, double& y) {
+  x = a + b;
+  double bv = x - a;
+  double av = x - bv;
+  y = (a - av) + (b - bv);
+}
+
+static inline void two_diff(double a, double b, double& x, double& y) {
+  x = a - b;
+  double bv = a - x;
+  double av = x + bv;
+  y = (a - av) + (bv - b);
+}
+
+/* split a into two halves of 26 bits: a = hi + lo */
+static inline void split(double a, double& hi, double& lo) {
+  const double SPLITTER = 134217729.0;  //2^27 + 1
+  double c = SPLITTER * a;
+  double abig = c - a;
+  hi = c - abig;
+  lo = a - hi;
+}
+
+static inline void two_product(double a, double b, double& x, double& y) {
+  x = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  double err1 = x - ahi * bhi;
+  double err2 = err1 - alo * bhi;
+  double err3 = err2 - ahi * blo;
+  y = alo * blo - err3;
+}
+
+/* h = e + b, where e[0..elen) is an expansion (non-overlapping
+   components of increasing magnitude); zero components are dropped.
+   Returns the length of h, which needs room for elen+1 */
+static int grow_expansion(int elen, const double* e, double b, double* h) {
+  double q = b;
+  int hlen = 0;
+  for (int i = 0; i < elen; i++) {
+    double sum, err;
+    two_sum(q, e[i], sum, err);
+    q = sum;
+    if (err != 0) {
+      h[hlen++] = err;
+    }
+  }
+  if (q != 0 || hlen == 0) {
+    h[hlen++] = q;
+  }
+  return hlen;
+}
+
+/* the sum of terms[0..n) (n <= 16) as an expansion; returns its
+   length */
+static int expansion_of(const double* terms, int n, double* e) {
+  double h[32];
+  int elen = 0;
+  for (int i = 0; i < n; i++) {
+    elen = grow_expansion(elen, e, terms[i], h);
+    for (int k = 0; k < elen; k++) {
+      e[k] = h[k];
+    }
+  }
+  return elen;
+}
+
+/* the sum of terms[0..n), exactly; returns its most significant
+   component, which has the sign of the sum */
+static double sum_exact(const double* terms, int n) {
+  double e[32];
+  int elen = expansion_of(terms, n, e);
+  return elen ? e[elen - 1] : 0;
+}
+
+
+/* **************************************** */
+double orient2d_exact(point2Dd a, point2Dd b, point2Dd c) {
+  //(ax-cx)(by-cy) - (ay-cy)(bx-cx) expanded into six products, each
+  //one split into its rounded value and its error
+  double t[12];
+  two_product(a.x, b.y, t[0], t[1]);
+  two_product(-a.x, c.y, t[2], t[3]);
+  two_product(-c.x, b.y, t[4], t[5]);
+  two_product(-a.y, b.x, t[6], t[7]);
+  two_product(a.y, c.x, t[8], t[9]);
+  two_product(c.y, b.x, t[10], t[11]);
+  return sum_exact(t, 12);
+}
+
+double orient2d_slow(point2Dd a, point2Dd b, point2Dd c, double detsum) {
+  //Shewchuk's ccwerrboundB, with eps = 2^-53
+  const double EPS = 1.1102230246251565e-16;
+  const double ERRBOUND_B = (2.0 + 12.0 * EPS) * EPS;
+  __atomic_fetch_add(&stat_adapt, 1, __ATOMIC_RELAXED);
+
+  //stage B: the determinant of the rounded differences, exactly
+  double acx, acy, bcx, bcy, acxtail, acytail, bcxtail, bcytail;
+  two_diff(a.x, c.x, acx, acxtail);
+  two_diff(a.y, c.y, acy, acytail);
+  two_diff(b.x, c.x, bcx, bcxtail);
+  two_diff(b.y, c.y, bcy, bcytail);
+  double t[4], e[32];
+  two_product(acx, bcy, t[0], t[1]);
+  two_product(-acy, bcx, t[2], t[3]);
+  int elen = expansion_of(t, 4, e);
+  double det = 0;
+  for (int i = 0; i < elen; i++) {
+    det += e[i];
+  }
+  if (fabs(det) >= ERRBOUND_B * detsum) {
+    return det;
+  }
+  //the differences were exact, so this is the determinant
+  if (acxtail == 0 && acytail == 0 && bcxtail == 0 && bcytail == 0) {
+    return e[elen - 1];
+  }
+
+  __atomic_fetch_add(&stat_exact, 1, __ATOMIC_RELAXED);
+  return orient2d_exact(a, b, c);
+}
@@ -0,0 +1,69 @@
+#ifndef __predicates_h
+#define __predicates_h
+
+#include "geom.h"
+#include <math.h>
+
+/* Exact orientation test for double coordinates, after Shewchuk's
+   adaptive predicates ("Adaptive Precision Floating-Point Arithmetic
+   and Fast Robust Geometric Predicates", 1997).
+
+   orient2d_adapt evaluates the determinant in doubles and returns it
+   when its magnitude exceeds a bound on the rounding error, which is
+   almost always. Otherwise the slow path evaluates it again with the
+   differences rounded and their products exact (stage B), and, if
+   that is not conclusive either, exactly with expansion arithmetic
+   (sums of non-overlapping doubles). The sign of the result is
+   always the sign of the exact determinant, provided that no
+   intermediate value overflows or underflows (coordinates of
+   magnitude within 2^-400 .. 2^400, or 0, are safe).
+
+   The slow path counts how often it runs, in all threads. */
+
+typedef struct _predicate_stats {
+  long calls;    //orientation tests, as counted by the callers
+  long adapt;    //tests the floating-point filter did not decide
+  long exact;    //of those, tests that needed the exact expansion
+} PredicateStats;
+
+/* the slow path of orient2d_adapt; detsum is the magnitude used in
+   the error bound */
+double orient2d_slow(point2Dd a, point2Dd b, point2Dd c, double detsum);
+
+/* returns a value with the sign of the determinant
+   | a.x-c.x  a.y-c.y |
+   | b.x-c.x  b.y-c.y |
+   positive if c is left of ab (a, b, c ccw), 0 if they are collinear */
+inline double orient2d_adapt(point2Dd a, point2Dd b, point2Dd c) {
+  //Shewchuk's ccwerrboundA, with eps = 2^-53
+  const double EPS = 1.1102230246251565e-16;
+  const double ERRBOUND_A = (3.0 + 16.0 * EPS) * EPS;
+  double detleft = (a.x - c.x) * (b.y - c.y);
+  double detright = (a.y - c.y) * (b.x - c.x);
+  double det = detleft - detright;
+  double detsum;
+  if (detleft > 0) {
+    if (detright <= 0) return det;
+    detsum = detleft + detright;
+  } else if (detleft < 0) {
+    if (detright >= 0) return det;
+    detsum = -detleft - detright;
+  } else {
+    return det;
+  }
+  if (fabs(det) >= ERRBOUND_A * detsum) {
+    return det;
+  }
+  return orient2d_slow(a, b, c, detsum);
+}
+
+/* the determinant, computed exactly; for testing the filter */
+double orient2d_exact(point2Dd a, point2Dd b, point2Dd c);
+
+/* add calls to the count of tests */
+void predicate_count_calls(long calls);
+
+void predicate_stats(PredicateStats* st);
+void predicate_stats_reset();
+
+#endif
@@ -0,0 +1,146 @@
+#include "quadtree.h"
+#include <assert.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+/* split node n, whose points lie in the square of side s with lower
+   left corner (cx, cy) */
+static void split(QuadTree& t, long n, long long cx, long long cy,
+                  long long s) {
+  QuadNode& nd = t.node[n];
+  nd.x0 = nd.x1 = t.p[nd.lo].x;
+  nd.y0 = nd.y1 = t.p[nd.lo].y;
+  for (long i = nd.lo + 1; i < nd.hi; i++) {
+    nd.x0 = min(nd.x0, t.p[i].x);
+    nd.x1 = max(nd.x1, t.p[i].x);
+    nd.y0 = min(nd.y0, t.p[i].y);
+    nd.y1 = max(nd.y1, t.p[i].y);
+  }
+  if (nd.hi - nd.lo <= t.leaf || s == 1) {
+    return;
+  }
+
+  //partition by x, then each half by y
+  long long h = s / 2, mx = cx + h, my = cy + h;
+  vector<point2D>::iterator b = t.p.begin();
+  long a = partition(b + nd.lo, b + nd.hi,
+                     [mx](point2D q) { return q.x < mx; }) - b;
+  long bl = partition(b + nd.lo, b + a,
+                      [my](point2D q) { return q.y < my; }) - b;
+  long br = partition(b + a, b + nd.hi,
+                      [my](point2D q) { return q.y < my; }) - b;
+  long bound[5] = {nd.lo, bl, a, br, nd.hi};
+  long long qx[4] = {cx, cx, mx, mx}, qy[4] = {cy, my, cy, my};
+
+  long first = t.node.size();
+  int k = 0;
+  for (int q = 0; q < 4; q++) {
+    if (bound[q] < bound[q + 1]) {
+      QuadNode c;
+      c.lo = bound[q];
+      c.hi = bound[q + 1];
+      c.child = -1;
+      c.nchild = 0;
+      t.node.push_back(c);
+      k++;
+    }
+  }
+  t.node[n].child = first;
+  t.node[n].nchild = k;
+  k = 0;
+  for (int q = 0; q < 4; q++) {
+    if (bound[q] < bound[q + 1]) {
+      split(t, first + k++, qx[q], qy[q], h);
+    }
+  }
+}
+
+/* build the tree of the points already in t.p */
+static void build(QuadTree& t, long leaf) {
+  assert(leaf >= 1);
+  const vector<point2D>& p = t.p;
+  t.leaf = leaf;
+  t.node.clear();
+  if (p.empty()) {
+    return;
+  }
+  int x0 = p[0].x, y0 = p[0].y;
+  long long extent = 1;
+  for (size_t i = 1; i < p.size(); i++) {
+    x0 = min(x0, p[i].x);
+    y0 = min(y0, p[i].y);
+  }
+  for (size_t i = 0; i < p.size(); i++) {
+    extent = max(extent, (long long) p[i].x - x0 + 1);
+    extent = max(extent, (long long) p[i].y - y0 + 1);
+  }
+  long long s = 1;
+  while (s < extent) {
+    s *= 2;
+  }
+
+  QuadNode root;
+  root.lo = 0;
+  root.hi = p.size();
+  root.child = -1;
+  root.nchild = 0;
+  t.node.push_back(root);
+  split(t, 0, x0, y0, s);
+}
+
+void qt_build(QuadTree& t, const vector<point2D>& p, long leaf) {
+  t.p = p;
+  build(t, leaf);
+}
+
+void qt_build_from(QuadTree& t, vector<point2D>& p, long leaf) {
+  t.p.swap(p);
+  p.clear();
+  build(t, leaf);
+}
+
+size_t qt_bytes(const QuadTree& t) {
+  return t.p.capacity() * sizeof(point2D)
+    + t.node.capacity() * sizeof(QuadNode);
+}
+
+
+/* **************************************** */
+typedef struct _view {
+  double x0, y0, x1, y1;
+  double agg;  //in units
+} View;
+
+static void visit(const QuadTree& t, long n, const View& v,
+                  vector<long>& cells, vector<long>& leaves) {
+  const QuadNode& nd = t.node[n];
+  if (nd.x1 < v.x0 || nd.x0 > v.x1 || nd.y1 < v.y0 || nd.y0 > v.y1) {
+    return;
+  }
+  if (nd.x1 - nd.x0 <= v.agg && nd.y1 - nd.y0 <= v.agg) {
+    cells.push_back(n);
+    return;
+  }
+  if (nd.child < 0) {
+    leaves.push_back(n);
+    return;
+  }
+  for (int c = 0; c < nd.nchild; c++) {
+    visit(t, nd.child + c, v, cells, leaves);
+  }
+}
+
+void qt_visible(const QuadTree& t, double x0, double y0, double x1,
+                double y1, double pixel, double agg, vector<long>& cells,
+                vector<long>& leaves) {
+  cells.clear();
+  leaves.clear();
+  if (t.node.empty()) {
+    return;
+  }
+  View v = {x0, y0, x1, y1, pixel * agg};
+  visit(t, 0, v, cells, leaves);
+}
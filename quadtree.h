@@ -0,0 +1,53 @@
+#ifndef __quadtree_h
+#define __quadtree_h
+
+#include "geom.h"
+
+/* A point quadtree for drawing large point sets, built once per set.
+
+   The root is the smallest power-of-two square containing the
+   points; a cell with more than leaf points is split into its four
+   quadrants, and only the non-empty ones are kept. The points are
+   reordered so that the points of every cell are contiguous, and
+   each cell keeps the bounding box of its points.
+
+   A frame only walks the cells that meet the view, and stops at the
+   cells that cover no more than a few pixels: they are drawn as one
+   aggregate instead of point by point. The work per frame is then
+   bounded by what is visible (at most a few cells per pixel), not by
+   the number of points. No GL here, so it can be tested headless. */
+
+typedef struct _quad_node {
+  int x0, y0, x1, y1;  //bounding box of the points
+  long lo, hi;         //the points are p[lo..hi) of the tree
+  long child;          //first child, -1 for a leaf
+  int nchild;          //children are node[child..child+nchild)
+} QuadNode;
+
+typedef struct _quad_tree {
+  vector<point2D> p;      //the points, in tree order
+  vector<QuadNode> node;  //node 0 is the root
+  long leaf;
+} QuadTree;
+
+/* build the tree of p, with at most leaf points per leaf (except
+   for cells of a single coordinate, which are never split) */
+void qt_build(QuadTree& t, const vector<point2D>& p, long leaf = 64);
+
+/* same, but the tree takes the points of p instead of copying them;
+   p is left empty */
+void qt_build_from(QuadTree& t, vector<point2D>& p, long leaf = 64);
+
+/* bytes used by the tree, points included */
+size_t qt_bytes(const QuadTree& t);
+
+/* the cells to draw for the view [x0,x1]x[y0,y1], where a pixel is
+   pixel units wide: cells whose box is at most agg pixels wide and
+   high go to cells, the other leaves that meet the view go to
+   leaves. Every point in the view is in exactly one of them. Both
+   vectors are cleared first */
+void qt_visible(const QuadTree& t, double x0, double y0, double x1,
+                double y1, double pixel, double agg, vector<long>& cells,
+                vector<long>& leaves);
+
+#endif
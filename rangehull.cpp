@@ -0,0 +1,186 @@
+#include "rangehull.h"
+#include "hullmerge.h"
+#include "parallel.h"
+#include <assert.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+static void set_box(RangeHullNode& nd, const vector<point2D>& p) {
+  nd.x0 = nd.x1 = p[nd.lo].x;
+  nd.y0 = nd.y1 = p[nd.lo].y;
+  for (long i = nd.lo + 1; i < nd.hi; i++) {
+    nd.x0 = min(nd.x0, p[i].x);
+    nd.x1 = max(nd.x1, p[i].x);
+    nd.y0 = min(nd.y0, p[i].y);
+    nd.y1 = max(nd.y1, p[i].y);
+  }
+}
+
+static bool x_less(point2D a, point2D b) { return a.x < b.x; }
+static bool y_less(point2D a, point2D b) { return a.y < b.y; }
+
+/* build the subtree of node n, whose points are set; record the
+   depth of each node so that the hulls can be built level by level */
+static void split(RangeHullIndex& idx, long n, int depth,
+                  vector<int>& depths) {
+  set_box(idx.node[n], idx.p);
+  depths[n] = depth;
+  long lo = idx.node[n].lo, hi = idx.node[n].hi;
+  if (hi - lo <= idx.leaf) {
+    return;
+  }
+  //split at the median of the wider side
+  long mid = lo + (hi - lo) / 2;
+  const RangeHullNode& nd = idx.node[n];
+  if ((long long) nd.x1 - nd.x0 >= (long long) nd.y1 - nd.y0) {
+    nth_element(idx.p.begin() + lo, idx.p.begin() + mid,
+                idx.p.begin() + hi, x_less);
+  } else {
+    nth_element(idx.p.begin() + lo, idx.p.begin() + mid,
+                idx.p.begin() + hi, y_less);
+  }
+
+  RangeHullNode c;
+  c.hull = c.nhull = 0;
+  c.left = c.right = -1;
+  long l = idx.node.size();
+  c.lo = lo;
+  c.hi = mid;
+  idx.node.push_back(c);
+  c.lo = mid;
+  c.hi = hi;
+  idx.node.push_back(c);
+  depths.push_back(0);
+  depths.push_back(0);
+  idx.node[n].left = l;
+  idx.node[n].right = l + 1;
+  split(idx, l, depth + 1, depths);
+  split(idx, l + 1, depth + 1, depths);
+}
+
+/* drop the closing copy of the first vertex */
+static void unclose(vector<point2D>& h) {
+  if (h.size() > 1 && h.front().x == h.back().x
+      && h.front().y == h.back().y) {
+    h.pop_back();
+  }
+}
+
+void range_hull_build(RangeHullIndex& idx, const vector<point2D>& p,
+                      long leaf, int nthreads) {
+  assert(leaf >= 1);
+  idx.p = p;
+  idx.leaf = leaf;
+  idx.node.clear();
+  idx.hulls.clear();
+  if (p.empty()) {
+    return;
+  }
+
+  RangeHullNode root;
+  root.lo = 0;
+  root.hi = p.size();
+  root.hull = root.nhull = 0;
+  root.left = root.right = -1;
+  idx.node.push_back(root);
+  vector<int> depths(1);
+  split(idx, 0, 0, depths);
+
+  //the hulls, deepest level first: a leaf is hulled from its points,
+  //an inner node merges the hulls of its children
+  long count = idx.node.size();
+  int maxdepth = *max_element(depths.begin(), depths.end());
+  vector<vector<long> > level(maxdepth + 1);
+  for (long n = 0; n < count; n++) {
+    level[depths[n]].push_back(n);
+  }
+  vector<vector<point2D> > h(count);
+  for (int d = maxdepth; d >= 0; d--) {
+    const vector<long>& ln = level[d];
+    parallel_for(ln.size(), nthreads, [&](long begin, long end, int) {
+      for (long i = begin; i < end; i++) {
+        const RangeHullNode& nd = idx.node[ln[i]];
+        if (nd.left < 0) {
+          vector<point2D> s(idx.p.begin() + nd.lo, idx.p.begin() + nd.hi);
+          h[ln[i]] = monotone_chain(s);
+        } else {
+          h[ln[i]] = hull_merge(h[nd.left], h[nd.right]);
+        }
+        unclose(h[ln[i]]);
+      }
+    });
+  }
+
+  //flatten them
+  long total = 0;
+  for (long n = 0; n < count; n++) {
+    idx.node[n].hull = total;
+    idx.node[n].nhull = h[n].size();
+    total += h[n].size();
+  }
+  idx.hulls.resize(total);
+  for (long n = 0; n < count; n++) {
+    copy(h[n].begin(), h[n].end(), idx.hulls.begin() + idx.node[n].hull);
+  }
+}
+
+size_t range_hull_bytes(const RangeHullIndex& idx) {
+  return idx.p.capacity() * sizeof(point2D)
+    + idx.node.capacity() * sizeof(RangeHullNode)
+    + idx.hulls.capacity() * sizeof(point2D);
+}
+
+
+/* **************************************** */
+typedef struct _window {
+  int x0, y0, x1, y1;
+} Window;
+
+static void collect(const RangeHullIndex& idx, long n, const Window& w,
+                    vector<point2D>& cand, RangeHullStats& st) {
+  const RangeHullNode& nd = idx.node[n];
+  if (nd.x1 < w.x0 || nd.x0 > w.x1 || nd.y1 < w.y0 || nd.y0 > w.y1) {
+    return;
+  }
+  if (nd.x0 >= w.x0 && nd.x1 <= w.x1 && nd.y0 >= w.y0 && nd.y1 <= w.y1) {
+    const point2D* h = &idx.hulls[nd.hull];
+    cand.insert(cand.end(), h, h + nd.nhull);
+    st.nodes++;
+    return;
+  }
+  if (nd.left < 0) {
+    for (long i = nd.lo; i < nd.hi; i++) {
+      const point2D& q = idx.p[i];
+      if (q.x >= w.x0 && q.x <= w.x1 && q.y >= w.y0 && q.y <= w.y1) {
+        cand.push_back(q);
+      }
+    }
+    st.leaves++;
+    return;
+  }
+  collect(idx, nd.left, w, cand, st);
+  collect(idx, nd.right, w, cand, st);
+}
+
+vector<point2D> range_hull(const RangeHullIndex& idx, int x0, int y0,
+                           int x1, int y1, RangeHullStats* st) {
+  RangeHullStats s = {0, 0, 0};
+  vector<point2D> cand, h;
+  if (!idx.node.empty() && x0 <= x1 && y0 <= y1) {
+    Window w = {x0, y0, x1, y1};
+    collect(idx, 0, w, cand, s);
+  }
+  s.candidates = cand.size();
+  if (!cand.empty()) {
+    sort(cand.begin(), cand.end(), xy_less);
+    h.resize(2 * cand.size() + 2);
+    h.resize(monotone_chain_buffer(&cand[0], cand.size(), &h[0]));
+  }
+  if (st) {
+    *st = s;
+  }
+  return h;
+}
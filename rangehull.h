@@ -0,0 +1,56 @@
+#ifndef __rangehull_h
+#define __rangehull_h
+
+#include "geom.h"
+#include <stddef.h>
+
+/* Hulls of the points inside axis-parallel windows.
+
+   Filtering the points and hulling the survivors costs O(n + m lg m)
+   per window. The index is a kd-tree over the points (split at the
+   median of the wider side of the bounding box, down to leaves of a
+   few dozen points) with the hull of every node precomputed. A
+   window query collects the hulls of the O(sqrt(n)) nodes whose box
+   is inside the window and the points of the leaves that straddle
+   its boundary, and hulls only those.
+
+   The hulls take O(n lg n) space in the worst case (all points in
+   convex position) and much less in general, since the hull of a
+   node is usually small. */
+
+typedef struct _range_hull_node {
+  int x0, y0, x1, y1;  //bounding box of the points
+  long lo, hi;         //the points are p[lo..hi) of the index
+  long hull, nhull;    //the hull is hulls[hull..hull+nhull)
+  long left, right;    //children; -1 for a leaf
+} RangeHullNode;
+
+typedef struct _range_hull_index {
+  vector<point2D> p;           //the points, in tree order
+  vector<RangeHullNode> node;  //node 0 is the root
+  vector<point2D> hulls;       //canonical (not closed), by node
+  long leaf;
+} RangeHullIndex;
+
+typedef struct _range_hull_stats {
+  long nodes;       //nodes inside the window, used whole
+  long leaves;      //leaves straddling the window, filtered
+  long candidates;  //hull vertices and points hulled
+} RangeHullStats;
+
+/* build the index of p, with at most leaf points per leaf. The hulls
+   of each level are computed on nthreads threads (<= 0 means
+   default_nthreads()) */
+void range_hull_build(RangeHullIndex& idx, const vector<point2D>& p,
+                      long leaf = 32, int nthreads = 0);
+
+/* bytes used by the index, points included */
+size_t range_hull_bytes(const RangeHullIndex& idx);
+
+/* return the hull of the points p with x0 <= p.x <= x1 and
+   y0 <= p.y <= y1, in the same form as monotone_chain. If st is not
+   NULL it gets the statistics */
+vector<point2D> range_hull(const RangeHullIndex& idx, int x0, int y0,
+                           int x1, int y1, RangeHullStats* st = NULL);
+
+#endif
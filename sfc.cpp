@@ -0,0 +1,160 @@
+#include "sfc.h"
+#include "parallel.h"
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+static const char* curve_names[NB_SFC_CURVES] = {
+  "none", "morton", "hilbert"
+};
+
+const char* sfc_curve_name(int curve) {
+  assert(curve >= 0 && curve < NB_SFC_CURVES);
+  return curve_names[curve];
+}
+
+int sfc_curve_by_name(const char* name) {
+  for (int c = 0; c < NB_SFC_CURVES; c++) {
+    if (strcmp(name, curve_names[c]) == 0) {
+      return c;
+    }
+  }
+  return -1;
+}
+
+
+/* **************************************** */
+/* spread the 32 bits of v to the even bits of the result */
+static inline uint64_t spread_bits(uint64_t v) {
+  v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+  v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+  v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  v = (v | (v << 2)) & 0x3333333333333333ULL;
+  v = (v | (v << 1)) & 0x5555555555555555ULL;
+  return v;
+}
+
+static inline uint64_t morton_key(uint32_t x, uint32_t y) {
+  return spread_bits(x) | (spread_bits(y) << 1);
+}
+
+/* position of cell (x, y) on the Hilbert curve over a grid of side
+   2^order */
+static inline uint64_t hilbert_key(uint32_t x, uint32_t y, int order) {
+  uint64_t d = 0;
+  uint32_t n = (order > 0) ? 1u << order : 1;
+  for (uint32_t s = n >> 1; s > 0; s >>= 1) {
+    uint32_t rx = (x & s) ? 1 : 0;
+    uint32_t ry = (y & s) ? 1 : 0;
+    d += (uint64_t) s * s * ((3 * rx) ^ ry);
+    //rotate the quadrant so that the curve inside it starts and ends
+    //at the right corners
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      swap(x, y);
+    }
+  }
+  return d;
+}
+
+int sfc_keys(const point2D* p, long n, int curve, uint64_t* key,
+             int nthreads) {
+  if (n == 0) {
+    return 0;
+  }
+  int xmin = p[0].x, ymin = p[0].y, xmax = p[0].x, ymax = p[0].y;
+  for (long i = 1; i < n; i++) {
+    xmin = min(xmin, p[i].x);
+    xmax = max(xmax, p[i].x);
+    ymin = min(ymin, p[i].y);
+    ymax = max(ymax, p[i].y);
+  }
+  uint32_t range = (uint32_t) max((long) xmax - xmin, (long) ymax - ymin);
+  int order = 0;
+  while (order < 32 && (range >> order) != 0) {
+    order++;
+  }
+  //coarser cells are enough for locality, and every 11 key bits less
+  //saves a radix sort pass
+  int shift = max(0, order - SFC_MAX_ORDER);
+  order -= shift;
+
+  parallel_for(n, nthreads, [&](long begin, long end, int tid) {
+      for (long i = begin; i < end; i++) {
+        uint32_t x = (uint32_t) ((long) p[i].x - xmin) >> shift;
+        uint32_t y = (uint32_t) ((long) p[i].y - ymin) >> shift;
+        key[i] = (curve == SFC_HILBERT) ? hilbert_key(x, y, order)
+          : morton_key(x, y);
+      }
+    });
+  return 2 * order;
+}
+
+
+/* **************************************** */
+/* LSD radix sort, 11 bits per pass. Each pass: every thread counts
+   the digits of its range, the counts are turned into per-thread
+   offsets (digit-major, then thread, which keeps the sort stable),
+   and every thread scatters its range. The ranges depend only on n
+   and the thread count, so they are the same in both steps */
+void radix_sort_pairs(uint64_t* key, point2D* val, long n, int keybits,
+                      int nthreads) {
+  const int BITS = 11, BUCKETS = 1 << BITS;
+  if (nthreads <= 0) {
+    nthreads = default_nthreads();
+  }
+  int nt = (int) max(1L, min((long) nthreads, n / 65536 + 1));
+  vector<uint64_t> key2(n);
+  vector<point2D> val2(n);
+  uint64_t* ka = key;
+  point2D* va = val;
+  uint64_t* kb = &key2[0];
+  point2D* vb = &val2[0];
+  vector<long> count((size_t) nt * BUCKETS);
+
+  for (int shift = 0; shift < keybits; shift += BITS) {
+    fill(count.begin(), count.end(), 0);
+    parallel_for(n, nt, [&](long begin, long end, int tid) {
+        long* c = &count[(size_t) tid * BUCKETS];
+        for (long i = begin; i < end; i++) {
+          c[(ka[i] >> shift) & (BUCKETS - 1)]++;
+        }
+      });
+    long sum = 0;
+    for (int d = 0; d < BUCKETS; d++) {
+      for (int t = 0; t < nt; t++) {
+        long c = count[(size_t) t * BUCKETS + d];
+        count[(size_t) t * BUCKETS + d] = sum;
+        sum += c;
+      }
+    }
+    parallel_for(n, nt, [&](long begin, long end, int tid) {
+        long* c = &count[(size_t) tid * BUCKETS];
+        for (long i = begin; i < end; i++) {
+          long j = c[(ka[i] >> shift) & (BUCKETS - 1)]++;
+          kb[j] = ka[i];
+          vb[j] = va[i];
+        }
+      });
+    swap(ka, kb);
+    swap(va, vb);
+  }
+  if (ka != key) {
+    memcpy(key, ka, n * sizeof(uint64_t));
+    memcpy(val, va, n * sizeof(point2D));
+  }
+}
+
+void sfc_reorder(vector<point2D>& p, int curve, int nthreads) {
+  if (curve == SFC_NONE || p.size() < 2) {
+    return;
+  }
+  vector<uint64_t> key(p.size());
+  int bits = sfc_keys(&p[0], p.size(), curve, &key[0], nthreads);
+  radix_sort_pairs(&key[0], &p[0], p.size(), bits, nthreads);
+}
@@ -0,0 +1,50 @@
+#ifndef __sfc_h
+#define __sfc_h
+
+#include "geom.h"
+#include <stdint.h>
+
+/* Space-filling-curve ordering of points.
+
+   Each point gets the key of its cell on a Morton (Z-order) or
+   Hilbert curve over the bounding box of the points, and the points
+   are sorted by key with a parallel LSD radix sort. After that, any
+   contiguous range of points is spatially compact, which is what
+   chunked and parallel hull computations want: a chunk covers a
+   small region instead of spanning the whole plane. The Hilbert curve
+   has no jumps, so its chunks are more compact; Morton keys are
+   cheaper to compute.
+*/
+
+enum sfc_curve {
+  SFC_NONE = 0,
+  SFC_MORTON,
+  SFC_HILBERT,
+  NB_SFC_CURVES
+};
+
+const char* sfc_curve_name(int curve);
+
+/* return the curve with the given name ("none", "morton",
+   "hilbert"), or -1 */
+int sfc_curve_by_name(const char* name);
+
+/* the curves run over a grid of at most 2^SFC_MAX_ORDER cells per
+   side; points in the same cell get the same key */
+#define SFC_MAX_ORDER 16
+
+/* set key[i] to the key of p[i] on curve, relative to the bounding
+   box of p[0..n), on nthreads threads (<= 0 means
+   default_nthreads()). Return the number of significant key bits */
+int sfc_keys(const point2D* p, long n, int curve, uint64_t* key,
+             int nthreads = 0);
+
+/* sort key[0..n) and val[0..n) by key, stably, with a parallel LSD
+   radix sort over the low keybits bits of the keys */
+void radix_sort_pairs(uint64_t* key, point2D* val, long n, int keybits,
+                      int nthreads = 0);
+
+/* reorder p along curve (nothing for SFC_NONE) */
+void sfc_reorder(vector<point2D>& p, int curve, int nthreads = 0);
+
+#endif
@@ -6,6 +6,17 @@
 
    Draws a set of points in the default 2D projection.
 
+   Zoom with +/- or the mouse wheel, pan with the arrow keys or by
+   dragging, and press 0 to see the whole set again. The points are
+   drawn from a quadtree: only the visible cells, and one square per
+   cell when a cell covers a pixel or two, so a frame costs what is
+   visible rather than n.
+
+   Press h to show or hide the timings (generation, quadtree, hull
+   lookup and computation, drawing, frame rate) over the points, and
+   c to write the timings of the last HUD_FRAMES frames to a CSV file
+   ($HULL_HUD_CSV, default viewPoints.csv).
+
    Includes a tentative function for printing and drawing a list of-
    points (assumed to be a convex hull). These functions were not
    debugged so use them at your own risk.
@@ -15,6 +26,11 @@
 */
 
 #include "geom.h"
+#include "anytime.h"
+#include "generators.h"
+#include "hull.h"
+#include "hullcache.h"
+#include "quadtree.h"
 #include "rtimer.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -59,21 +75,76 @@ GLfloat Silver[3] = { 0.90, 0.91, 0.98};
 GLfloat Wheat[3] = { 0.847059 , 0.847059, 0.74902};
 
 /* global variables */
-const int WINDOWSIZE = 500;
-
-//the array of n points
-//needs to be global in order to be rendered
-vector<point2D>  points;
+const int WINDOWSIZE = GEN_WINDOWSIZE;
 
 int n;  //desired number of points
 
+//seed of the point generators
+uint64_t seed = 1;
+
 //the convex hull, stored as a list.
 //needs to be global in order to be rendered
 vector<point2D>  hull;
 
-//currently there are 4 different ways to initialize points.
+//the engine that computes hull; the user can cycle through the
+//engines by pressing 'e'
+HullOptions hull_opt;
+
+//the refinement of the anytime engine: the viewer shows its result
+//within the budget, then refines it when idle until it is exact
+AnytimeHull anyhull;
+
+//hulls already computed, by points and engine: cycling back to a set
+//finds its hull instead of recomputing it. If HULL_CACHE_FILE is set
+//the hulls are also kept in that file, across runs
+HullCache* hull_cache;
+
+//the points in a quadtree, rebuilt with the points; only its visible
+//cells are drawn
+QuadTree point_tree;
+
+//the array of n points, in the order of the quadtree, which holds
+//them; needs to be global in order to be rendered
+vector<point2D>& points = point_tree.p;
+
+//the GLUT window, 0 until it is created
+int window = 0;
+
+//the view: world coordinates of the center of the window, and world
+//units per pixel; view_fit_pixel is the one of the whole set
+double view_cx, view_cy, view_pixel, view_fit_pixel;
+
+//last mouse position while dragging with the left button
+int drag_x, drag_y, dragging = 0;
+
+//the timings of the viewer, shown over the points when show_hud is
+//set ('h'), and kept for the last HUD_FRAMES frames in hud_history,
+//which 'c' writes to a CSV file
+typedef struct _frame_stats {
+  double t;                  //s since the start, when drawn
+  long n, h;
+  int mode, engine;
+  double gen_us, tree_us;    //of the current points
+  double hull_us;            //of the current hull, lookup included
+  double lookup_us;          //hashing and cache lookup
+  int hit;                   //the hull came from the cache
+  int steps;                 //anytime engine: refinement steps so far
+  double refine_us;          //and their time
+  double draw_us;            //of the frame
+  long squares, cells;       //drawn: points and aggregated cells
+} FrameStats;
+
+FrameStats hud;
+//a ring: frame i of the hud_frames drawn so far is at i % HUD_FRAMES
+const long HUD_FRAMES = 4096;
+vector<FrameStats> hud_history(HUD_FRAMES);
+long hud_frames = 0;
+int show_hud = 1;
+Rtimer hud_clock;
+
+//currently there are 15 different ways to initialize points.
 //The user can cycle through them by pressing 'i'
-int NB_INIT_CHOICES = 15;
+int NB_INIT_CHOICES = NB_GENERATORS;
 int  POINT_INIT_MODE = 0;
 
 /********************************************************************/
@@ -81,6 +152,31 @@ int  POINT_INIT_MODE = 0;
 void display(void);
 void keypress(unsigned char key, int x, int y);
 
+/* arrow keys: pan by a quarter of the window */
+void special_key(int key, int x, int y);
+
+/* mouse wheel: zoom at the cursor; left button: start dragging */
+void mouse(int button, int state, int x, int y);
+
+/* pan while dragging */
+void motion(int x, int y);
+
+/* zoom by factor f (> 1 zooms in), keeping the point under window
+   pixel (x, y) in place */
+void zoom(double f, int x, int y);
+
+/* fit the view to the points and the generators' window */
+void reset_view();
+
+/* compute the hull through the cache, recording the timings in hud */
+void cached_hull_timed();
+
+/* draw the timings of hud in the upper left corner */
+void draw_hud();
+
+/* write hud_history to a CSV file */
+void dump_hud_history();
+
 /* render the array of points stored in global variable points.
    Each point is drawn as a small square.  */
 void draw_points();
@@ -90,420 +186,52 @@ void draw_points();
    lines between consecutive points */
   void draw_hull();
 
+/* compute the hull of the points with the current engine */
+void recompute_hull();
+
+/* idle callback of the anytime engine: one more refinement step */
+void refine_hull();
+
+/* print the hit rate and saved time of the hull cache */
+void print_cache_stats();
+
 /* print the array of n points stored in global variable points[]*/
 void print_points(vector<point2D> points);
 
 //print the list of points in global variable  hull
 void print_hull (vector<point2D> hull);
 
-/** initializer function */
-void initialize_points_circle();
-void initialize_points_horizontal_line();
-void initialize_points_random();
-void initialize_points_star();
-void initialize_points_butterfly();
-void initialize_points_slinky();
-void initialize_points_flower();
-void init_cardioid();
-void initialize_points_squiggles();
-void initialize_points_I();
-void initialize_points_right_hemisphere();
-void initialize_points_left_hemisphere();
-void initialize_points_doubleCircle();
-void initialize_points_square();
-void initialize_points_heart();
-
+/* initialize global vector points with generator mode (one of the
+   point_generator values in generators.h) */
+void initialize_points(int mode);
 
 /********************************************************************/
 
-//assumes global array points  is allocated to hold n points.
-//this functions initializes points[] with  n points on a circle.
-//The points are in the range (0,0) to (WINSIZE,WINSIZE).
-void initialize_points_circle() {
-
-  printf("initialize points circle\n");
-  //clear the vector just to be safe
-  points.clear();
-
-  double  step = 2* M_PI/n;
-  int rad = 100;
-
-  int i;
-  point2D p;
-  for (i=0; i<n; i++) {
-    p.x = WINDOWSIZE/2+ rad*cos(i*step);
-    p.y = WINDOWSIZE/2+ rad*sin(i*step);
-    points.push_back(p);
-  }
-}
-
-//assumes global array points is allocated to hold n points.
-//this functions initializes points[] with  n points on a line
-//The points are in the range (0,0) to (WINSIZE,WINSIZE)
-void initialize_points_horizontal_line() {
-
-  printf("initialize points line\n");
-  //clear the vector just to be safe
-  points.clear();
-
-  int i;
-  point2D p;
-  for (i=0; i<n; i++) {
-    p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-    p.y =  WINDOWSIZE/2;
-    points.push_back(p);
-  }
-}
-
-//assumes global array points is allocated to hold n points.
-//this functions initializes points[] with  n random points
-//The points are in the range (0,0) to (WINSIZE,WINSIZE)
-void initialize_points_random() {
-
-   printf("initialize points random\n");
-  //clear the vector just to be safe
-  points.clear();
-
-  int i;
-  point2D p;
-  for (i=0; i<n; i++) {
-    p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-    p.y =  (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-    points.push_back(p);
-  }
-}
-
-//assumes global array points is allocated to hold n points.
-//this functions initializes points[] with  n points  that look like a star
-//The points are in the range (0,0) to (WINSIZE,WINSIZE)
-void initialize_points_star() {
-
-  printf("initialize points star\n");
-  //clear the vector just to be safe
-  points.clear();
-
-  int i;
-  point2D p;
-  for (i=0; i<n; i++) {
-    if (i%2 == 0) {
-
-      p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-      p.y =  random() % ((int)(.7*WINDOWSIZE))  / 5;
-      p.y += (int)((1-.7/5)*WINDOWSIZE/2);
-    };
-    if (i%2 == 1)  {
-
-      p.x = random() % ((int)(.7*WINDOWSIZE)) / 5;
-      p.x +=  (int)((1-.7/5)*WINDOWSIZE/2);
-      p.y =  (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-    }
-
-    points.push_back(p);
-  }
-}
-
-// Parametric functions are amazing. 10/10 would recommend
-// by Sally
-// Reference: http://jwilson.coe.uga.edu/EMAT6680Su07/Francisco/Assignment10/parametric.html
-
-void initialize_points_butterfly(){
-    printf("initialize points butterfly\n");
-
-    points.clear();
-
-    for(int i = 0; i < n; i++){
-        float t = (float) random();
-        point2D p;
-        p.x = sin(t)*(exp(cos(t)) - 2 * cos(4*t) - sin(pow(t/12, 5))) * 55;
-        p.y = cos(t)*(exp(cos(t)) - 2 * cos(4*t) - sin(pow(t/12, 5))) * 55;
-
-        p.x += WINDOWSIZE/2;
-        p.y += WINDOWSIZE/2;
-
-        points.push_back(p);
-    }
-}
-
-// Coded by Marty Dang and Kamaal Palmer
-void initialize_points_slinky() {
-    printf("initialize points slinky\n");
-    //clear the vector just to be safe
-    points.clear();
-    int j = n/5;
-    double step = 2* M_PI/j;
-    int rad = 100;
-    int i;
-    point2D p;
-    for (i=0; i < j; i++) {
-        p.x = WINDOWSIZE/3.5+ rad*cos(i*step);
-        p.y = WINDOWSIZE/3.5+ rad*sin(i*step);
-        points.push_back(p);
-    }
-    for(i = 0; i < j; i++) {
-        p.x = WINDOWSIZE/3+ rad*cos(i*step);
-        p.y = WINDOWSIZE/3+ rad*sin(i*step);
-        points.push_back(p);
-    }
-    for(i = 0; i < j; i++){
-        p.x = WINDOWSIZE/2.5+ rad*cos(i*step);
-        p.y = WINDOWSIZE/2.5+ rad*sin(i*step);
-        points.push_back(p);
-    }
-
-    for(i = 0; i < j; i++){
-        p.x = WINDOWSIZE/2+ rad*cos(i*step);
-        p.y = WINDOWSIZE/2+ rad*sin(i*step);
-        points.push_back(p);
-    }
-    for(i = 0; i < j; i++){
-        p.x = WINDOWSIZE/1.5+ rad*cos(i*step);
-        p.y = WINDOWSIZE/1.5+ rad*sin(i*step);
-        points.push_back(p);
-    }
-}
-
-//Parametrically drawn flower
-//By: Rachel and Zoe
-//Reference: http://jwilson.coe.uga.edu/EMAT6680Su06/Holloway/Assignment%2010/Parametric%20write%20up.html
-void initialize_points_flower(){
-    printf("initialize points flower\n");
-
-    points.clear();
-
-    for(int i = 0; i < n; i++){
-        float t = (float) rand();
-        point2D p;
-        p.x = (WINDOWSIZE/4 + WINDOWSIZE/5*cos(8*t))*cos(t);
-        p.y = (WINDOWSIZE/4 + WINDOWSIZE/5*cos(8*t))*sin(t);
-
-        p.x += WINDOWSIZE/2;
-        p.y += WINDOWSIZE/2;
-
-        points.push_back(p);
-    }
-}
-
-/*
- *  Parametric Function used to graph a cardiod.
- *  Authors: Waverly Harden and Karl Sarier
- *  Reference: http://mathworld.wolfram.com/Cardioid.html
- */
-
-void init_cardioid() {
-
-    printf("initialize cardioid\n");
-    points.clear();
-
-    for (int i=0; i<n; i++) {
-        float x = (float) random();
-        point2D p;
-
-        float a = 120;
-        //cardiod
-        p.x = a*cos(x)*(1-cos(x));
-        p.y = a*sin(x)*(1-cos(x));
-
-        p.x += (WINDOWSIZE/1.5);
-        p.y += (WINDOWSIZE/2);
-        points.push_back(p);
-    }
-}
-
-//Squiggles! Squiggles!! Squiggles!!!
-
-void initialize_points_squiggles(){
-    printf("initialize points squiggles");
-    points.clear();
-    for(int i = 0; i < n; i++){
-        point2D p;
-
-    if (i<n/4){
-        p.x = sin(cos(i))*200;
-        p.y = -sin(cos(i)*30)*sin(cos(i))*30;
-    }else if (i < 2*n/4){
-        p.y = sin(cos(i))*200;
-        p.x = -sin(cos(i)*30)*sin(cos(i))*30;
-    }else if (i < 3*n/4){
-        p.y = cos(sin(cos(i)))*200;
-        p.x = cos(sin(cos(i*3)))*200;
-    }else{
-        p.y = cos(sin(cos(i)))*200;
-        p.x = (-1)*cos(sin(cos(i*3)))*200;
-    }
-    p.x += WINDOWSIZE/2;
-    p.y += WINDOWSIZE/2;
-    points.push_back(p);
-    }
-}
-
-//by Louisa Izydorczak
-void initialize_points_I() {
-    printf("initialize points I\n");
-    //clear the vector just to be safe
-    points.clear();
-    int i;
-    point2D p;
-    for (i=0; i<n; i++) {
-        if (i%3==0){
-            p.x = (int)(WINDOWSIZE/2);
-            p.y = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-            points.push_back(p);
-        }
-    else if (i%3==1){
-        p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-        p.y = (int)(.3*WINDOWSIZE/2);
-        points.push_back(p);
-        }
-    else {
-        p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-        p.y = (int)(.7*WINDOWSIZE+.15*WINDOWSIZE);
-        points.push_back(p);
-        }
-    }
-}
-
-void initialize_points_right_hemisphere() {
-
-    printf("initialize points right hemisphere\n");
-    //clear the vector just to be safe
-    points.clear();
-
-    double  step = 2*M_PI/n;
-    int rad = 100;
-
-    int i;
-    point2D p;
-    for (i=0; i<=n/2; i++) {
-        p.x = WINDOWSIZE/2 + rad*sin(i*step);
-        p.y = WINDOWSIZE/2 + rad*cos(i*step);
-        points.push_back(p);
-    }
-
-    for (i=0; i<n/2-1; i++) {
-        p.x =  WINDOWSIZE/2;
-        p.y = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-        points.push_back(p);
-    }
-
-}
-
-void initialize_points_left_hemisphere() {
-
-    printf("initialize points left hemisphere\n");
-    //clear the vector just to be safe
-    points.clear();
-
-    double  step = 2*M_PI/n;
-    int rad = 100;
-
-    int i;
-    point2D p;
-    for (i=0; i<=n/2; i++) {
-        p.x = WINDOWSIZE/2 + -1*rad*sin(i*step);
-        p.y = WINDOWSIZE/2 + rad*cos(i*step);
-        points.push_back(p);
-    }
-
-    for (i=0; i<n/2-1; i++) {
-        p.x =  WINDOWSIZE/2;
-        p.y = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-        points.push_back(p);
-    }
-
-}
-
-void initialize_points_doubleCircle(){
-    printf("initialize points diamond\n");
-    //clear the vector just to be safe
-    points.clear();
-    double step = 2* M_PI/n;
-    int rad = 100;
-
-    int i;
-    point2D p;
-    for (i=0; i<n; i++) {
-        if( i%2 == 0){
-            p.x = WINDOWSIZE/4+ rad*cos(i*step);
-            p.y = WINDOWSIZE/2+ rad*sin(i*step);
-            points.push_back(p);
-        }
-        if(i%2 == 1) {
-            p.x = WINDOWSIZE/2 + rad*cos(i*step);
-            p.y = WINDOWSIZE/2 + rad*sin(i*step);
-            points.push_back(p);
-        }
-    }
-}
-
-// designed by Will DBK and Jasper H
-void initialize_points_square() {
-    printf("initialize points square\n");
-    //clear the vector just to be safe
-    points.clear();
-    int i;
-    point2D p;
-
-    p.x = (int)((.3*WINDOWSIZE)/2);
-    p.y = (int)((.3*WINDOWSIZE)/2);
-    points.push_back(p);
-
-    p.x = (int)((.3*WINDOWSIZE)/2) + ((int)(.7*WINDOWSIZE));
-    p.y = (int)((.3*WINDOWSIZE)/2);
-    points.push_back(p);
-
-    p.x = (int)((.3*WINDOWSIZE)/2);
-    p.y = (int)((.3*WINDOWSIZE)/2) + ((int)(.7*WINDOWSIZE));
-    points.push_back(p);
-
-    p.x = (int)((.3*WINDOWSIZE)/2) + ((int)(.7*WINDOWSIZE));
-    p.y = (int)((.3*WINDOWSIZE)/2) + ((int)(.7*WINDOWSIZE));
-    points.push_back(p);
-
-
-    for (i=4; i<n; i++) {
-        if (i%4 == 0) { // bottom
-            p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-            p.y =  (int)((.3*WINDOWSIZE)/2);
-            points.push_back(p);
-        } else if (i%4 == 1) { // right
-            p.x = (int)((.3*WINDOWSIZE)/2) + ((int)(.7*WINDOWSIZE));
-            p.y =  (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-            points.push_back(p);
-        } else if (i%4 == 2) { // top
-            p.x = (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-            p.y =  (int)((.3*WINDOWSIZE)/2) + ((int)(.7*WINDOWSIZE));
-            points.push_back(p);
-        } else { // left
-            p.x = (int)((.3*WINDOWSIZE)/2);
-            p.y =  (int)(.3*WINDOWSIZE)/2 + random() % ((int)(.7*WINDOWSIZE));
-            points.push_back(p);
-        }
-
-    }
-}
-
-//assumes global array points  is allocated to hold n points.
-//this functions initializes points[] with n points that are in a heart.
-//rachel, will you marry me?
-void initialize_points_heart() {
-
-  printf("initialize points heart\n");
-  //clear the vector just to be safe
-  points.clear();
-
-  double  step = 2* M_PI/n;
-  int rad = 100;
-
-  int i;
-  point2D p;
-  for (i=0; i<n; i++) {
-    double t = i*step;
-    double r = 2 - 2*sin(t) + sin(t)*(sqrt(abs(cos(t)))/(sin(t)+1.4));
-    r = r*rad;
-    p.x = WINDOWSIZE/2 + r*cos(t);
-    p.y = WINDOWSIZE/1.2 + r*sin(t);
-    points.push_back(p);
-  }
+//initializes global vector points with the points of generator
+//mode. The points are in the range (0,0) to (WINSIZE,WINSIZE). The
+//output only depends on n and seed, so cycling through the
+//initializers always shows the same sets.
+void initialize_points(int mode) {
+
+  printf("initialize points %s\n", generator_name(mode));
+  Rtimer rt;
+  rt_start(rt);
+  vector<point2D> p;
+  generate_points(mode, n, seed, p);
+  rt_stop(rt);
+  hud.gen_us = rt_w_useconds(rt);
+  hud.mode = mode;
+
+  //the tree takes the points: a single copy of them
+  rt_start(rt);
+  qt_build_from(point_tree, p);
+  rt_stop(rt);
+  hud.tree_us = rt_w_useconds(rt);
+  char buf[1024];
+  rt_sprint(buf, rt);
+  printf("quadtree: %ld cells, %.1f MB, %s\n", (long) point_tree.node.size(),
+         qt_bytes(point_tree) / 1e6, buf);
+  reset_view();
 }
 
 /* ****************************** */
@@ -532,22 +260,34 @@ void print_hull (vector<point2D> hull) {
 int main(int argc, char** argv) {
 
   //read number of points from user
-  if (argc!=2) {
-    printf("usage: viewPoints <nbPoints>\n");
+  if (argc!=2 && argc!=3) {
+    printf("usage: viewPoints <nbPoints> [seed]\n");
     exit(1);
   }
   n = atoi(argv[1]);
+  if (argc == 3) {
+    seed = strtoull(argv[2], NULL, 10);
+  }
   printf("you entered n=%d\n", n);
   assert(n >0);
 
   //initialize the points
-  initialize_points_star();
+  initialize_points(GEN_STAR);
   //print_points(points);
 
   //compute the convex hull and store it in global variable "hull"
+  hull_default_options(&hull_opt);
+  hull_opt.engine = HULL_GRAHAM;
+  anytime_hull_init(anyhull);
+  hull_cache = hull_cache_create(64 << 20);
+  const char* cache_file = getenv("HULL_CACHE_FILE");
+  if (cache_file && hull_cache_open_disk(hull_cache, cache_file, 64 << 20) < 0) {
+    perror(cache_file);
+  }
+  rt_start(hud_clock);
   Rtimer rt1;
   rt_start(rt1);
-  hull = graham_scan(points);
+  cached_hull_timed();
   rt_stop(rt1);
   print_hull(hull);
   //print the timing
@@ -563,11 +303,14 @@ int main(int argc, char** argv) {
   glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
   glutInitWindowSize(WINDOWSIZE, WINDOWSIZE);
   glutInitWindowPosition(100,100);
-  glutCreateWindow(argv[0]);
+  window = glutCreateWindow(argv[0]);
 
   /* register callback functions */
   glutDisplayFunc(display);
   glutKeyboardFunc(keypress);
+  glutSpecialFunc(special_key);
+  glutMouseFunc(mouse);
+  glutMotionFunc(motion);
 
   /* init GL */
   /* set background color black*/
@@ -592,44 +335,169 @@ void display(void) {
   /* The default GL window is [-1,1]x[-1,1]x[-1,1] with the origin in
      the center. The camera is at (0,0,0) looking down negative
      z-axis.
-     The points are in the range (0,0) to (WINSIZE,WINSIZE), so they
-     need to be mapped to [-1,1]x [-1,1] */
-  //then scale the points to [0,2]x[0,2]
-  glScalef(2.0/WINDOWSIZE, 2.0/WINDOWSIZE, 1.0);
-  //first translate the points to [-WINDOWSIZE/2, WINDOWSIZE/2]
-  glTranslatef(-WINDOWSIZE/2, -WINDOWSIZE/2, 0);
-
+     The view is centered at (view_cx, view_cy), with view_pixel
+     units per pixel, so it needs to be mapped to [-1,1]x [-1,1] */
+  int w = glutGet(GLUT_WINDOW_WIDTH), h = glutGet(GLUT_WINDOW_HEIGHT);
+  //then scale the view to [-1,1]x[-1,1]
+  glScaled(2.0/(w*view_pixel), 2.0/(h*view_pixel), 1.0);
+  //first translate the center of the view to the origin
+  glTranslated(-view_cx, -view_cy, 0);
+
+  Rtimer rt;
+  rt_start(rt);
   draw_points();
   draw_hull();
+  glFinish();
+  rt_stop(rt);
+
+  //record the frame, then draw the timings over it
+  hud.draw_us = rt_w_useconds(rt);
+  rt_stop(hud_clock);
+  hud.t = rt_w_useconds(hud_clock) / 1e6;
+  hud.n = points.size();
+  hud.h = hull.size() ? hull.size() - 1 : 0;
+  hud.engine = hull_opt.engine;
+  hud_history[hud_frames++ % HUD_FRAMES] = hud;
+  if (show_hud) {
+    draw_hud();
+  }
 
   /* execute the drawing commands */
   glFlush();
 }
 
+/* ****************************** */
+/* one line of text at window pixel (x, y) from the top left */
+static void draw_text(int x, int y, const char* text) {
+  int w = glutGet(GLUT_WINDOW_WIDTH), h = glutGet(GLUT_WINDOW_HEIGHT);
+  glRasterPos2d(-1 + 2.0 * x / w, 1 - 2.0 * y / h);
+  for (const char* c = text; *c; c++) {
+    glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *c);
+  }
+}
+
+void draw_hud() {
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+  glColor3fv(white);
+
+  //draw time and frame rate over the last 16 frames. The viewer draws
+  //only on events, so the rate is of the frames actually drawn
+  long k = min(hud_frames, 16L);
+  double draw = 0;
+  for (long i = hud_frames - k; i < hud_frames; i++) {
+    draw += hud_history[i % HUD_FRAMES].draw_us;
+  }
+  draw /= k;
+  double span = hud_history[(hud_frames - 1) % HUD_FRAMES].t
+    - hud_history[(hud_frames - k) % HUD_FRAMES].t;
+  double fps = (span > 0) ? (k - 1) / span : 0;
+
+  char line[256];
+  int y = 16;
+  snprintf(line, sizeof(line), "%s n=%ld h=%ld  engine %s",
+           generator_name(hud.mode), hud.n, hud.h,
+           hull_engine_name(hud.engine));
+  draw_text(8, y, line);
+  snprintf(line, sizeof(line), "generate %.1f ms  quadtree %.1f ms",
+           hud.gen_us / 1e3, hud.tree_us / 1e3);
+  draw_text(8, y += 15, line);
+  if (hud.engine == HULL_ANYTIME) {
+    snprintf(line, sizeof(line), "hull %.1f ms + %d steps %.1f ms%s",
+             hud.hull_us / 1e3, hud.steps, hud.refine_us / 1e3,
+             anyhull.exact ? " exact" : "");
+  } else {
+    snprintf(line, sizeof(line), "hull %.2f ms: lookup %.2f compute %.2f%s",
+             hud.hull_us / 1e3, hud.lookup_us / 1e3,
+             (hud.hull_us - hud.lookup_us) / 1e3, hud.hit ? " (cached)" : "");
+  }
+  draw_text(8, y += 15, line);
+  snprintf(line, sizeof(line), "draw %.2f ms  %ld squares %ld cells",
+           draw / 1e3, hud.squares, hud.cells);
+  draw_text(8, y += 15, line);
+  snprintf(line, sizeof(line), "%.1f fps", fps);
+  draw_text(8, y += 15, line);
+  snprintf(line, sizeof(line), "zoom %.3gx  frame %ld  [h] hide [c] csv",
+           view_fit_pixel / view_pixel, hud_frames);
+  draw_text(8, y += 15, line);
+}
+
+void dump_hud_history() {
+  const char* path = getenv("HULL_HUD_CSV");
+  if (!path) {
+    path = "viewPoints.csv";
+  }
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    perror(path);
+    return;
+  }
+  fprintf(f, "t,generator,engine,n,h,gen_us,tree_us,hull_us,lookup_us,hit,"
+          "steps,refine_us,draw_us,squares,cells\n");
+  long first = max(0L, hud_frames - HUD_FRAMES);
+  for (long i = first; i < hud_frames; i++) {
+    const FrameStats& r = hud_history[i % HUD_FRAMES];
+    fprintf(f, "%.6f,%s,%s,%ld,%ld,%.1f,%.1f,%.1f,%.1f,%d,%d,%.1f,%.1f,%ld,%ld\n",
+            r.t, generator_name(r.mode), hull_engine_name(r.engine), r.n, r.h,
+            r.gen_us, r.tree_us, r.hull_us, r.lookup_us, r.hit, r.steps,
+            r.refine_us, r.draw_us, r.squares, r.cells);
+  }
+  fclose(f);
+  printf("wrote %ld frames to %s\n", hud_frames - first, path);
+  fflush(stdout);
+}
+
 /* ****************************** */
 /* draw the array of points stored in global variable points[]
-   each point is drawn as a small square
+   each point is drawn as a small square; a cell of the quadtree no
+   larger than 2 pixels is drawn as one square, brighter the more
+   points it has
 */
 void draw_points(){
 
-  const int R= 1;
+  //a pixel, like the 1 unit of the unzoomed view
+  const double R = view_pixel;
   //draw polygon filled or line
   glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
   //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+  int w = glutGet(GLUT_WINDOW_WIDTH), h = glutGet(GLUT_WINDOW_HEIGHT);
+  double x0 = view_cx - w * view_pixel / 2, x1 = view_cx + w * view_pixel / 2;
+  double y0 = view_cy - h * view_pixel / 2, y1 = view_cy + h * view_pixel / 2;
+  static vector<long> cells, leaves;
+  qt_visible(point_tree, x0, y0, x1, y1, view_pixel, 2, cells, leaves);
+
   //set drawing color
   glColor3fv(yellow);
 
-  int i;
-  for (i=0; i<n; i++) {
-    //draw a small square centered at (points[i].x, points[i].y)
-    glBegin(GL_POLYGON);
-    glVertex2f(points[i].x -R,points[i].y-R);
-    glVertex2f(points[i].x +R,points[i].y-R);
-    glVertex2f(points[i].x +R,points[i].y+R);
-    glVertex2f(points[i].x -R,points[i].y+R);
-    glEnd();
+  hud.squares = cells.size();
+  hud.cells = cells.size();
+  glBegin(GL_QUADS);
+  for (size_t l = 0; l < leaves.size(); l++) {
+    const QuadNode& nd = point_tree.node[leaves[l]];
+    for (long i = nd.lo; i < nd.hi; i++) {
+      //draw a small square centered at the point, if it is visible
+      const point2D& q = point_tree.p[i];
+      if (q.x < x0 - R || q.x > x1 + R || q.y < y0 - R || q.y > y1 + R) {
+        continue;
+      }
+      glVertex2d(q.x - R, q.y - R);
+      glVertex2d(q.x + R, q.y - R);
+      glVertex2d(q.x + R, q.y + R);
+      glVertex2d(q.x - R, q.y + R);
+      hud.squares++;
+    }
   }
+  for (size_t c = 0; c < cells.size(); c++) {
+    const QuadNode& nd = point_tree.node[cells[c]];
+    GLfloat b = min(1.0, 0.4 + 0.1 * log2((double) (nd.hi - nd.lo)));
+    glColor3f(yellow[0] * b, yellow[1] * b, yellow[2] * b);
+    glVertex2d(nd.x0 - R, nd.y0 - R);
+    glVertex2d(nd.x1 + R, nd.y0 - R);
+    glVertex2d(nd.x1 + R, nd.y1 + R);
+    glVertex2d(nd.x0 - R, nd.y1 + R);
+  }
+  glEnd();
 } //draw_points
 
 /* ****************************** */
@@ -638,8 +506,9 @@ void draw_points(){
    lines between consecutive points */
 void draw_hull(){
 
-  //set color
-  glColor3fv(red);
+  //set color; an approximation of the anytime engine is drawn in
+  //cyan until it is exact
+  glColor3fv(anyhull.exact ? red : cyan);
 
   if (hull.size() >0) {
     int i;
@@ -662,70 +531,191 @@ void draw_hull(){
 void keypress(unsigned char key, int x, int y) {
   switch(key) {
   case 'q':
+    print_cache_stats();
     exit(0);
     break;
 
   case 'i':
     //change points initializer
     POINT_INIT_MODE = (POINT_INIT_MODE+1) % (NB_INIT_CHOICES);
-    switch (POINT_INIT_MODE) {
-    case 0:
-      initialize_points_circle();
-      break;
-    case 1:
-      initialize_points_star();
-      break;
-    case 2:
-      initialize_points_horizontal_line();
-      break;
-    case 3:
-      initialize_points_random();
-      break;
-    case 4:
-        initialize_points_butterfly();
-        break;
-    case 5:
-        initialize_points_slinky();
-        break;
-    case 6:
-        initialize_points_flower();
-        break;
-    case 7:
-        init_cardioid();
-        break;
-    case 8:
-        initialize_points_squiggles();
-        break;
-    case 9:
-        initialize_points_I();
-        break;
-    case 10:
-        initialize_points_right_hemisphere();
-        break;
-    case 11:
-        initialize_points_left_hemisphere();
-        break;
-    case 12:
-        initialize_points_doubleCircle();
-        break;
-    case 13:
-        initialize_points_square();
-        break;
-    case 14:
-        initialize_points_heart();
-        break;
-    } //switch
+    initialize_points(POINT_INIT_MODE);
     //note: we change global array points, so we must recompute the hull
-     hull = graham_scan(points);
+    recompute_hull();
 
     //redraw
     glutPostRedisplay();
+    break;
+
+  case 'e':
+    //change hull engine
+    hull_opt.engine = (hull_opt.engine+1) % NB_HULL_ENGINES;
+    printf("hull engine %s\n", hull_engine_name(hull_opt.engine));
+    recompute_hull();
+    glutPostRedisplay();
+    break;
+
+  case '+':
+  case '=':
+    zoom(2, glutGet(GLUT_WINDOW_WIDTH) / 2, glutGet(GLUT_WINDOW_HEIGHT) / 2);
+    break;
+
+  case '-':
+    zoom(0.5, glutGet(GLUT_WINDOW_WIDTH) / 2, glutGet(GLUT_WINDOW_HEIGHT) / 2);
+    break;
+
+  case '0':
+    reset_view();
+    glutPostRedisplay();
+    break;
+
+  case 'h':
+    show_hud = !show_hud;
+    glutPostRedisplay();
+    break;
+
+  case 'c':
+    dump_hud_history();
+    break;
 
   } //switch (key)
 
 }//keypress
 
 
+/* ****************************** */
+void reset_view() {
+  double x0 = 0, y0 = 0, x1 = WINDOWSIZE, y1 = WINDOWSIZE;
+  if (!point_tree.node.empty()) {
+    const QuadNode& root = point_tree.node[0];
+    x0 = min(x0, (double) root.x0);
+    y0 = min(y0, (double) root.y0);
+    x1 = max(x1, (double) root.x1);
+    y1 = max(y1, (double) root.y1);
+  }
+  view_cx = (x0 + x1) / 2;
+  view_cy = (y0 + y1) / 2;
+  //the window is created WINDOWSIZE wide, after the first points
+  int w = window ? glutGet(GLUT_WINDOW_WIDTH) : WINDOWSIZE;
+  int h = window ? glutGet(GLUT_WINDOW_HEIGHT) : WINDOWSIZE;
+  view_pixel = view_fit_pixel = max((x1 - x0) / w, (y1 - y0) / h);
+}
+
+void zoom(double f, int x, int y) {
+  //keep the pixel from 1/64 unit (deep enough to separate integer
+  //points) to the whole coordinate range
+  double pixel = min(max(view_pixel / f, 1.0 / 64), 4.0 * (1 << 30) / WINDOWSIZE);
+  int w = glutGet(GLUT_WINDOW_WIDTH), h = glutGet(GLUT_WINDOW_HEIGHT);
+  double wx = view_cx + (x - w / 2.0) * view_pixel;
+  double wy = view_cy + (h / 2.0 - y) * view_pixel;
+  view_cx = wx - (x - w / 2.0) * pixel;
+  view_cy = wy - (h / 2.0 - y) * pixel;
+  view_pixel = pixel;
+  glutPostRedisplay();
+}
+
+void special_key(int key, int x, int y) {
+  double step = glutGet(GLUT_WINDOW_WIDTH) * view_pixel / 4;
+  switch (key) {
+  case GLUT_KEY_LEFT: view_cx -= step; break;
+  case GLUT_KEY_RIGHT: view_cx += step; break;
+  case GLUT_KEY_DOWN: view_cy -= step; break;
+  case GLUT_KEY_UP: view_cy += step; break;
+  default: return;
+  }
+  glutPostRedisplay();
+}
+
+void mouse(int button, int state, int x, int y) {
+  //the wheel is buttons 3 (up) and 4 (down)
+  if (button == 3 && state == GLUT_DOWN) {
+    zoom(1.25, x, y);
+  } else if (button == 4 && state == GLUT_DOWN) {
+    zoom(0.8, x, y);
+  } else if (button == GLUT_LEFT_BUTTON) {
+    dragging = (state == GLUT_DOWN);
+    drag_x = x;
+    drag_y = y;
+  }
+}
+
+void motion(int x, int y) {
+  if (!dragging) {
+    return;
+  }
+  view_cx -= (x - drag_x) * view_pixel;
+  view_cy += (y - drag_y) * view_pixel;
+  drag_x = x;
+  drag_y = y;
+  glutPostRedisplay();
+}
+
+
+/* ****************************** */
+void recompute_hull() {
+  if (hull_opt.engine != HULL_ANYTIME) {
+    anyhull.exact = 1;
+    glutIdleFunc(NULL);
+    cached_hull_timed();
+    printf("hull %s: %.0f us (lookup %.0f us)%s\n",
+           hull_engine_name(hull_opt.engine), hud.hull_us, hud.lookup_us,
+           hud.hit ? ", cached" : "");
+    if (hud.hit) {
+      print_cache_stats();
+    }
+    return;
+  }
+  anytime_hull(anyhull, points, hull_opt.budget);
+  hull = anyhull.hull;
+  hud.hull_us = anyhull.elapsed;
+  hud.lookup_us = 0;
+  hud.hit = 0;
+  hud.steps = 0;
+  hud.refine_us = 0;
+  printf("anytime hull: %d directions, %ld candidates, %.0f us%s\n",
+         anyhull.directions, anyhull.candidates, anyhull.elapsed,
+         anyhull.exact ? ", exact" : "");
+  glutIdleFunc(anyhull.exact ? NULL : refine_hull);
+}
+
+void cached_hull_timed() {
+  HullCacheStats before, after;
+  hull_cache_stats(hull_cache, &before);
+  Rtimer rt;
+  rt_start(rt);
+  hull = cached_hull(hull_cache, points, hull_opt, &hud.hit);
+  rt_stop(rt);
+  hull_cache_stats(hull_cache, &after);
+  hud.hull_us = rt_w_useconds(rt);
+  hud.lookup_us = after.lookup_us - before.lookup_us;
+  hud.steps = 0;
+  hud.refine_us = 0;
+}
+
+void print_cache_stats() {
+  HullCacheStats st;
+  hull_cache_stats(hull_cache, &st);
+  printf("hull cache: %ld/%ld hits (%ld from disk), saved %.0f us, "
+         "lookups %.0f us\n", st.hits + st.disk_hits, st.lookups,
+         st.disk_hits, st.saved_us, st.lookup_us);
+  fflush(stdout);
+}
+
+void refine_hull() {
+  Rtimer rt;
+  rt_start(rt);
+  anytime_hull_step(anyhull);
+  rt_stop(rt);
+  hud.steps++;
+  hud.refine_us += rt_w_useconds(rt);
+  hull = anyhull.hull;
+  if (anyhull.exact) {
+    printf("anytime hull: exact after %.0f us\n", anyhull.elapsed);
+    glutIdleFunc(NULL);
+  }
+  glutPostRedisplay();
+}
+
+
 /* Handler for window re-size event. Called back when the window first appears and
    whenever the window is re-sized with its new width and height */
 void reshape(GLsizei width, GLsizei height) {  // GLsizei for non-negative integer
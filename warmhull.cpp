@@ -0,0 +1,120 @@
+#include "warmhull.h"
+#include "hullquery.h"
+#include <assert.h>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+void warm_hull_reset(WarmHull& w) {
+  w.hull.clear();
+  w.order.clear();
+  w.n = -1;
+  w.survivors = w.moves = 0;
+  w.cold = 1;
+}
+
+/* insertion sort of a[0..m) by the points they index; give up after
+   budget moves and return -1, otherwise return the number of moves */
+static long insertion_sort(long* a, long m, const vector<point2D>& p,
+                           long budget) {
+  long moves = 0;
+  for (long i = 1; i < m; i++) {
+    long x = a[i];
+    long j = i;
+    while (j > 0 && xy_less(p[x], p[a[j-1]])) {
+      a[j] = a[j-1];
+      j--;
+      if (++moves > budget) {
+        return -1;
+      }
+    }
+    a[j] = x;
+  }
+  return moves;
+}
+
+/* **************************************** */
+vector<point2D> warm_hull(WarmHull& w, const vector<point2D>& p) {
+  long n = p.size();
+  if (w.n != n) {
+    warm_hull_reset(w);
+    w.n = n;
+  }
+  w.mark.assign(n, 0);
+  w.fresh.clear();
+  w.cold = (w.hull.size() == 0);
+
+  //the filter: the polygon of the previous hull vertices at their
+  //new positions. Its vertices are kept, and so is everything
+  //strictly outside it
+  HullQuery hq;
+  if (!w.cold) {
+    vector<point2D> old(w.hull.size());
+    for (size_t i = 0; i < w.hull.size(); i++) {
+      old[i] = p[w.hull[i]];
+      w.mark[w.hull[i]] = 1;
+    }
+    hq_build(hq, monotone_chain(old));
+    if (hq.v.size() < 3) {
+      w.cold = 1;
+    }
+  }
+  long survivors = 0;
+  for (long i = 0; i < n; i++) {
+    if (w.cold || w.mark[i] || !hq_contains(hq, p[i])) {
+      w.mark[i] = 1;
+      survivors++;
+    }
+  }
+
+  //the survivors that survived the previous frame too are taken in
+  //their previous order, nearly sorted; the others are sorted apart
+  //and merged in
+  vector<long> prev;
+  prev.swap(w.order);
+  w.order.reserve(survivors);
+  for (size_t j = 0; j < prev.size(); j++) {
+    if (w.mark[prev[j]] == 1) {
+      w.mark[prev[j]] = 2;
+      w.order.push_back(prev[j]);
+    }
+  }
+  for (long i = 0; i < n; i++) {
+    if (w.mark[i] == 1) {
+      w.fresh.push_back(i);
+    }
+  }
+  auto less = [&p](long a, long b) { return xy_less(p[a], p[b]); };
+  long m = w.order.size();
+  w.moves = (m > 0) ? insertion_sort(&w.order[0], m, p, 8 * m + 64) : 0;
+  if (w.moves < 0) {
+    sort(w.order.begin(), w.order.end(), less);
+  }
+  sort(w.fresh.begin(), w.fresh.end(), less);
+  w.order.insert(w.order.end(), w.fresh.begin(), w.fresh.end());
+  inplace_merge(w.order.begin(), w.order.begin() + m, w.order.end(), less);
+  w.survivors = survivors;
+
+  //scan
+  w.s.resize(survivors);
+  for (long j = 0; j < survivors; j++) {
+    w.s[j] = p[w.order[j]];
+  }
+  w.h.resize(2 * survivors + 2);
+  long k = monotone_chain_buffer(survivors ? &w.s[0] : NULL, survivors,
+                                 &w.h[0]);
+  vector<point2D> result(w.h.begin(), w.h.begin() + k);
+
+  //the hint for the next frame: the index of one point at each hull
+  //vertex, found in the sorted survivors
+  w.hull.clear();
+  for (long i = 0; i + 1 < k; i++) {
+    long j = lower_bound(w.s.begin(), w.s.end(), result[i], xy_less)
+      - w.s.begin();
+    assert(j < survivors);
+    w.hull.push_back(w.order[j]);
+  }
+  return result;
+}
@@ -0,0 +1,51 @@
+#ifndef __warmhull_h
+#define __warmhull_h
+
+#include "geom.h"
+
+/* Hull of a moving point set, warm started from the previous frame.
+
+   The points keep their indices from frame to frame and move a
+   little. The previous hull vertices, at their new positions, span a
+   polygon inside the new hull; every other point inside it or on its
+   boundary cannot be a hull vertex and is dropped. The survivors (a
+   thin band along the boundary) are put in xy order starting from
+   their order in the previous frame, which is nearly sorted, and
+   scanned with monotone_chain. The cost per frame is one O(lg h)
+   test per point plus a sort of the survivors, instead of sorting all
+   n points.
+
+   The result is always the exact hull, whatever the motion: the
+   filter only drops points that provably are not hull vertices, and
+   the re-sort falls back to a full sort of the survivors when the
+   previous order is far off.
+*/
+typedef struct _warm_hull {
+  //hints from the previous frame: the indices of the hull vertices,
+  //and of the survivors in xy order
+  vector<long> hull;
+  vector<long> order;
+  long n;
+
+  //work space, kept between frames
+  vector<char> mark;
+  vector<long> fresh;
+  vector<point2D> s, h;
+
+  //statistics of the last frame
+  long survivors;  //points left after the filter
+  long moves;      //insertion sort moves in the re-sort
+  int cold;        //1 if there was no usable hint
+} WarmHull;
+
+/* forget the hints; the next frame is computed from scratch. Call
+   it once before the first frame */
+void warm_hull_reset(WarmHull& w);
+
+/* compute the hull of p, in the same form as monotone_chain, using
+   and then updating the hints in w. p[i] must be the new position of
+   the point that was p[i] in the previous frame; if the number of
+   points changed the hints are dropped. */
+vector<point2D> warm_hull(WarmHull& w, const vector<point2D>& p);
+
+#endif